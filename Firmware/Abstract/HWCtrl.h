@@ -29,6 +29,8 @@ void AttachDebugFunc(DebugFunction Function);
 // host read/write
 U32 GetRegValue(int Address);
 void SetRegValue(int Address, U32 Value);
+void GetRegBurst(int Address, U32 *Buffer, int WordNumber);
+void SetRegBurst(int Address, U32 *Buffer, int WordNumber);
 U32 GetRequestCount();
 void SetRequestCount(U32 Count);
 // baseband memory load/save functions
@@ -36,6 +38,8 @@ void LoadMemory(U32 *DestAddr, U32 *BasebandAddr, int Size);
 void SaveMemory(U32 *BasebandAddr, U32 *SrcAddr, int Size);
 // input file for PC simulation
 void SetInputFile(char *FileName);
+void SetModelThreads(int ThreadNumber);
+void SetSatParamInterval(int Interval, int Check);
 // RF control
 void EnableRF();
 
@@ -44,6 +48,10 @@ extern LLH InitPosition;
 
 #ifdef __cplusplus
 }
+
+// C model behind host read/write, only for simulation environment to select model options before EnableRF()
+class CGnssTop;
+CGnssTop *GetBasebandModel();
 #endif
 
 #endif	// __HARDWARE_CTRL_H__
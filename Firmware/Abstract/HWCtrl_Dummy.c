@@ -21,18 +21,22 @@ void AttachBasebandISR(InterruptFunction ISR) {}
 void AttachDebugFunc(DebugFunction Function) {}
 U32 GetRegValue(int Address) { return 0; }
 void SetRegValue(int Address, U32 Value) {}
+void GetRegBurst(int Address, U32 *Buffer, int WordNumber) {}
+void SetRegBurst(int Address, U32 *Buffer, int WordNumber) {}
 U32 GetRequestCount() { return 0; }
 void SetRequestCount(U32 Count) {}
 void LoadMemory(U32 *DestAddr, U32 *BasebandAddr, int Size) {}
 void SaveMemory(U32 *BasebandAddr, U32 *SrcAddr, int Size) {}
 void SetInputFile(char *FileName) {}
+void SetModelThreads(int ThreadNumber) {}
+void SetSatParamInterval(int Interval, int Check) {}
 void EnableRF() {}
 
 // other baseband functions
 void AEInitialize(void) {}
 PACQ_CONFIG GetFreeAcqTask(void) { return NULL; }
 int AddAcqTask(PACQ_CONFIG pAcqConfig) { return 0; }
-void StartAcquisition(void *Param) {}
+void StartAcquisition(void) {}
 int AcqBufferReachTh(void) { return 0; }
 int AdjustMeasInterval(void* Param) { return 0; }
 void AcqIntService() {}
@@ -44,6 +44,33 @@ void SetRegValue(int Address, U32 Value)
 	*(U32*)(GNSS_BASE_ADDR + Address) = Value;
 }
 
+//*************** Host read consecutive DWORDs from baseband ****************
+//* each DWORD is a single bus access, so register side effects are kept
+// Parameters:
+//   Address: start address offset of baseband (DWORD aligned)
+//   Buffer: buffer to hold data read
+//   WordNumber: number of DWORDs to read
+void GetRegBurst(int Address, U32 *Buffer, int WordNumber)
+{
+	volatile U32 *RegAddr = (volatile U32 *)(GNSS_BASE_ADDR + Address);
+
+	while (WordNumber -- > 0)
+		*Buffer ++ = *RegAddr ++;
+}
+
+//*************** Host write consecutive DWORDs to baseband ****************
+// Parameters:
+//   Address: start address offset of baseband (DWORD aligned)
+//   Buffer: data to write
+//   WordNumber: number of DWORDs to write
+void SetRegBurst(int Address, U32 *Buffer, int WordNumber)
+{
+	volatile U32 *RegAddr = (volatile U32 *)(GNSS_BASE_ADDR + Address);
+
+	while (WordNumber -- > 0)
+		*RegAddr ++ = *Buffer ++;
+}
+
 //*************** Copy baseband memory out to system memory ****************
 // Parameters:
 //   DestAddr: address of system memory
@@ -51,9 +78,7 @@ void SetRegValue(int Address, U32 Value)
 //   Size: copy size in bytes
 void LoadMemory(U32 *DestAddr, U32 *BasebandAddr, int Size)
 {
-	int i;
-	for (i = 0; i < Size; i += 4)
-		DestAddr[i] = *(U32*)(GNSS_BASE_ADDR + BasebandAddr + i);
+	GetRegBurst((int)BasebandAddr, DestAddr, Size / 4);
 }
 
 //*************** Copy baseband memory out to system memory ****************
@@ -63,9 +88,7 @@ void LoadMemory(U32 *DestAddr, U32 *BasebandAddr, int Size)
 //   Size: copy size in bytes
 void SaveMemory(U32 *BasebandAddr, U32 *SrcAddr, int Size)
 {
-	int i;
-	for (i = 0; i < Size; i += 4)
-		*(U32*)(GNSS_BASE_ADDR + BasebandAddr + i) = SrcAddr[i];
+	SetRegBurst((int)BasebandAddr, SrcAddr, Size / 4);
 }
 
 //*************** Set input file of the scenario ****************
@@ -76,6 +99,12 @@ void SaveMemory(U32 *BasebandAddr, U32 *SrcAddr, int Size)
 //   FileName: file name
 void SetInputFile(char *FileName) {}
 
+//*************** Set number of threads to run baseband model ****************
+//* in real system, this function has no effect
+// Parameters:
+//   ThreadNumber: number of threads including the calling thread
+void SetModelThreads(int ThreadNumber) {}
+
 //*************** enable RF clock ****************
 //* in PC platform, this will run baseband process until end of scenario
 //* in real system, this will enable RF and its ADC clock
@@ -6,12 +6,16 @@
 //
 //----------------------------------------------------------------------
 
+#include <thread>
 #include "GnssTop.h"
 #include "RegAddress.h"
 #include "HWCtrl.h"
+#include "ModelProfile.h"
 extern "C" {
 #include "TaskQueue.h"
 #include "FirmwarePortal.h"
+#include "PlatformCtrl.h"
+#include "ChannelManager.h"
 }
 
 #define BLOCK_SIZE (SAMPLE_FREQ / 1000)		// one data block has 1ms length
@@ -22,6 +26,26 @@ static DebugFunction DebugFunc = 0;
 SYSTEM_TIME InitTime;
 LLH InitPosition;
 
+// C model (including interrupt service) runs within critical section
+// task threads access C model through functions below holding the same critical section
+static int ProcessBlock()
+{
+	int Result;
+
+	ENTER_CRITICAL();
+	Result = Baseband.Process(BLOCK_SIZE);
+	EXIT_CRITICAL();
+	return Result;
+}
+
+// task threads fall behind if any queue has more than half of items waiting
+static bool TaskThreadBehind(int Threshold)
+{
+	return WaitTaskNumber(&BasebandTask) > BasebandTask.ItemNumber * Threshold / 2 ||
+		WaitTaskNumber(&PostMeasTask) > PostMeasTask.ItemNumber * Threshold / 2 ||
+		WaitTaskNumber(&InputOutputTask) > InputOutputTask.ItemNumber * Threshold / 2;
+}
+
 //*************** Attach ISR to baseband interrupt ****************
 // Parameters:
 //   ISR: baseband interrupt service routine
@@ -38,6 +62,14 @@ void AttachDebugFunc(DebugFunction Function)
 	DebugFunc = Function;
 }
 
+//*************** Get C model instance ****************
+// Return value:
+//   pointer to C model accessed by host read/write functions
+CGnssTop *GetBasebandModel()
+{
+	return &Baseband;
+}
+
 //*************** Host read from baseband ****************
 // Parameters:
 //   Address: address offset of baseband (DWORD aligned, only 16LSB effect)
@@ -45,7 +77,12 @@ void AttachDebugFunc(DebugFunction Function)
 //   data read from baseband
 U32 GetRegValue(int Address)
 {
-	return Baseband.GetRegValue(Address);
+	U32 Value;
+
+	ENTER_CRITICAL();
+	Value = Baseband.GetRegValue(Address);
+	EXIT_CRITICAL();
+	return Value;
 }
 
 //*************** Host write to baseband ****************
@@ -54,7 +91,34 @@ U32 GetRegValue(int Address)
 //   Value: data written to baseband
 void SetRegValue(int Address, U32 Value)
 {
+	ENTER_CRITICAL();
 	Baseband.SetRegValue(Address, Value);
+	EXIT_CRITICAL();
+}
+
+//*************** Host read consecutive DWORDs from baseband ****************
+//* TE buffer and AE buffer are copied by C model without decoding each address
+// Parameters:
+//   Address: start address offset of baseband (DWORD aligned)
+//   Buffer: buffer to hold data read
+//   WordNumber: number of DWORDs to read
+void GetRegBurst(int Address, U32 *Buffer, int WordNumber)
+{
+	ENTER_CRITICAL();
+	Baseband.GetRegBurst(Address, Buffer, WordNumber);
+	EXIT_CRITICAL();
+}
+
+//*************** Host write consecutive DWORDs to baseband ****************
+// Parameters:
+//   Address: start address offset of baseband (DWORD aligned)
+//   Buffer: data to write
+//   WordNumber: number of DWORDs to write
+void SetRegBurst(int Address, U32 *Buffer, int WordNumber)
+{
+	ENTER_CRITICAL();
+	Baseband.SetRegBurst(Address, Buffer, WordNumber);
+	EXIT_CRITICAL();
 }
 
 //*************** Host get request count ****************
@@ -62,7 +126,7 @@ void SetRegValue(int Address, U32 Value)
 //   value in REQUEST_COUNT register
 U32 GetRequestCount()
 {
-	return Baseband.GetRegValue(ADDR_REQUEST_COUNT);
+	return GetRegValue(ADDR_REQUEST_COUNT);
 }
 
 //*************** Host set request count ****************
@@ -70,7 +134,9 @@ U32 GetRequestCount()
 //   Count: value to set to REQUEST_COUNT register
 void SetRequestCount(U32 Count)
 {
+	ENTER_CRITICAL();
 	Baseband.SetRegValue(ADDR_REQUEST_COUNT, Count);
+	EXIT_CRITICAL();
 }
 
 //*************** Copy baseband memory out to system memory ****************
@@ -80,9 +146,9 @@ void SetRequestCount(U32 Count)
 //   Size: copy size in bytes
 void LoadMemory(U32 *DestAddr, U32 *BasebandAddr, int Size)
 {
-	int i;
-	for (i = 0; i < Size / 4; i ++)
-		DestAddr[i] = GetRegValue((int)(BasebandAddr + i));
+	ENTER_CRITICAL();
+	Baseband.GetRegBurst((int)(size_t)BasebandAddr, DestAddr, Size / 4);
+	EXIT_CRITICAL();
 }
 
 //*************** Copy baseband memory out to system memory ****************
@@ -92,9 +158,9 @@ void LoadMemory(U32 *DestAddr, U32 *BasebandAddr, int Size)
 //   Size: copy size in bytes
 void SaveMemory(U32 *BasebandAddr, U32 *SrcAddr, int Size)
 {
-	int i;
-	for (i = 0; i < Size / 4; i ++)
-		SetRegValue((int)(BasebandAddr + i), SrcAddr[i]);
+	ENTER_CRITICAL();
+	Baseband.SetRegBurst((int)(size_t)BasebandAddr, SrcAddr, Size / 4);
+	EXIT_CRITICAL();
 }
 
 //*************** Set input file of the scenario ****************
@@ -106,6 +172,7 @@ void SaveMemory(U32 *BasebandAddr, U32 *SrcAddr, int Size)
 void SetInputFile(char *FileName)
 {
 	Baseband.SetInputFile(FileName);
+#if defined GNSS_TOP_SCENARIO
 	InitTime.Year = Baseband.UtcTime.Year;
 	InitTime.Month = Baseband.UtcTime.Month;
 	InitTime.Day = Baseband.UtcTime.Day;
@@ -116,27 +183,81 @@ void SetInputFile(char *FileName)
 	InitPosition.lon = Baseband.StartPos.lon;
 	InitPosition.lat = Baseband.StartPos.lat;
 	InitPosition.hae = Baseband.StartPos.alt;
+#endif
+}
+
+//*************** Set number of threads to run baseband model ****************
+//* in C model, tracking channels are correlated on worker threads
+//* in SignalSim, channel correlation results are calculated on worker threads
+//* in real system, this function has no effect
+// Parameters:
+//   ThreadNumber: number of threads including the calling thread, 1 for sequential processing
+void SetModelThreads(int ThreadNumber)
+{
+	Baseband.SetThreadNumber(ThreadNumber);
+}
+
+//*************** Set interval of exact satellite parameter calculation ****************
+//* in C model, this function has no effect
+//* in SignalSim, satellite parameters between exact calculations are interpolated
+//* in real system, this function has no effect
+// Parameters:
+//   Interval: interval in millisecond, 1 to calculate every millisecond
+//   Check: none zero to compare with exact values, report maximum error and use exact values over budget
+void SetSatParamInterval(int Interval, int Check)
+{
+#if defined GNSS_TOP_SCENARIO
+	Baseband.SetSatParamInterval(Interval, Check);
+#endif
 }
 
 //*************** enable RF clock ****************
 //* in PC platform, this will run baseband process until end of scenario
+//* task queues are processed after each block if no task thread created
+//* otherwise task threads run concurrently and C model waits only when they fall behind
 //* in real system, this will enable RF and its ADC clock
 void EnableRF()
 {
 	static int ProcessCount = 0;
+	int TaskNumber;
 
-	while (Baseband.Process(BLOCK_SIZE) >= 0)
+	while (ProcessBlock() >= 0)
 	{
 //		printf("ProcessCount=%d\n", ProcessCount);
 		if (ProcessCount == 1003)
 			ProcessCount = ProcessCount;
-		DoTaskQueue(&BasebandTask);
-		DoTaskQueue(&PostMeasTask);
-		DoTaskQueue(&InputOutputTask);
+		if (TaskThreadRunning())	// tasks are not profiled on task threads
+		{
+			while (TaskThreadBehind(1))
+				std::this_thread::yield();
+			ENTER_CRITICAL();
+			if (DebugFunc)
+				DebugFunc((void *)(&Baseband), ProcessCount);
+			EXIT_CRITICAL();
+			ProcessCount ++;
+			continue;
+		}
+		PROFILE_START(PROFILE_STAGE_BASEBAND_TASK);
+		TaskNumber = DoTaskQueue(&BasebandTask);
+		PROFILE_STOP(PROFILE_STAGE_BASEBAND_TASK);
+		PROFILE_COUNT(PROFILE_COUNT_TASK, TaskNumber);
+		PROFILE_START(PROFILE_STAGE_POST_MEAS_TASK);
+		TaskNumber = DoTaskQueue(&PostMeasTask);
+		PROFILE_STOP(PROFILE_STAGE_POST_MEAS_TASK);
+		PROFILE_COUNT(PROFILE_COUNT_TASK, TaskNumber);
+		PROFILE_START(PROFILE_STAGE_IN_OUT_TASK);
+		TaskNumber = DoTaskQueue(&InputOutputTask);
+		PROFILE_STOP(PROFILE_STAGE_IN_OUT_TASK);
+		PROFILE_COUNT(PROFILE_COUNT_TASK, TaskNumber);
 		if (DebugFunc)
 			DebugFunc((void *)(&Baseband), ProcessCount);
 		ProcessCount ++;
 //		if (ProcessCount == 50000)
 //			break;
 	}
+	// let task threads finish all pending tasks at end of scenario
+	while (TaskThreadRunning() && TaskThreadBehind(0))
+		std::this_thread::yield();
+	printf("state buffer sync: %u DWORDs in %u writes, %u DWORDs in %u reads\n", StateSyncCount.WriteWords, StateSyncCount.WriteCalls,
+		StateSyncCount.ReadWords, StateSyncCount.ReadCalls);
 }
@@ -26,9 +26,15 @@ typedef void (*ThreadFunction)(void *Param);
 
 // thread control
 void CreateThread(ThreadFunction Thread, int Priority, void *Param);
+int TaskThreadRunning();
 // IPC functions
 void ENTER_CRITICAL();
 void EXIT_CRITICAL();
+// keep task from running at the same time as ISR, only needed where ISR is not on the task's core
+// with POSIX threads this is the same critical section ProcessBlock() holds around the whole C model,
+// so baseband tasks never overlap with model processing, only post measurement and IO tasks do
+void ENTER_ISR_EXCLUSIVE();
+void EXIT_ISR_EXCLUSIVE();
 U32 EventCreate();
 void EventSet(U32 Event);
 void EventWait(U32 Event);
@@ -22,6 +22,9 @@
 
 void ENTER_CRITICAL() { taskENTER_CRITICAL(); }
 void EXIT_CRITICAL() { taskEXIT_CRITICAL(); }
+// ISR preempts tasks on the same core, no need to block it
+void ENTER_ISR_EXCLUSIVE() {}
+void EXIT_ISR_EXCLUSIVE() {}
 
 int StackSizes[] = {BASEBAND_STACK_SIZE, POST_MEAS_STACK_SIZE, INOUT_STACK_SIZE };
 
@@ -30,6 +33,8 @@ void CreateThread(ThreadFunction Thread, int Priority, void *Param)
 	xTaskCreate(Thread, "", StackSizes[Priority], Param, HIGHEST_PRIORITY - Priority, NULL);
 }
 
+int TaskThreadRunning() { return 1; }
+
 U32 EventCreate() { return (U32)xEventGroupCreate(); }
 
 void EventSet(U32 Event)
@@ -14,15 +14,22 @@
 static FILE *fp_debug = (FILE *)0;
 static FILE *SreamFile[MAX_STREAM_ID] = { 0 };
 
+// task queues are processed serially after each millisecond of C model
+// build with PLATFORM_POSIX_THREAD and PlatformCtrl_Posix.c to process task queues on threads
+#if !defined PLATFORM_POSIX_THREAD
 void CreateThread(ThreadFunction Thread, int Priority, void *Param) {}
+int TaskThreadRunning() { return 0; }
 void ENTER_CRITICAL() {}
 void EXIT_CRITICAL() {}
+void ENTER_ISR_EXCLUSIVE() {}
+void EXIT_ISR_EXCLUSIVE() {}
 U32 EventCreate() { return 0; }
 void EventSet(U32 Event) {}
 void EventWait(U32 Event) {}
 U32 MutexCreate() { return 0; }
 void MutexTake(U32 Mutex) {}
 void MutexGive(U32 Mutex) {}
+#endif
 
 #if defined _MSC_VER	// implementation of __builtin_xxx in Visual Studio
 
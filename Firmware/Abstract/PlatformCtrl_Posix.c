@@ -0,0 +1,173 @@
+//----------------------------------------------------------------------
+// PlatformCtrl_Posix.c:
+//   Implementation of OS functions with POSIX threads for PC platform
+//   task queues are processed on their own threads while C model runs
+//   file based functions are shared with PlatformCtrl_Model.c built with PLATFORM_POSIX_THREAD
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "PlatformCtrl.h"
+
+#define MAX_EVENT_NUMBER 16
+#define MAX_MUTEX_NUMBER 16
+
+// auto reset event, one waiting thread released for each set
+typedef struct
+{
+	pthread_mutex_t Mutex;
+	pthread_cond_t Condition;
+	int Signaled;
+} POSIX_EVENT;
+
+typedef struct
+{
+	ThreadFunction Thread;
+	void *Param;
+} THREAD_START;
+
+static POSIX_EVENT Events[MAX_EVENT_NUMBER];
+static int EventNumber = 0;
+static pthread_mutex_t Mutexes[MAX_MUTEX_NUMBER];
+static int MutexNumber = 0;
+static pthread_mutex_t CriticalMutex;
+static pthread_once_t CriticalOnce = PTHREAD_ONCE_INIT;
+static int ThreadNumber = 0;
+
+static void *ThreadEntry(void *Param)
+{
+	THREAD_START Start = *(THREAD_START *)Param;
+
+	free(Param);
+	Start.Thread(Start.Param);
+	return NULL;
+}
+
+//*************** Create a thread ****************
+//* priority is ignored, all threads are scheduled by host OS
+// Parameters:
+//   Thread: thread function
+//   Priority: 0 for highest priority
+//   Param: parameter passed to thread function
+void CreateThread(ThreadFunction Thread, int Priority, void *Param)
+{
+	pthread_t ThreadId;
+	THREAD_START *Start = (THREAD_START *)malloc(sizeof(THREAD_START));
+
+	Start->Thread = Thread;
+	Start->Param = Param;
+	if (pthread_create(&ThreadId, NULL, ThreadEntry, Start) != 0)
+	{
+		free(Start);
+		return;
+	}
+	pthread_detach(ThreadId);
+	ThreadNumber ++;
+}
+
+//*************** Whether task queues are processed by threads ****************
+// Return value:
+//   none zero if threads are created by CreateThread()
+int TaskThreadRunning()
+{
+	return ThreadNumber > 0;
+}
+
+// critical section is a recursive mutex, so ISR can add tasks within it
+static void InitCritical()
+{
+	pthread_mutexattr_t Attr;
+
+	pthread_mutexattr_init(&Attr);
+	pthread_mutexattr_settype(&Attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&CriticalMutex, &Attr);
+	pthread_mutexattr_destroy(&Attr);
+}
+
+void ENTER_CRITICAL()
+{
+	pthread_once(&CriticalOnce, InitCritical);
+	pthread_mutex_lock(&CriticalMutex);
+}
+
+void EXIT_CRITICAL()
+{
+	pthread_mutex_unlock(&CriticalMutex);
+}
+
+// C model runs ISR on its own thread within critical section
+// a task holding critical section sees ISR only between tasks, as if preempted on one core
+// ProcessBlock() also holds it around the C model, so baseband tasks run between blocks, not beside them
+void ENTER_ISR_EXCLUSIVE()
+{
+	ENTER_CRITICAL();
+}
+
+void EXIT_ISR_EXCLUSIVE()
+{
+	EXIT_CRITICAL();
+}
+
+// handle of event and mutex is index plus 1, 0 is not a valid handle
+U32 EventCreate()
+{
+	POSIX_EVENT *Event;
+
+	if (EventNumber >= MAX_EVENT_NUMBER)
+		return 0;
+	Event = &Events[EventNumber];
+	pthread_mutex_init(&Event->Mutex, NULL);
+	pthread_cond_init(&Event->Condition, NULL);
+	Event->Signaled = 0;
+	return ++ EventNumber;
+}
+
+void EventSet(U32 Event)
+{
+	POSIX_EVENT *pEvent;
+
+	if (Event == 0 || Event > (U32)EventNumber)
+		return;
+	pEvent = &Events[Event-1];
+	pthread_mutex_lock(&pEvent->Mutex);
+	pEvent->Signaled = 1;
+	pthread_cond_signal(&pEvent->Condition);
+	pthread_mutex_unlock(&pEvent->Mutex);
+}
+
+void EventWait(U32 Event)
+{
+	POSIX_EVENT *pEvent;
+
+	if (Event == 0 || Event > (U32)EventNumber)
+		return;
+	pEvent = &Events[Event-1];
+	pthread_mutex_lock(&pEvent->Mutex);
+	while (!pEvent->Signaled)
+		pthread_cond_wait(&pEvent->Condition, &pEvent->Mutex);
+	pEvent->Signaled = 0;
+	pthread_mutex_unlock(&pEvent->Mutex);
+}
+
+U32 MutexCreate()
+{
+	if (MutexNumber >= MAX_MUTEX_NUMBER)
+		return 0;
+	pthread_mutex_init(&Mutexes[MutexNumber], NULL);
+	return ++ MutexNumber;
+}
+
+void MutexTake(U32 Mutex)
+{
+	if (Mutex != 0 && Mutex <= (U32)MutexNumber)
+		pthread_mutex_lock(&Mutexes[Mutex-1]);
+}
+
+void MutexGive(U32 Mutex)
+{
+	if (Mutex != 0 && Mutex <= (U32)MutexNumber)
+		pthread_mutex_unlock(&Mutexes[Mutex-1]);
+}
@@ -18,6 +18,11 @@
 #define COH_BUF_LEN    (CORRELATOR_NUM * MAX_FFT_NUM)
 #define NONCOH_BUF_LEN (CORRELATOR_NUM * MAX_BIN_NUM)
 
+// set STATE_SYNC_BATCH to 0 to synchronize state buffer cache field by field
+#if !defined STATE_SYNC_BATCH
+#define STATE_SYNC_BATCH 1
+#endif
+
 #pragma pack(push)	// push current alignment
 #pragma pack(4)		// set alignment to 4-byte boundary
 
@@ -139,6 +144,10 @@ typedef struct
 	S32 CarrierCount;	// carrier cycle count
 	S32 CarrierFreq;	// carrier FCW
 	int WeekMsCount;	// week ms count at observation time
+	// copies of channel state at observation time, channel state keeps changing while measurement is output
+	U32 State;
+	int CN0;
+	int TrackingTime;
 } BB_MEASUREMENT, *PBB_MEASUREMENT;
 
 typedef struct
@@ -154,10 +163,21 @@ typedef struct
 
 #pragma pack(pop)	//restore original alignment
 
+// DWORDs and HW access calls of state buffer synchronization, accumulated since TEInitialize()
+typedef struct
+{
+	U32 WriteWords;
+	U32 WriteCalls;
+	U32 ReadWords;
+	U32 ReadCalls;
+} STATE_SYNC_COUNT, *PSTATE_SYNC_COUNT;
+
 extern CHANNEL_STATE ChannelStateArray[TOTAL_CHANNEL_NUMBER];
+extern STATE_SYNC_COUNT StateSyncCount;
 void InitChannel(PCHANNEL_STATE pChannel);
 void ConfigChannel(PCHANNEL_STATE pChannel, int Doppler, int CodePhase16x);
 void SyncCacheWrite(PCHANNEL_STATE ChannelState);
+void SyncCacheWriteAll(U32 ChannelMask);
 void ProcessCohSum(int ChannelID, unsigned int OverwriteProtect);
 int ComposeMeasurement(int ChannelID, PBB_MEASUREMENT Measurement);
 
@@ -9,8 +9,47 @@
 #if !defined __COMPOSE_OUTPUT_H__
 #define __COMPOSE_OUTPUT_H__
 
+#define BB_OUTPUT_TEXT		0	// $PMSRP/$PBMSR/$PMSRE/$PDATA sentences
+#define BB_OUTPUT_BINARY	1	// binary records defined below
+
+#if !defined DEFAULT_BB_OUTPUT_FORMAT
+#define DEFAULT_BB_OUTPUT_FORMAT BB_OUTPUT_TEXT
+#endif
+
+//==========================
+// binary record, all fields little endian
+//   byte 0~1: sync BB_RECORD_SYNC0/1
+//   byte 2: version
+//   byte 3: record type
+//   byte 4~5: payload length N
+//   byte 6~N+5: payload
+//   byte N+6~N+8: CRC24Q of byte 0~N+5 (MSB first)
+//==========================
+#define BB_RECORD_SYNC0		0x47
+#define BB_RECORD_SYNC1		0x4f
+#define BB_RECORD_VERSION	1
+#define BB_RECORD_HEADER_LENGTH	6
+#define BB_RECORD_CRC_LENGTH	3
+
+// record types
+#define BB_RECORD_MEAS		1	// one measurement epoch
+#define BB_RECORD_DATA		2	// 32bit navigation data stream of one channel
+
+// measurement record payload: epoch fields followed by ChannelNumber channel fields
+//   TickCount(U32) Interval(S32) ClockAdjust(S32) GpsMsCount(S32) BdsMsCount(S32) TimeQuality(U8) ChannelNumber(U8)
+//   channel: LogicChannel(U8) Svid(U8) Signal(U8) CN0(U16) CarrierFreq(U32) CarrierPhase(U32) CarrierCount(S32)
+//            CodeCount(S32) CodePhase(U32) WeekMsCount(S32) State(U32) TrackingTime(U32)
+#define BB_MEAS_EPOCH_LENGTH	22
+#define BB_MEAS_CHANNEL_LENGTH	37
+// data record payload
+//   LogicChannel(U8) Svid(U8) Signal(U8) SymbolIndex(S32) TickCount(U32) DataStream(U32)
+#define BB_DATA_LENGTH			15
+
+#define BB_RECORD_MAX_LENGTH (BB_RECORD_HEADER_LENGTH + BB_MEAS_EPOCH_LENGTH + BB_MEAS_CHANNEL_LENGTH * TOTAL_CHANNEL_NUMBER + BB_RECORD_CRC_LENGTH)
+
 extern int OutputBasebandMeasPort;
 extern int OutputBasebandDataPort;
+extern int OutputBasebandFormat;
 
 int MeasPrintTask(void *Param);
 int BasebandDataOutput(void *Param);
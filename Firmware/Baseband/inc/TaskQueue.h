@@ -11,6 +11,17 @@
 
 #include "CommonDefines.h"
 
+// set TASK_QUEUE_LOCK_FREE to 0 to use linked list queues for baseband, post measurement and in/out tasks
+#if !defined TASK_QUEUE_LOCK_FREE
+#define TASK_QUEUE_LOCK_FREE 1
+#endif
+
+#define TASK_QUEUE_CACHE_LINE 64	// head and tail of lock free queue are put in different cache lines
+#define TASK_SLOT_PARAM_SIZE 128	// maximum parameter size in bytes of lock free queue
+
+// compile time check of task parameter size, put next to definition of parameter size of a producer
+#define TASK_PARAM_SIZE_CHECK(Name, Size) typedef char Name##ParamSizeCheck[((Size) <= TASK_SLOT_PARAM_SIZE) ? 1 : -1]
+
 typedef int (*TaskFunction) (void *param);
 
 typedef struct tag_TASK_ITEM
@@ -21,6 +32,29 @@ typedef struct tag_TASK_ITEM
 	struct tag_TASK_ITEM *pNextItem;	// pointer to next item in link list
 } TASK_ITEM, *PTASK_ITEM;
 
+// slot of lock free queue with parameter stored inline
+typedef struct
+{
+	TaskFunction CallbackFunction;
+	int ParamSize;	// size of parameter (in DWORD)
+	U32 Param[TASK_SLOT_PARAM_SIZE / 4];
+} TASK_SLOT, *PTASK_SLOT;
+
+// single producer single consumer ring of task slots
+// Head is written only by consumer and Tail is written only by producer
+// queues with producers in more than one context set MultiProducer to serialize producers with critical section
+typedef struct
+{
+	PTASK_SLOT SlotArray;
+	unsigned int SlotNumber;	// must be power of 2
+	int MultiProducer;
+	U8 Pad0[TASK_QUEUE_CACHE_LINE];
+	volatile unsigned int Head;	// index of next slot to do
+	U8 Pad1[TASK_QUEUE_CACHE_LINE];
+	volatile unsigned int Tail;	// index of next slot to fill
+	U8 Pad2[TASK_QUEUE_CACHE_LINE];
+} TASK_RING, *PTASK_RING;
+
 typedef struct
 {
 	PTASK_ITEM TaskItemArray;
@@ -33,10 +67,13 @@ typedef struct
 	PTASK_ITEM AvailableQueue;	// pointer to available queue list
 	PTASK_ITEM WaitQueue;		// pointer to wait queue list
 	PTASK_ITEM QueueTail;		// pointer to last item in wait list
+	PTASK_RING TaskRing;		// lock free ring used instead of lists above if not NULL
 } TASK_QUEUE, *PTASK_QUEUE;
 
 void InitTaskQueue(PTASK_QUEUE TaskQueue, TASK_ITEM ItemArray[], int ItemNumber, U32 *ParamBuffer, int BufferSize, U32 Event);
+void InitLockFreeQueue(PTASK_QUEUE TaskQueue, PTASK_RING TaskRing, TASK_SLOT SlotArray[], int SlotNumber, U32 Event, int MultiProducer);
 int AddTaskToQueue(PTASK_QUEUE TaskQueue, TaskFunction TaskFunc, void *Param, int ParamSize);
 int DoTaskQueue(PTASK_QUEUE TaskQueue);
+int WaitTaskNumber(PTASK_QUEUE TaskQueue);
 
 #endif	// __TASK_QUEUE_H__
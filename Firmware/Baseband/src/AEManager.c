@@ -235,7 +235,7 @@ void DoVerification(void)
 	DEBUG_OUTPUT(OUTPUT_CONTROL(ACQUISITION, INFO), "Acquire Result at search stage\n");
 	for (i = 0; i < CurAcqTask->AcqChNumber; i ++)
 	{
-		LoadMemory(AcqResult, (U32 *)(ADDR_BASE_AE_BUFFER + i * 32 + 16), 16);
+		LoadMemory(AcqResult, (U32 *)(size_t)(ADDR_BASE_AE_BUFFER + i * 32 + 16), 16);
 		Doppler = ((int)(AcqResult[1] << 8)) >> 23;
 		Doppler = CurAcqTask->SatConfig[i].CenterFreq + (Doppler * 2 - 7) * CurAcqTask->SearchConfig->StrideInterval / 16;
 		CodePhase = AcqResult[1] & 0x7fff;	// acquired code position, 2x chip scale
@@ -314,7 +314,7 @@ int ProcessAcqResult(void *Param)
 	DEBUG_OUTPUT(OUTPUT_CONTROL(ACQUISITION, INFO), "Acquire Result at verify stage\n");
 	for (i = 0; i < pAcqConfig->AcqChNumber; i ++)
 	{
-		LoadMemory(AcqResult, (U32 *)(ADDR_BASE_AE_BUFFER + i * 32 + 16), 16);
+		LoadMemory(AcqResult, (U32 *)(size_t)(ADDR_BASE_AE_BUFFER + i * 32 + 16), 16);
 		Doppler = ((int)(AcqResult[1] << 8)) >> 23;
 		Doppler = pAcqConfig->SatConfig[i].CenterFreq + (Doppler * 2 - 7) * pAcqConfig->SearchConfig->StrideInterval / 16;
 		CodePhase = AcqResult[1] & 0x7fff;	// acquired code position, 2x chip scale
@@ -17,11 +17,12 @@
 #include "FirmwarePortal.h"
 #include "TaskManager.h"
 #include "ChannelManager.h"
-#include "TeManager.h"
+#include "TEManager.h"
 #include "BBCommonFunc.h"
 #include "PvtEntry.h"
 
 CHANNEL_STATE ChannelStateArray[TOTAL_CHANNEL_NUMBER];
+STATE_SYNC_COUNT StateSyncCount;
 extern PTRACKING_CONFIG TrackingConfig[][4];
 extern int DoDataDecode(void* Param);
 
@@ -32,6 +33,7 @@ void DoTrackingLoop(PCHANNEL_STATE ChannelState);
 void SwitchTrackingStage(PCHANNEL_STATE ChannelState, unsigned int TrackingStage);
 int StageDetermination(PCHANNEL_STATE ChannelState);
 
+static void LoadCoherentSum(PCHANNEL_STATE ChannelState, int Start, int Number);
 static void ProcessCohData(PCHANNEL_STATE ChannelState);
 static void CollectBitSyncData(PCHANNEL_STATE ChannelState);
 static void DecodeDataStream(PCHANNEL_STATE ChannelState);
@@ -48,6 +50,13 @@ static const unsigned int GalInvPos[25] = {
 0x240fb, 0x481f6, 0x903ed, 0x207da, 0x40fb5, 
 };
 
+// DWORDs in first 16 DWORDs of state buffer to be written for each cache dirty flag
+#define DIRTY_WORDS_FREQ	0x0003	// CarrierFreq, CodeFreq
+#define DIRTY_WORDS_CONFIG	0x001c	// CorrConfig, NHConfig, DumpLength
+#define DIRTY_WORDS_CODE	0x1c80	// PrnCount, CodePhase, DumpCount, CorrState
+#define DIRTY_WORDS_STATE	0x1000	// CorrState
+#define DIRTY_WORDS_ALL		0xffff
+
 void SetNHConfig(PCHANNEL_STATE ChannelState, int NHIndex, int NHPos, const unsigned int *NHCode);
 
 //*************** Initialize channel state structure ****************
@@ -163,33 +172,89 @@ void SyncCacheWrite(PCHANNEL_STATE ChannelState)
 	if ((ChannelState->State & STATE_CACHE_DIRTY) == 0)	// if no need to sync cache, return
 		return;
 	if ((ChannelState->State & STATE_CACHE_DIRTY) == STATE_CACHE_DIRTY)	// if entire cache need to be sync
+	{
 		SaveMemory((U32 *)(ChannelState->StateBufferHW), (U32 *)(&ChannelState->StateBufferCache), sizeof(U32) * 16);
+		StateSyncCount.WriteWords += 16;
+		StateSyncCount.WriteCalls ++;
+	}
 	else	// partial of cache to sync
 	{
 		if (ChannelState->State & STATE_CACHE_FREQ_DIRTY)	// update carrier and code frequency
 		{
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->CarrierFreq)), ChannelState->StateBufferCache.CarrierFreq);
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->CodeFreq)), ChannelState->StateBufferCache.CodeFreq);
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CarrierFreq)), ChannelState->StateBufferCache.CarrierFreq);
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CodeFreq)), ChannelState->StateBufferCache.CodeFreq);
+			StateSyncCount.WriteWords += 2;
+			StateSyncCount.WriteCalls += 2;
 		}
 		if (ChannelState->State & STATE_CACHE_CONFIG_DIRTY)	// update CorrConfig, NHConfig and DumpLength
 		{
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->CorrConfig)), ChannelState->StateBufferCache.CorrConfig);
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->NHConfig)), ChannelState->StateBufferCache.NHConfig);
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->DumpLength)), ChannelState->StateBufferCache.DumpLength);
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CorrConfig)), ChannelState->StateBufferCache.CorrConfig);
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->NHConfig)), ChannelState->StateBufferCache.NHConfig);
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->DumpLength)), ChannelState->StateBufferCache.DumpLength);
+			StateSyncCount.WriteWords += 3;
+			StateSyncCount.WriteCalls += 3;
 		}
 		if (ChannelState->State & STATE_CACHE_CODE_DIRTY)	// update PrnCount, CodePhase, DumpCount and CorrState
 		{
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->PrnCount)), ChannelState->StateBufferCache.PrnCount);
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->CodePhase)), ChannelState->StateBufferCache.CodePhase);
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->DumpCount)), ChannelState->StateBufferCache.DumpCount);
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->CorrState)), ChannelState->StateBufferCache.CorrState);
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->PrnCount)), ChannelState->StateBufferCache.PrnCount);
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CodePhase)), ChannelState->StateBufferCache.CodePhase);
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->DumpCount)), ChannelState->StateBufferCache.DumpCount);
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CorrState)), ChannelState->StateBufferCache.CorrState);
+			StateSyncCount.WriteWords += 4;
+			StateSyncCount.WriteCalls += 4;
 		}
 		if (ChannelState->State & STATE_CACHE_STATE_DIRTY)	// update CorrState
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->CorrState)), ChannelState->StateBufferCache.CorrState);
+		{
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CorrState)), ChannelState->StateBufferCache.CorrState);
+			StateSyncCount.WriteWords ++;
+			StateSyncCount.WriteCalls ++;
+		}
 	}
 	ChannelState->State &= ~STATE_CACHE_DIRTY;	// clear cache dirty flags
 }
 
+//*************** Synchronize state buffer cache value of all dirty channels to HW ****************
+//* dirty fields of each channel are merged into DWORD mask (CorrState written once if both
+//* code and state dirty), and each contiguous range is written with one burst in ascending address
+//* channels are 32 DWORDs apart with HW updated DWORDs 16~31 in between, so ranges never span channels
+// Parameters:
+//   ChannelMask: bit mask of channels to synchronize
+// Return value:
+//   none
+void SyncCacheWriteAll(U32 ChannelMask)
+{
+	int i, Start, End;
+	U32 DirtyFlag, WordMask;
+	PCHANNEL_STATE ChannelState;
+
+	for (i = 0; i < TOTAL_CHANNEL_NUMBER; i ++)
+	{
+		if ((ChannelMask & (1 << i)) == 0)
+			continue;
+		ChannelState = ChannelStateArray + i;
+		if ((DirtyFlag = ChannelState->State & STATE_CACHE_DIRTY) == 0)
+			continue;
+		if (DirtyFlag == STATE_CACHE_DIRTY)
+			WordMask = DIRTY_WORDS_ALL;
+		else
+			WordMask = ((DirtyFlag & STATE_CACHE_FREQ_DIRTY) ? DIRTY_WORDS_FREQ : 0) |
+				((DirtyFlag & STATE_CACHE_CONFIG_DIRTY) ? DIRTY_WORDS_CONFIG : 0) |
+				((DirtyFlag & STATE_CACHE_CODE_DIRTY) ? DIRTY_WORDS_CODE : 0) |
+				((DirtyFlag & STATE_CACHE_STATE_DIRTY) ? DIRTY_WORDS_STATE : 0);
+		for (Start = 0; WordMask != 0; Start = End)
+		{
+			while ((WordMask & (1 << Start)) == 0)
+				Start ++;
+			for (End = Start; WordMask & (1 << End); End ++)
+				WordMask &= ~(1 << End);
+			SetRegBurst((int)(size_t)((U32 *)(ChannelState->StateBufferHW) + Start), (U32 *)(&ChannelState->StateBufferCache) + Start, End - Start);
+			StateSyncCount.WriteWords += End - Start;
+			StateSyncCount.WriteCalls ++;
+		}
+		ChannelState->State &= ~STATE_CACHE_DIRTY;	// clear cache dirty flags
+	}
+}
+
 //*************** Synchronize state buffer cache value from HW ****************
 // Parameters:
 //   ChannelState: pointer to channel state structure
@@ -199,9 +264,27 @@ void SyncCacheWrite(PCHANNEL_STATE ChannelState)
 void SyncCacheRead(PCHANNEL_STATE ChannelState, int ReadContent)
 {
 	if (ReadContent & SYNC_CACHE_READ_DATA)
-		LoadMemory(ChannelState->StateBufferCache.CoherentSum, (U32 *)(ChannelState->StateBufferHW) + 24, sizeof(U32) * 8);	// copy coherent result to cache
+		LoadCoherentSum(ChannelState, 0, 8);	// copy coherent result to cache
 	if (ReadContent & SYNC_CACHE_READ_STATUS)
+	{
 		LoadMemory(&(ChannelState->StateBufferCache.PrnCount), (U32 *)(ChannelState->StateBufferHW) + 7, sizeof(U32) * 6);	// copy channel status fields
+		StateSyncCount.ReadWords += 6;
+		StateSyncCount.ReadCalls ++;
+	}
+}
+
+//*************** Copy part of coherent result from HW to cache ****************
+// Parameters:
+//   ChannelState: pointer to channel state structure
+//   Start: index of first coherent result
+//   Number: number of coherent results to copy
+// Return value:
+//   none
+void LoadCoherentSum(PCHANNEL_STATE ChannelState, int Start, int Number)
+{
+	LoadMemory(ChannelState->StateBufferCache.CoherentSum + Start, (U32 *)(ChannelState->StateBufferHW) + 24 + Start, sizeof(U32) * Number);
+	StateSyncCount.ReadWords += Number;
+	StateSyncCount.ReadCalls ++;
 }
 
 //*************** Process coherent sum interrupt of a channel ****************
@@ -219,13 +302,31 @@ void ProcessCohSum(int ChannelID, unsigned int OverwriteProtect)
 //	int i;
 	U32 *CohBuffer;
 //	S16 CohResultI, CohResultQ;
+#if STATE_SYNC_BATCH
+	int ReadStart, ReadEnd;
+#endif
 
-	ChannelState->StateBufferCache.CorrState = GetRegValue((U32)(&(ChannelState->StateBufferHW->CorrState)));	// get CorrState to check CurrentCor
+	ChannelState->StateBufferCache.CorrState = GetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CorrState)));	// get CorrState to check CurrentCor
+	StateSyncCount.ReadWords ++;
+	StateSyncCount.ReadCalls ++;
 	CurrentCor = STATE_BUF_GET_CUR_CORR(&(ChannelState->StateBufferCache));
 	CohCount = STATE_BUF_GET_COH_COUNT(&(ChannelState->StateBufferCache));
 	CompleteData = (ChannelState->PendingCount == 0 && CurrentCor != 0) ? (CohCount == 0 && CurrentCor == 1) : 1;
 
+#if STATE_SYNC_BATCH
+	// copy only coherent results used below: PendingCount~7 to complete data, 0~CurrentCor-1 to pending data
+	ReadStart = CompleteData ? ChannelState->PendingCount : 8;
+	ReadEnd = CompleteData ? 8 : 0;
+	if (CurrentCor && (CohCount == (ChannelState->CoherentNumber - 1)))
+	{
+		ReadStart = 0;
+		ReadEnd = (ReadEnd > CurrentCor) ? ReadEnd : CurrentCor;
+	}
+	if (ReadEnd > ReadStart)
+		LoadCoherentSum(ChannelState, ReadStart, ReadEnd - ReadStart);
+#else
 	SyncCacheRead(ChannelState, SYNC_CACHE_READ_DATA);	// copy coherent result to cache
+#endif
 	CohBuffer = ChannelState->CohBuffer + ChannelState->FftCount * CORRELATOR_NUM;
 	if (CompleteData)
 	{
@@ -245,7 +346,7 @@ void ProcessCohSum(int ChannelID, unsigned int OverwriteProtect)
 	// determine whether NH code segment need to update
 	if (ChannelState->State & NH_SEGMENT_UPDATE)
 	{
-		StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->CorrState)));
+		StateValue = GetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CorrState)));
 		if ((StateValue >> 27) >= 20)
 		{
 			if (++ChannelState->NHIndex == 90)
@@ -360,6 +461,9 @@ int ComposeMeasurement(int ChannelID, PBB_MEASUREMENT Measurement)
 	Measurement->WeekMsCount = MsCount - DataAccTime; // week millisecond go back to symbol boundary
 	CohCount += DataAccTime;	// adjustment to week millisecond apply to CorCount
 	Measurement->CodeCount = CodeCount + CohCount * 2046;
+	Measurement->State = ChannelState->State;
+	Measurement->CN0 = ChannelState->CN0;
+	Measurement->TrackingTime = ChannelState->TrackingTime;
 
 	return 0;
 }
@@ -425,7 +529,7 @@ void DecodeDataStream(PCHANNEL_STATE ChannelState)
 		else
 			SymbolCount = ChannelState->CoherentNumber / DataStream->TotalAccTime;	// coherent length must be multiple of symbol length
 
-		Data = GetRegValue((U32)(&(ChannelState->StateBufferHW->DecodeData)));
+		Data = GetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->DecodeData)));
 		if (SIGNAL_IS_B1C(ChannelState->Signal) || SIGNAL_IS_E1(ChannelState->Signal))	// B1C/E1 has negative data
 			Data ^= 0xffffffff;
 		for (i = SymbolCount - 1; i >= 0; i --)
@@ -640,11 +744,11 @@ void SetNHConfig(PCHANNEL_STATE ChannelState, int NHIndex, int NHPos, const unsi
 	SegmentCode &= 0xffffff;
 	// write to state buffer
 	STATE_BUF_SET_NH_CONFIG(&(ChannelState->StateBufferCache), 24, SegmentCode);
-	SetRegValue((U32)(&(ChannelState->StateBufferHW->NHConfig)),  ChannelState->StateBufferCache.NHConfig);
+	SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->NHConfig)),  ChannelState->StateBufferCache.NHConfig);
 	// set current NH count
-	StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->CorrState)));
+	StateValue = GetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CorrState)));
 	SET_FIELD(StateValue, 27, 5, NHPos);
-	SetRegValue((U32)(&(ChannelState->StateBufferHW->CorrState)), StateValue);
+	SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CorrState)), StateValue);
 }
 
 //*************** Task to do GPS L1CA bit sync ****************
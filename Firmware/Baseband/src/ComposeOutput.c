@@ -12,9 +12,97 @@
 #include "TEManager.h"
 #include "PlatformCtrl.h"
 #include "BBDefines.h"
+#include "SupportPackage.h"
+#include "ComposeOutput.h"
 
 int OutputBasebandMeasPort = DEFAULT_BB_MEAS_PORT;
 int OutputBasebandDataPort = DEFAULT_BB_DATA_PORT;
+int OutputBasebandFormat = DEFAULT_BB_OUTPUT_FORMAT;
+
+// record buffer, tasks writing output are all in in/out task
+static unsigned char RecordBuffer[BB_RECORD_MAX_LENGTH];
+
+static unsigned char *PutU16(unsigned char *Buffer, unsigned int Value)
+{
+	Buffer[0] = (unsigned char)Value;
+	Buffer[1] = (unsigned char)(Value >> 8);
+	return Buffer + 2;
+}
+
+static unsigned char *PutU32(unsigned char *Buffer, U32 Value)
+{
+	Buffer[0] = (unsigned char)Value;
+	Buffer[1] = (unsigned char)(Value >> 8);
+	Buffer[2] = (unsigned char)(Value >> 16);
+	Buffer[3] = (unsigned char)(Value >> 24);
+	return Buffer + 4;
+}
+
+//*************** Fill header and CRC of binary record and send to output port ****************
+// Parameters:
+//   PortNumber: output port
+//   RecordType: type of record
+//   PayloadLength: length of payload already filled after header
+// Return value:
+//   none
+static void SendRecord(int PortNumber, int RecordType, int PayloadLength)
+{
+	unsigned int Crc;
+	unsigned char *CrcPos = RecordBuffer + BB_RECORD_HEADER_LENGTH + PayloadLength;
+
+	RecordBuffer[0] = BB_RECORD_SYNC0;
+	RecordBuffer[1] = BB_RECORD_SYNC1;
+	RecordBuffer[2] = BB_RECORD_VERSION;
+	RecordBuffer[3] = (unsigned char)RecordType;
+	PutU16(RecordBuffer + 4, PayloadLength);
+	Crc = Crc24qBytes(RecordBuffer, BB_RECORD_HEADER_LENGTH + PayloadLength);
+	CrcPos[0] = (unsigned char)(Crc >> 16);
+	CrcPos[1] = (unsigned char)(Crc >> 8);
+	CrcPos[2] = (unsigned char)Crc;
+	WriteStreamPort(PortNumber, RecordBuffer, BB_RECORD_HEADER_LENGTH + PayloadLength + BB_RECORD_CRC_LENGTH);
+}
+
+//*************** Output baseband measurements as binary record ****************
+// Parameters:
+//   MeasParam: Pointer to measurement parameter structure
+// Return value:
+//   none
+static void MeasOutputBinary(PBB_MEAS_PARAM MeasParam)
+{
+	int i, ChannelNumber = 0;
+	PBB_MEASUREMENT Msr = BasebandMeasurement;
+	U32 ChannelMask;
+	unsigned char *Payload = RecordBuffer + BB_RECORD_HEADER_LENGTH;
+	unsigned char *p = Payload + BB_MEAS_EPOCH_LENGTH;
+
+	for (i = 0, ChannelMask = 1; i < TOTAL_CHANNEL_NUMBER; i ++, ChannelMask <<= 1)
+	{
+		if ((MeasParam->MeasMask & ChannelMask) == 0)
+			continue;
+		*p ++ = (unsigned char)Msr[i].ChannelState->LogicChannel;
+		*p ++ = Msr[i].ChannelState->Svid;
+		*p ++ = Msr[i].ChannelState->Signal;
+		p = PutU16(p, (Msr[i].CN0 < 0) ? 0 : (Msr[i].CN0 > 0xffff) ? 0xffff : Msr[i].CN0);
+		p = PutU32(p, Msr[i].CarrierFreq);
+		p = PutU32(p, Msr[i].CarrierPhase);
+		p = PutU32(p, Msr[i].CarrierCount);
+		p = PutU32(p, Msr[i].CodeCount);
+		p = PutU32(p, Msr[i].CodePhase);
+		p = PutU32(p, Msr[i].WeekMsCount);
+		p = PutU32(p, Msr[i].State);
+		p = PutU32(p, Msr[i].TrackingTime);
+		ChannelNumber ++;
+	}
+	p = Payload;
+	p = PutU32(p, MeasParam->TickCount);
+	p = PutU32(p, MeasParam->Interval);
+	p = PutU32(p, MeasParam->ClockAdjust);
+	p = PutU32(p, MeasParam->GpsMsCount);
+	p = PutU32(p, MeasParam->BdsMsCount);
+	*p ++ = (unsigned char)MeasParam->TimeQuality;
+	*p ++ = (unsigned char)ChannelNumber;
+	SendRecord(OutputBasebandMeasPort, BB_RECORD_MEAS, BB_MEAS_EPOCH_LENGTH + BB_MEAS_CHANNEL_LENGTH * ChannelNumber);
+}
 
 //*************** Task to output baseband measurements ****************
 // Parameters:
@@ -31,6 +119,11 @@ int MeasPrintTask(void *Param)
 
 	if (!PortOpened(OutputBasebandMeasPort))
 		return 0;
+	if (OutputBasebandFormat == BB_OUTPUT_BINARY)
+	{
+		MeasOutputBinary(MeasParam);
+		return 0;
+	}
 	sprintf(OutputBuffer, "$PMSRP,%d,%d,%d,%d\r\n", __builtin_popcount(MeasParam->MeasMask), MeasParam->TickCount, MeasParam->Interval, MeasParam->ClockAdjust);
 	WriteStreamPort(OutputBasebandMeasPort, OutputBuffer, strlen(OutputBuffer));
 	for (i = 0, ChannelMask = 1; i < TOTAL_CHANNEL_NUMBER; i ++, ChannelMask <<= 1)
@@ -40,7 +133,7 @@ int MeasPrintTask(void *Param)
 		sprintf(OutputBuffer, "$PBMSR,%2d,%2d,%2d,%10u,%10u,%10u,%5d,%10u,%5d,%9d,%8x,%4d,%8u\r\n",
 			Msr[i].ChannelState->LogicChannel, Msr[i].ChannelState->Svid, Msr[i].ChannelState->Signal,
 			Msr[i].CarrierFreq, Msr[i].CarrierPhase, Msr[i].CarrierCount, Msr[i].CodeCount, Msr[i].CodePhase, 2046,
-			Msr[i].WeekMsCount, Msr[i].ChannelState->State, Msr[i].ChannelState->CN0, Msr[i].ChannelState->TrackingTime);
+			Msr[i].WeekMsCount, Msr[i].State, Msr[i].CN0, Msr[i].TrackingTime);
 		WriteStreamPort(OutputBasebandMeasPort, OutputBuffer, strlen(OutputBuffer));
 	}
 	sprintf(OutputBuffer, "$PMSRE,%c,%d,%d\r\n", "UECKA"[MeasParam->TimeQuality], MeasParam->GpsMsCount, MeasParam->BdsMsCount);
@@ -52,9 +145,22 @@ int BasebandDataOutput(void* Param)
 {
 	PDATA_FOR_DECODE DataForDecode = (PDATA_FOR_DECODE)Param;
 	char OutputBuffer[64];
+	unsigned char *p;
 
 	if (!PortOpened(OutputBasebandDataPort))
 		return 0;
+	if (OutputBasebandFormat == BB_OUTPUT_BINARY)
+	{
+		p = RecordBuffer + BB_RECORD_HEADER_LENGTH;
+		*p ++ = (unsigned char)DataForDecode->ChannelState->LogicChannel;
+		*p ++ = DataForDecode->ChannelState->Svid;
+		*p ++ = DataForDecode->ChannelState->Signal;
+		p = PutU32(p, DataForDecode->SymbolIndex);
+		p = PutU32(p, DataForDecode->TickCount);
+		PutU32(p, DataForDecode->DataStream);
+		SendRecord(OutputBasebandDataPort, BB_RECORD_DATA, BB_DATA_LENGTH);
+		return 0;
+	}
 	sprintf(OutputBuffer, "$PDATA,%2d,%2d,%2d,%5d,%10d,%08x\r\n",
 		DataForDecode->ChannelState->LogicChannel, DataForDecode->ChannelState->Svid, DataForDecode->ChannelState->Signal,
 		DataForDecode->SymbolIndex, DataForDecode->TickCount, DataForDecode->DataStream);
@@ -43,10 +43,11 @@ void TEInitialize()
 	MeasIntCounter = BasebandTickCount = 0;
 	ChannelOccupation = 0;
 	memset(ChannelStateArray, 0, sizeof(ChannelStateArray));
+	memset(&StateSyncCount, 0, sizeof(StateSyncCount));
 	for (i = 0; i < TOTAL_CHANNEL_NUMBER; i ++)
 	{
 		ChannelStateArray[i].LogicChannel = i;
-		ChannelStateArray[i].StateBufferHW = (PSTATE_BUFFER)(ADDR_BASE_TE_BUFFER + i * 128);	// each channel occupy 128 bytes start from ADDR_BASE_TE_BUFFER
+		ChannelStateArray[i].StateBufferHW = (PSTATE_BUFFER)(size_t)(ADDR_BASE_TE_BUFFER + i * 128);	// each channel occupy 128 bytes start from ADDR_BASE_TE_BUFFER
 	}
 }
 
@@ -67,6 +68,9 @@ U32 GetChannelEnable()
 //   none
 void UpdateChannels()
 {
+#if STATE_SYNC_BATCH
+	SyncCacheWriteAll(ChannelOccupation);
+#else
 	int i;
 	U32 ChannelMask;
 
@@ -75,6 +79,7 @@ void UpdateChannels()
 		if (ChannelOccupation & ChannelMask)
 			SyncCacheWrite(ChannelStateArray + i);
 	}
+#endif
 }
 
 //*************** Get one available channel (not occupied channel) ****************
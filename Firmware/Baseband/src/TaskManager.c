@@ -15,14 +15,21 @@ TASK_QUEUE RequestTask;
 TASK_ITEM RequestItems[32];
 U32 RequestBuffer[1024];
 TASK_QUEUE BasebandTask;
+TASK_QUEUE PostMeasTask;
+TASK_QUEUE InputOutputTask;
+#if TASK_QUEUE_LOCK_FREE
+TASK_RING BasebandRing, PostMeasRing, InputOutputRing;
+TASK_SLOT BasebandSlots[32];
+TASK_SLOT PostMeasSlots[32];
+TASK_SLOT InputOutputSlots[8];
+#else
 TASK_ITEM BasebandItems[32];
 U32 BasebandBuffer[1024];
-TASK_QUEUE PostMeasTask;
 TASK_ITEM PostMeasItems[32];
 U32 PostMeasBuffer[1024];
-TASK_QUEUE InputOutputTask;
 TASK_ITEM InputOutputItems[8];
 U32 InputOutputBuffer[1024];
+#endif
 
 U32 EventBaseband, EventPostMeas, EventInputOutput;
 
@@ -44,9 +51,17 @@ void TaskInitialize()
 	EventPostMeas = EventCreate();
 	EventInputOutput = EventCreate();
 	InitTaskQueue(&RequestTask, RequestItems, 32, RequestBuffer, sizeof(RequestBuffer), 0);
+#if TASK_QUEUE_LOCK_FREE
+	// baseband tasks are added in ISR only, post measurement tasks in ISR and baseband task
+	// in/out tasks in baseband task and post measurement task
+	InitLockFreeQueue(&BasebandTask, &BasebandRing, BasebandSlots, 32, EventBaseband, 0);
+	InitLockFreeQueue(&PostMeasTask, &PostMeasRing, PostMeasSlots, 32, EventPostMeas, 1);
+	InitLockFreeQueue(&InputOutputTask, &InputOutputRing, InputOutputSlots, 8, EventInputOutput, 1);
+#else
 	InitTaskQueue(&BasebandTask, BasebandItems, 32, BasebandBuffer, sizeof(BasebandBuffer), EventBaseband);
-	InitTaskQueue(&PostMeasTask, PostMeasItems, 32, PostMeasBuffer, sizeof(PostMeasBuffer), EventInputOutput);
+	InitTaskQueue(&PostMeasTask, PostMeasItems, 32, PostMeasBuffer, sizeof(PostMeasBuffer), EventPostMeas);
 	InitTaskQueue(&InputOutputTask, InputOutputItems, 8, InputOutputBuffer, sizeof(InputOutputBuffer), EventInputOutput);
+#endif
 	CreateThread(TaskProcThread, 0, &BasebandTask);
 	CreateThread(TaskProcThread, 1, &PostMeasTask);
 	CreateThread(TaskProcThread, 2, &InputOutputTask);
@@ -79,11 +94,11 @@ int AddToTask(int TaskType, TaskFunction TaskFunc, void *Param, int ParamSize)
 		break;
 	case TASK_POSTMEAS:
 		ReturnValue = AddTaskToQueue(&PostMeasTask, TaskFunc, Param, ParamSize);
-		EventSet(EventBaseband);
+		EventSet(EventPostMeas);
 		break;
 	case TASK_INOUT:
 		ReturnValue = AddTaskToQueue(&InputOutputTask, TaskFunc, Param, ParamSize);
-		EventSet(EventBaseband);
+		EventSet(EventInputOutput);
 		break;
 	}
 
@@ -153,7 +168,12 @@ void TaskProcThread(void *Param)
 	while (1)
 	{
 		EventWait(TaskQueue->Event);
+		// baseband tasks write channel state (bit sync result, toggle count etc.) read by ISR
+		if (TaskQueue == &BasebandTask)
+			ENTER_ISR_EXCLUSIVE();
 		DoTaskQueue(TaskQueue);
+		if (TaskQueue == &BasebandTask)
+			EXIT_ISR_EXCLUSIVE();
 	}
 }
 
@@ -12,7 +12,28 @@
 #include "PlatformCtrl.h"
 #include "TaskQueue.h"
 
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+
+// rejected task is output at ERROR level if parameter too large, at WARNING level if queue full
+#if !defined OUTPUT_MASK_TASK_QUEUE
+#define OUTPUT_MASK_TASK_QUEUE OUTPUT_LEVEL_ERROR
+#endif
+
 static void ReleaseWaitItem(PTASK_QUEUE TaskQueue);
+static int AddTaskToRing(PTASK_RING TaskRing, TaskFunction TaskFunc, void *Param, int ParamSize);
+static int DoTaskRing(PTASK_RING TaskRing);
+
+// index of lock free queue is read with acquire and written with release semantics
+// PC build with MSVC targets x86/x64, where preventing compiler reordering is enough
+#if defined _MSC_VER
+static unsigned int LoadAcquire(volatile unsigned int *Index) { unsigned int Value = *Index; _ReadWriteBarrier(); return Value; }
+static void StoreRelease(volatile unsigned int *Index, unsigned int Value) { _ReadWriteBarrier(); *Index = Value; }
+#else
+static unsigned int LoadAcquire(volatile unsigned int *Index) { return __atomic_load_n(Index, __ATOMIC_ACQUIRE); }
+static void StoreRelease(volatile unsigned int *Index, unsigned int Value) { __atomic_store_n(Index, Value, __ATOMIC_RELEASE); }
+#endif
 
 //*************** Initial task queue ****************
 // Parameters:
@@ -41,6 +62,30 @@ void InitTaskQueue(PTASK_QUEUE TaskQueue, TASK_ITEM ItemArray[], int ItemNumber,
 	// put link list in empty queue and wait queue as empty
 	TaskQueue->AvailableQueue = ItemArray;
 	TaskQueue->WaitQueue = TaskQueue->QueueTail = 0;
+	TaskQueue->TaskRing = (PTASK_RING)NULL;
+}
+
+//*************** Initial lock free task queue ****************
+//* enqueue and dequeue need no critical section if each side is called in one context only
+// Parameters:
+//   TaskQueue: pointer to task queue structure
+//   TaskRing: pointer to ring holding head and tail index
+//   SlotArray: task slot array
+//   SlotNumber: size of task slot array, must be power of 2
+//   Event: event to wake up the task thread
+//   MultiProducer: none zero if tasks are added in more than one context
+// Return value:
+//   none
+void InitLockFreeQueue(PTASK_QUEUE TaskQueue, PTASK_RING TaskRing, TASK_SLOT SlotArray[], int SlotNumber, U32 Event, int MultiProducer)
+{
+	memset(TaskQueue, 0, sizeof(TASK_QUEUE));
+	memset(TaskRing, 0, sizeof(TASK_RING));
+	TaskRing->SlotArray = SlotArray;
+	TaskRing->SlotNumber = (unsigned int)SlotNumber;
+	TaskRing->MultiProducer = MultiProducer;
+	TaskQueue->ItemNumber = SlotNumber;
+	TaskQueue->Event = Event;
+	TaskQueue->TaskRing = TaskRing;
 }
 
 //*************** Add one task to task queue ****************
@@ -58,6 +103,8 @@ int AddTaskToQueue(PTASK_QUEUE TaskQueue, TaskFunction TaskFunc, void *Param, in
 	void *ParamPointer;
 	int NewWritePosition;
 
+	if (TaskQueue->TaskRing)
+		return AddTaskToRing(TaskQueue->TaskRing, TaskFunc, Param, ParamSize);
 	// determine whether there is available task
 	if (TaskQueue->AvailableQueue == NULL)
 		return 0;
@@ -177,6 +224,8 @@ int DoTaskQueue(PTASK_QUEUE TaskQueue)
 	PTASK_ITEM Task;
 	int TaskNumber = 0;
 	
+	if (TaskQueue->TaskRing)
+		return DoTaskRing(TaskQueue->TaskRing);
 	while ((Task = TaskQueue->WaitQueue) != NULL)
 	{
 		TaskNumber ++;
@@ -185,3 +234,87 @@ int DoTaskQueue(PTASK_QUEUE TaskQueue)
 	}
 	return TaskNumber;
 }
+
+//*************** Get number of tasks waiting in task queue ****************
+//* task being performed is also counted
+// Parameters:
+//   TaskQueue: pointer to task queue structure
+// Return value:
+//   number of tasks waiting
+int WaitTaskNumber(PTASK_QUEUE TaskQueue)
+{
+	PTASK_ITEM Task;
+	int Number = 0;
+
+	if (TaskQueue->TaskRing)
+		return (int)(LoadAcquire(&TaskQueue->TaskRing->Tail) - LoadAcquire(&TaskQueue->TaskRing->Head));
+	ENTER_CRITICAL();
+	for (Task = TaskQueue->WaitQueue; Task != NULL; Task = Task->pNextItem)
+		Number ++;
+	EXIT_CRITICAL();
+	return Number;
+}
+
+//*************** Add one task to lock free queue ****************
+//* slot is filled before Tail is published, so consumer never sees a partial task
+// Parameters:
+//   TaskRing: pointer to ring of task queue
+//   TaskFunc: pointer to task function
+//   Param: pointer to parameter passed to task function
+//   ParamSize: size of parameter in bytes
+// Return value:
+//   return none zero if success
+static int AddTaskToRing(PTASK_RING TaskRing, TaskFunction TaskFunc, void *Param, int ParamSize)
+{
+	unsigned int Tail;
+	PTASK_SLOT Slot;
+
+	if (ParamSize > TASK_SLOT_PARAM_SIZE)
+	{
+		DEBUG_OUTPUT(OUTPUT_CONTROL(TASK_QUEUE, ERROR), "Task %p rejected, parameter size %d over %d\n", (void *)TaskFunc, ParamSize, TASK_SLOT_PARAM_SIZE);
+		return 0;
+	}
+	if (TaskRing->MultiProducer)
+		ENTER_CRITICAL();
+	Tail = TaskRing->Tail;
+	if (Tail - LoadAcquire(&TaskRing->Head) >= TaskRing->SlotNumber)	// queue full
+	{
+		if (TaskRing->MultiProducer)
+			EXIT_CRITICAL();
+		DEBUG_OUTPUT(OUTPUT_CONTROL(TASK_QUEUE, WARNING), "Task %p rejected, queue full\n", (void *)TaskFunc);
+		return 0;
+	}
+	Slot = &TaskRing->SlotArray[Tail & (TaskRing->SlotNumber - 1)];
+	Slot->CallbackFunction = TaskFunc;
+	Slot->ParamSize = (ParamSize + 3) / 4;
+	if (ParamSize)
+		memcpy(Slot->Param, Param, ParamSize);
+	StoreRelease(&TaskRing->Tail, Tail + 1);
+	if (TaskRing->MultiProducer)
+		EXIT_CRITICAL();
+	return 1;
+}
+
+//*************** Do tasks in lock free queue until it is empty ****************
+//* slot is released after task done, so parameter can be used by task function directly
+// Parameters:
+//   TaskRing: pointer to ring of task queue
+// Return value:
+//   number of tasks performed
+static int DoTaskRing(PTASK_RING TaskRing)
+{
+	unsigned int Head = TaskRing->Head, Tail;
+	PTASK_SLOT Slot;
+	int TaskNumber = 0;
+
+	while (Head != (Tail = LoadAcquire(&TaskRing->Tail)))
+	{
+		for (; Head != Tail; TaskNumber ++)
+		{
+			Slot = &TaskRing->SlotArray[Head & (TaskRing->SlotNumber - 1)];
+			Slot->CallbackFunction(Slot->Param);
+			StoreRelease(&TaskRing->Head, ++ Head);
+		}
+	}
+	return TaskNumber;
+}
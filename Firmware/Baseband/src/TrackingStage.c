@@ -117,9 +117,9 @@ void SwitchTrackingStage(PCHANNEL_STATE ChannelState, unsigned int TrackingStage
 				ChannelState->CarrierFreqBase = ChannelState->CarrierFreqSave = ChannelState->StateBufferCache.CarrierFreq;
 				ChannelState->State |= (STATE_4QUAD_DISC | DATA_STREAM_PRN2 | STATE_ENABLE_BOC | STATE_CACHE_FREQ_DIRTY);
 				// adjust carrier phase
-				StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->CarrierPhase)));
+				StateValue = GetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CarrierPhase)));
 				StateValue += 0x40000000;	// compensate pi/2 for sideband to BOC tracking and pi for negative stream
-				SetRegValue((U32)(&(ChannelState->StateBufferHW->CarrierPhase)), StateValue);
+				SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CarrierPhase)), StateValue);
 				// enable NH
 				STATE_BUF_SET_NH_CONFIG(&(ChannelState->StateBufferCache), 25, 0x9b501c);
 				// set current NH count and coherent count
@@ -161,9 +161,9 @@ void SwitchTrackingStage(PCHANNEL_STATE ChannelState, unsigned int TrackingStage
 			ChannelState->State |= (STATE_4QUAD_DISC | DATA_STREAM_PRN2 | STATE_ENABLE_BOC | NH_SEGMENT_UPDATE | STATE_CACHE_FREQ_DIRTY);
 			Time += ChannelState->BitSyncResult & 0x7ff;
 			// adjust carrier phase
-			StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->CarrierPhase)));
+			StateValue = GetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CarrierPhase)));
 			StateValue += (ChannelState->BitSyncResult & 0x1000) ? 0xc0000000 : 0x40000000;	// compensate pi/2 for sideband to BOC tracking and pi for negative stream
-			SetRegValue((U32)(&(ChannelState->StateBufferHW->CarrierPhase)), StateValue);
+			SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CarrierPhase)), StateValue);
 			// enable NH
 			Time %= 1800;	// determine bit position at current time
 			ChannelState->NHIndex = Time / 20;
@@ -218,9 +218,9 @@ int StageDetermination(PCHANNEL_STATE ChannelState)
 				Jump = (ChannelState->DelayDiff + 57344) / 16384 - 3;	// apply 3.5 CorInterval offset (16384) then round down to get nearest rounding
 				if (Jump != 0)
 				{
-					StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->DumpCount)));
+					StateValue = GetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->DumpCount)));
 					StateValue |= (Jump & 0xff) << 8;
-					SetRegValue((U32)(&(ChannelState->StateBufferHW->DumpCount)),  StateValue);
+					SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->DumpCount)),  StateValue);
 				}
 				SwitchTrackingStage(ChannelState, STAGE_TRACK0);
 				ChannelState->CarrLoseLockCounter = ChannelState->CodeLoseLockCounter = 0;
@@ -237,9 +237,9 @@ int StageDetermination(PCHANNEL_STATE ChannelState)
 				if (ChannelState->CodeSearchCount == 5)
 					ChannelState->CodeSearchCount = 0;
 				Jump *= 7;
-				StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->DumpCount)));
+				StateValue = GetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->DumpCount)));
 				StateValue |= (Jump & 0xff) << 8;
-				SetRegValue((U32)(&(ChannelState->StateBufferHW->DumpCount)),  StateValue);
+				SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->DumpCount)),  StateValue);
 			}
 		}
 		break;
@@ -309,9 +309,9 @@ int StageDetermination(PCHANNEL_STATE ChannelState)
 			// in track 1 stage, will use acc data to determine symbol
 			if (SIGNAL_IS_L1CA(ChannelState->Signal) && (((ChannelState->DataStream.PrevReal >> 31) & 1) ^ (ChannelState->DataStream.Symbols & 1)))
 			{
-				StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->CarrierPhase)));
+				StateValue = GetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CarrierPhase)));
 				StateValue ^= 0x80000000;
-				SetRegValue((U32)(&(ChannelState->StateBufferHW->CarrierPhase)),  StateValue);
+				SetRegValue((U32)(size_t)(&(ChannelState->StateBufferHW->CarrierPhase)),  StateValue);
 			}
 		}
 		else	// weak signal switch to track 2
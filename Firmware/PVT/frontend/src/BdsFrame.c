@@ -21,6 +21,7 @@
 #define SUBFRAME3_LENGTH 8
 #define PAYLOAD_LENGTH (SUBFRAME2_LENGTH + SUBFRAME3_LENGTH)	// 18 DWORD for subframe2 and 8 DWORD for subframe3
 #define PACKAGE_LENGTH (sizeof(SYMBOL_PACKAGE) + sizeof(unsigned int)*(PAYLOAD_LENGTH))	// 3 variables + 26 payload
+TASK_PARAM_SIZE_CHECK(BdsSymbolPackage, PACKAGE_LENGTH);
 
 extern U32 EphAlmMutex;
 
@@ -19,6 +19,7 @@
 
 #define PAYLOAD_LENGTH 4	// 128bit page contents
 #define PACKAGE_LENGTH (sizeof(SYMBOL_PACKAGE) + sizeof(unsigned int)*(PAYLOAD_LENGTH))	// 3 variables + 4 payload
+TASK_PARAM_SIZE_CHECK(GalSymbolPackage, PACKAGE_LENGTH);
 
 extern U32 EphAlmMutex;
 
@@ -21,6 +21,7 @@
 #define MAX_GPS_TOW		100799
 #define PAYLOAD_LENGTH 10
 #define PACKAGE_LENGTH (sizeof(SYMBOL_PACKAGE) + sizeof(unsigned int)*(PAYLOAD_LENGTH))	// 3 variables + 10 payload
+TASK_PARAM_SIZE_CHECK(GpsSymbolPackage, PACKAGE_LENGTH);
 
 // word in data array with following order
 #define WORD1  (data[9])
@@ -199,9 +199,9 @@ int MsrProc(PBB_MEAS_PARAM MeasParam)
 			g_ChannelStatus[ch_num].SatID = SatID;
 		}
 		g_ChannelStatus[ch_num].Channel = ch_num;
-		g_ChannelStatus[ch_num].cn0 = (unsigned short)Measurements[ch_num].ChannelState->CN0;
-		g_ChannelStatus[ch_num].LockTime = Measurements[ch_num].ChannelState->TrackingTime;
-		g_ChannelStatus[ch_num].state = Measurements[ch_num].ChannelState->State;
+		g_ChannelStatus[ch_num].cn0 = (unsigned short)Measurements[ch_num].CN0;
+		g_ChannelStatus[ch_num].LockTime = Measurements[ch_num].TrackingTime;
+		g_ChannelStatus[ch_num].state = Measurements[ch_num].State;
 		g_ChannelStatus[ch_num].ChannelFlag |= CHANNEL_ACTIVE;
 	}
 
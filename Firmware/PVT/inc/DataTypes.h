@@ -22,7 +22,7 @@
 typedef int BOOL;
 #endif
 
-typedef enum {	UnknownTime = 0,	// no time information
+typedef enum TimeAccuracy {	UnknownTime = 0,	// no time information
 				ExtSetTime,			// time from external source (eg. RTC, network etc.)
 				CoarseTime,			// time from satellite signal transmit time minus average travel time
 				KeepTime,			// time after aligned to epoch of observation
@@ -34,6 +34,7 @@ double ScaleDoubleLong(long long value, int scale);
 double ScaleDoubleULong(unsigned long long value, int scale);
 BOOL GpsParityCheck(unsigned int word);
 unsigned int Crc24qEncode(unsigned int *BitStream, int Length);
+unsigned int Crc24qBytes(const unsigned char *Data, int Length);
 
 // conversion functions
 void EcefToLlh(const KINEMATIC_INFO *ecef_pos, LLH *llh_pos);
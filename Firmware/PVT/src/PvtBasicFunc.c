@@ -210,6 +210,18 @@ unsigned int Crc24qEncode(unsigned int *BitStream, int Length)
 	return crc_result & 0xffffff;
 }
 
+// CRC24Q of byte stream, same as used by RTCM3 frames
+unsigned int Crc24qBytes(const unsigned char *Data, int Length)
+{
+	int i;
+	unsigned int crc_result = 0;
+
+	for (i = 0; i < Length; i ++)
+		crc_result = (crc_result << 8) ^ Crc24QTable[Data[i] ^ (unsigned char)(crc_result >> 16)];
+
+	return crc_result & 0xffffff;
+}
+
 void LoadAllParameters()
 {
 	LoadParameters(PARAM_OFFSET_CONFIG, &g_PvtConfig, sizeof(g_PvtConfig));
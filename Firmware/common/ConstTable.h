@@ -9,6 +9,6 @@
 #ifndef __CONST_TABLE_H__
 #define __CONST_TABLE_H__
 
-const unsigned int B1CSecondCode[63][57];
+extern const unsigned int B1CSecondCode[63][57];
 
 #endif //__CONST_TABLE_H__
\ No newline at end of file
@@ -5,14 +5,20 @@
 #include "RegAddress.h"
 #include "InitSet.h"
 #include "HWCtrl.h"
+#include "ModelProfile.h"
 extern "C" {
 #include "FirmwarePortal.h"
 }
 
-void main()
+int main(int argc, char *argv[])
 {
-	SetInputFile("..\\..\\..\\data\\sim_signal_L1CA.bin");
+	SetInputFile((argc > 1) ? argv[1] : (char *)"../../../data/sim_signal_L1CA.bin");
+	// per second profile output, only has content when built with MODEL_PROFILE
+	if (argc > 2)
+		ProfileSetCsv(argv[2]);
 
-	FirmwareInitialize();
+	FirmwareInitialize(ColdStart, (PSYSTEM_TIME)0, (LLH *)0);	// IF file has no time and position information
 	EnableRF();
+
+	return 0;
 }
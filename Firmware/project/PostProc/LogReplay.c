@@ -0,0 +1,526 @@
+//----------------------------------------------------------------------
+// LogReplay.c:
+//   Baseband log replay engine used by post process
+//   log file is memory mapped and parsed into replay items
+//   parser runs on its own thread and items are passed to PVT in order through a bounded queue
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined _WIN32
+#include <windows.h>
+#define REPLAY_THREAD 0
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#define REPLAY_THREAD 1
+#endif
+
+#include "SystemConfig.h"
+#include "ComposeOutput.h"
+#include "SupportPackage.h"
+#include "LogReplay.h"
+
+#define REPLAY_QUEUE_MASK (REPLAY_QUEUE_SIZE - 1)
+#define MAX_PAYLOAD_LENGTH (BB_RECORD_MAX_LENGTH - BB_RECORD_HEADER_LENGTH - BB_RECORD_CRC_LENGTH)
+
+typedef struct
+{
+	const unsigned char *Data;
+	long long Size;
+	ReplayFunction ItemFunction;
+	int Pipelined;
+	long long Items;
+	int Epochs;
+	REPLAY_ITEM *Queue;
+	// following variables accessed by parser thread only
+	unsigned int WriteIndex;	// next queue slot to fill
+	unsigned int FreeIndex;		// Head seen by parser last time
+	// following variables shared between threads and protected by Mutex
+	unsigned int Head;		// next item to be processed by PVT
+	unsigned int Tail;		// items before Tail are visible to PVT
+	int Finished;
+#if REPLAY_THREAD
+	pthread_mutex_t Mutex;
+	pthread_cond_t NotEmpty;
+	pthread_cond_t NotFull;
+#endif
+#if defined _WIN32
+	HANDLE File, Mapping;
+#endif
+} REPLAY_CONTEXT, *PREPLAY_CONTEXT;
+
+static double WallTime()
+{
+	struct timespec Time;
+
+	timespec_get(&Time, TIME_UTC);
+	return Time.tv_sec + Time.tv_nsec * 1e-9;
+}
+
+//*************** Map whole log file into memory ****************
+// Parameters:
+//   Context: Data and Size filled
+//   FileName: log file name
+// Return value:
+//   0 if file cannot be opened or mapped
+static int MapLogFile(PREPLAY_CONTEXT Context, const char *FileName)
+{
+#if defined _WIN32
+	LARGE_INTEGER Size;
+
+	Context->Data = NULL;
+	Context->Mapping = NULL;
+	if ((Context->File = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL)) == INVALID_HANDLE_VALUE)
+		return 0;
+	GetFileSizeEx(Context->File, &Size);
+	if ((Context->Size = Size.QuadPart) == 0)	// empty file cannot be mapped
+		return 1;
+	if ((Context->Mapping = CreateFileMappingA(Context->File, NULL, PAGE_READONLY, 0, 0, NULL)) == NULL ||
+		(Context->Data = (const unsigned char *)MapViewOfFile(Context->Mapping, FILE_MAP_READ, 0, 0, 0)) == NULL)
+	{
+		if (Context->Mapping)
+			CloseHandle(Context->Mapping);
+		CloseHandle(Context->File);
+		return 0;
+	}
+	return 1;
+#else
+	int fd;
+	struct stat FileStat;
+	void *Data;
+
+	Context->Data = NULL;
+	if ((fd = open(FileName, O_RDONLY)) < 0)
+		return 0;
+	if (fstat(fd, &FileStat) < 0)
+	{
+		close(fd);
+		return 0;
+	}
+	if ((Context->Size = FileStat.st_size) == 0)	// empty file cannot be mapped
+	{
+		close(fd);
+		return 1;
+	}
+	Data = mmap(NULL, (size_t)Context->Size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (Data == MAP_FAILED)
+		return 0;
+	madvise(Data, (size_t)Context->Size, MADV_SEQUENTIAL);
+	Context->Data = (const unsigned char *)Data;
+	return 1;
+#endif
+}
+
+static void UnmapLogFile(PREPLAY_CONTEXT Context)
+{
+#if defined _WIN32
+	if (Context->Data)
+		UnmapViewOfFile(Context->Data);
+	if (Context->Mapping)
+		CloseHandle(Context->Mapping);
+	CloseHandle(Context->File);
+#else
+	if (Context->Data)
+		munmap((void *)Context->Data, (size_t)Context->Size);
+#endif
+}
+
+#if REPLAY_THREAD
+// make items before WriteIndex visible to PVT thread and get latest Head
+static void PublishItems(PREPLAY_CONTEXT Context, int Finished)
+{
+	pthread_mutex_lock(&Context->Mutex);
+	Context->Tail = Context->WriteIndex;
+	Context->Finished = Finished;
+	pthread_cond_signal(&Context->NotEmpty);
+	Context->FreeIndex = Context->Head;
+	pthread_mutex_unlock(&Context->Mutex);
+}
+#endif
+
+//*************** Send one parsed item to PVT ****************
+//* item is processed immediately if not pipelined
+//* otherwise put into queue and published in batch of REPLAY_PUBLISH_SIZE
+// Parameters:
+//   Context: replay context
+//   Item: item to send
+static void EmitItem(PREPLAY_CONTEXT Context, PREPLAY_ITEM Item)
+{
+	Context->Items ++;
+	if (Item->Type == REPLAY_MEAS_END)
+		Context->Epochs ++;
+#if REPLAY_THREAD
+	if (Context->Pipelined)
+	{
+		if (Context->WriteIndex - Context->FreeIndex == REPLAY_QUEUE_SIZE)	// queue full, wait PVT to free slots
+		{
+			PublishItems(Context, 0);
+			pthread_mutex_lock(&Context->Mutex);
+			while (Context->WriteIndex - Context->Head == REPLAY_QUEUE_SIZE)
+				pthread_cond_wait(&Context->NotFull, &Context->Mutex);
+			Context->FreeIndex = Context->Head;
+			pthread_mutex_unlock(&Context->Mutex);
+		}
+		Context->Queue[Context->WriteIndex & REPLAY_QUEUE_MASK] = *Item;
+		if (++ Context->WriteIndex - Context->Tail >= REPLAY_PUBLISH_SIZE)	// Tail only changed by this thread
+			PublishItems(Context, 0);
+		return;
+	}
+#endif
+	Context->ItemFunction(Item);
+}
+
+//*************** Parse comma separated fields of a text sentence ****************
+//* Format has one character for each field, 'x' for hex, 'c' for single character, decimal otherwise
+//* leading spaces are skipped as sscanf() does, negative value wraps for unsigned field
+// Parameters:
+//   p: start of first field
+//   End: end of line
+//   Format: field types
+//   Value: array to hold field values
+// Return value:
+//   number of fields successfully parsed
+static int ParseFields(const char *p, const char *End, const char *Format, U32 *Value)
+{
+	int Number = 0, Negative, Digits, Hex;
+	U32 Data;
+	char Char;
+
+	for (; *Format; Format ++, Number ++)
+	{
+		if (*Format == 'c')
+		{
+			if (p >= End)
+				return Number;
+			Value[Number] = (U32)(unsigned char)*p ++;
+		}
+		else
+		{
+			while (p < End && (*p == ' ' || *p == '\t'))
+				p ++;
+			Negative = (p < End && *p == '-');
+			if (p < End && (*p == '-' || *p == '+'))
+				p ++;
+			Hex = (*Format == 'x');
+			for (Data = 0, Digits = 0; p < End; p ++, Digits ++)
+			{
+				Char = *p;
+				if (Char >= '0' && Char <= '9')
+					Data = (Hex ? (Data << 4) : (Data * 10)) + (Char - '0');
+				else if (Hex && (Char | 0x20) >= 'a' && (Char | 0x20) <= 'f')
+					Data = (Data << 4) + ((Char | 0x20) - 'a' + 10);
+				else
+					break;
+			}
+			if (Digits == 0)
+				return Number;
+			Value[Number] = Negative ? (0 - Data) : Data;
+		}
+		if (p < End && *p == ',')
+			p ++;
+	}
+	return Number;
+}
+
+//*************** Parse text sentences ****************
+//* each sentence with all fields valid becomes one item, others are ignored
+// Parameters:
+//   Context: replay context
+static void ParseTextLog(PREPLAY_CONTEXT Context)
+{
+	const char *Line = (const char *)Context->Data, *FileEnd = Line + Context->Size;
+	const char *LineEnd, *p;
+	REPLAY_ITEM Item = { 0 };
+	U32 Value[13];
+
+	for (; Line < FileEnd; Line = LineEnd + 1)
+	{
+		if ((LineEnd = (const char *)memchr(Line, '\n', FileEnd - Line)) == NULL)
+			LineEnd = FileEnd;
+		if ((p = (const char *)memchr(Line, '$', LineEnd - Line)) == NULL || LineEnd - p < 7)
+			continue;
+		if (memcmp(p, "$PDATA", 6) == 0)
+		{
+			if (ParseFields(p + 7, LineEnd, "dddddx", Value) != 6)
+				continue;
+			Item.Type = REPLAY_DATA;
+			Item.LogicChannel = (int)Value[0];
+			Item.Svid = (int)Value[1];
+			Item.Signal = (int)Value[2];
+			Item.u.Data.SymbolIndex = (int)Value[3];
+			Item.u.Data.TickCount = Value[4];
+			Item.u.Data.DataStream = Value[5];
+		}
+		else if (memcmp(p, "$PMSRP", 6) == 0)
+		{
+			if (ParseFields(p + 7, LineEnd, "dddd", Value) != 4)
+				continue;
+			Item.Type = REPLAY_MEAS_BEGIN;
+			Item.u.Begin.TickCount = Value[1];
+			Item.u.Begin.Interval = (int)Value[2];
+			Item.u.Begin.ClockAdjust = (int)Value[3];
+		}
+		else if (memcmp(p, "$PBMSR", 6) == 0)
+		{
+			if (ParseFields(p + 7, LineEnd, "ddddddddddxdd", Value) != 13)
+				continue;
+			Item.Type = REPLAY_MEAS_CHANNEL;
+			Item.LogicChannel = (int)Value[0];
+			Item.Svid = (int)Value[1];
+			Item.Signal = (int)Value[2];
+			Item.u.Meas.CarrierFreq = (S32)Value[3];
+			Item.u.Meas.CarrierPhase = Value[4];
+			Item.u.Meas.CarrierCount = (S32)Value[5];
+			Item.u.Meas.CodeCount = (S32)Value[6];
+			Item.u.Meas.CodePhase = Value[7];
+			Item.u.Meas.WeekMsCount = (int)Value[9];	// Value[8] is code rate, not used
+			Item.u.Meas.State = Value[10];
+			Item.u.Meas.CN0 = (int)Value[11];
+			Item.u.Meas.TrackingTime = (int)Value[12];
+		}
+		else if (memcmp(p, "$PMSRE", 6) == 0)
+		{
+			if (ParseFields(p + 7, LineEnd, "cdd", Value) != 3)
+				continue;
+			Item.Type = REPLAY_MEAS_END;
+			Item.u.End.TimeQuality = (char)Value[0];
+			Item.u.End.GpsMsCount = (int)Value[1];
+			Item.u.End.BdsMsCount = (int)Value[2];
+		}
+		else
+			continue;
+		EmitItem(Context, &Item);
+	}
+}
+
+static U32 GetU32(const unsigned char **Buffer)
+{
+	const unsigned char *p = *Buffer;
+
+	*Buffer += 4;
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((U32)p[3] << 24);
+}
+
+//*************** Convert one binary record with valid CRC to items ****************
+// Parameters:
+//   Context: replay context
+//   Record: start of record
+//   Length: payload length
+static void EmitRecord(PREPLAY_CONTEXT Context, const unsigned char *Record, int Length)
+{
+	const unsigned char *p = Record + BB_RECORD_HEADER_LENGTH;
+	int i, ChannelNumber, TimeQuality;
+	REPLAY_ITEM Item;
+
+	if (Record[2] > BB_RECORD_VERSION)	// layout of newer version unknown
+		return;
+	if (Record[3] == BB_RECORD_DATA && Length >= BB_DATA_LENGTH)
+	{
+		Item.Type = REPLAY_DATA;
+		Item.LogicChannel = p[0];
+		Item.Svid = p[1];
+		Item.Signal = p[2];
+		p += 3;
+		Item.u.Data.SymbolIndex = (int)GetU32(&p);
+		Item.u.Data.TickCount = GetU32(&p);
+		Item.u.Data.DataStream = GetU32(&p);
+		EmitItem(Context, &Item);
+	}
+	else if (Record[3] == BB_RECORD_MEAS && Length >= BB_MEAS_EPOCH_LENGTH)
+	{
+		ChannelNumber = p[BB_MEAS_EPOCH_LENGTH - 1];
+		if (Length < BB_MEAS_EPOCH_LENGTH + ChannelNumber * BB_MEAS_CHANNEL_LENGTH)
+			return;
+		Item.Type = REPLAY_MEAS_BEGIN;
+		Item.LogicChannel = Item.Svid = Item.Signal = 0;
+		Item.u.Begin.TickCount = GetU32(&p);
+		Item.u.Begin.Interval = (int)GetU32(&p);
+		Item.u.Begin.ClockAdjust = (int)GetU32(&p);
+		EmitItem(Context, &Item);
+		Item.Type = REPLAY_MEAS_END;
+		Item.u.End.GpsMsCount = (int)GetU32(&p);
+		Item.u.End.BdsMsCount = (int)GetU32(&p);
+		TimeQuality = p[0];
+		Item.u.End.TimeQuality = (TimeQuality < 5) ? "UECKA"[TimeQuality] : 'U';
+		p += 2;
+		for (i = 0; i < ChannelNumber; i ++, p += BB_MEAS_CHANNEL_LENGTH)
+		{
+			const unsigned char *Field = p + 5;
+			REPLAY_ITEM ChannelItem;
+
+			ChannelItem.Type = REPLAY_MEAS_CHANNEL;
+			ChannelItem.LogicChannel = p[0];
+			ChannelItem.Svid = p[1];
+			ChannelItem.Signal = p[2];
+			ChannelItem.u.Meas.CN0 = p[3] | (p[4] << 8);
+			ChannelItem.u.Meas.CarrierFreq = (S32)GetU32(&Field);
+			ChannelItem.u.Meas.CarrierPhase = GetU32(&Field);
+			ChannelItem.u.Meas.CarrierCount = (S32)GetU32(&Field);
+			ChannelItem.u.Meas.CodeCount = (S32)GetU32(&Field);
+			ChannelItem.u.Meas.CodePhase = GetU32(&Field);
+			ChannelItem.u.Meas.WeekMsCount = (int)GetU32(&Field);
+			ChannelItem.u.Meas.State = GetU32(&Field);
+			ChannelItem.u.Meas.TrackingTime = (int)GetU32(&Field);
+			EmitItem(Context, &ChannelItem);
+		}
+		EmitItem(Context, &Item);
+	}
+}
+
+//*************** Parse binary records ****************
+//* on sync or CRC error, search restarts from the byte following the sync byte
+//* incomplete record at end of file is ignored
+// Parameters:
+//   Context: replay context
+static void ParseBinaryLog(PREPLAY_CONTEXT Context)
+{
+	const unsigned char *p = Context->Data, *End = p + Context->Size;
+	int Length;
+	unsigned int Crc;
+
+	while (End - p >= BB_RECORD_HEADER_LENGTH)
+	{
+		if (p[0] != BB_RECORD_SYNC0)
+		{
+			if ((p = (const unsigned char *)memchr(p, BB_RECORD_SYNC0, End - p)) == NULL)
+				break;
+			continue;
+		}
+		Length = p[4] | (p[5] << 8);
+		if (p[1] != BB_RECORD_SYNC1 || Length > MAX_PAYLOAD_LENGTH)
+		{
+			p ++;
+			continue;
+		}
+		if (End - p < BB_RECORD_HEADER_LENGTH + Length + BB_RECORD_CRC_LENGTH)
+			break;
+		Crc = (p[BB_RECORD_HEADER_LENGTH + Length] << 16) | (p[BB_RECORD_HEADER_LENGTH + Length + 1] << 8) | p[BB_RECORD_HEADER_LENGTH + Length + 2];
+		if (Crc != Crc24qBytes(p, BB_RECORD_HEADER_LENGTH + Length))
+		{
+			p ++;
+			continue;
+		}
+		EmitRecord(Context, p, Length);
+		p += BB_RECORD_HEADER_LENGTH + Length + BB_RECORD_CRC_LENGTH;
+	}
+}
+
+// binary record stream starts with sync byte, text sentences start with '$'
+static void *ParseLog(void *Param)
+{
+	PREPLAY_CONTEXT Context = (PREPLAY_CONTEXT)Param;
+
+	if (Context->Size > 0)
+	{
+		if (Context->Data[0] == BB_RECORD_SYNC0)
+			ParseBinaryLog(Context);
+		else
+			ParseTextLog(Context);
+	}
+#if REPLAY_THREAD
+	if (Context->Pipelined)
+		PublishItems(Context, 1);
+#endif
+	return NULL;
+}
+
+#if REPLAY_THREAD
+//*************** Process items in queue until parser finished ****************
+//* all items published are taken at once, slots are freed after processed
+// Parameters:
+//   Context: replay context
+static void ProcessQueue(PREPLAY_CONTEXT Context)
+{
+	unsigned int Index, Tail;
+	int Finished;
+
+	while (1)
+	{
+		pthread_mutex_lock(&Context->Mutex);
+		while (Context->Head == Context->Tail && !Context->Finished)
+			pthread_cond_wait(&Context->NotEmpty, &Context->Mutex);
+		Tail = Context->Tail;
+		Finished = Context->Finished;
+		pthread_mutex_unlock(&Context->Mutex);
+		if (Context->Head == Tail && Finished)
+			break;
+
+		for (Index = Context->Head; Index != Tail; Index ++)
+			Context->ItemFunction(&Context->Queue[Index & REPLAY_QUEUE_MASK]);
+
+		pthread_mutex_lock(&Context->Mutex);
+		Context->Head = Tail;
+		pthread_cond_signal(&Context->NotFull);
+		pthread_mutex_unlock(&Context->Mutex);
+	}
+}
+#endif
+
+//*************** Replay a baseband log file ****************
+//* items are given to ItemFunction in the same order as in file
+//* if pipelined, parser runs on a new thread and ItemFunction is called on the calling thread
+//* pipelining is not available on Windows and the file is parsed on the calling thread
+// Parameters:
+//   FileName: log file name, text sentences or binary records
+//   ItemFunction: function to process each item
+//   Pipelined: none zero to parse on a separate thread
+//   Stat: replay statistics, REPLAY_MEAS_END items are counted as epochs
+// Return value:
+//   0 if file cannot be opened or mapped
+int ReplayLogFile(const char *FileName, ReplayFunction ItemFunction, int Pipelined, PREPLAY_STAT Stat)
+{
+	REPLAY_CONTEXT Context;
+	double StartTime = WallTime();
+
+	memset(&Context, 0, sizeof(Context));
+	if (!MapLogFile(&Context, FileName))
+		return 0;
+	Context.ItemFunction = ItemFunction;
+#if REPLAY_THREAD
+	if (Pipelined && (Context.Queue = (REPLAY_ITEM *)malloc(REPLAY_QUEUE_SIZE * sizeof(REPLAY_ITEM))) != NULL)
+	{
+		pthread_t ParseThread;
+
+		pthread_mutex_init(&Context.Mutex, NULL);
+		pthread_cond_init(&Context.NotEmpty, NULL);
+		pthread_cond_init(&Context.NotFull, NULL);
+		Context.Pipelined = 1;
+		if (pthread_create(&ParseThread, NULL, ParseLog, &Context) == 0)
+		{
+			ProcessQueue(&Context);
+			pthread_join(ParseThread, NULL);
+		}
+		else
+		{
+			Context.Pipelined = 0;
+			ParseLog(&Context);
+		}
+		pthread_cond_destroy(&Context.NotFull);
+		pthread_cond_destroy(&Context.NotEmpty);
+		pthread_mutex_destroy(&Context.Mutex);
+		free(Context.Queue);
+	}
+	else
+#endif
+		ParseLog(&Context);
+	UnmapLogFile(&Context);
+
+	if (Stat)
+	{
+		Stat->Bytes = Context.Size;
+		Stat->Items = Context.Items;
+		Stat->Epochs = Context.Epochs;
+		Stat->Seconds = WallTime() - StartTime;
+	}
+	return 1;
+}
@@ -0,0 +1,48 @@
+//----------------------------------------------------------------------
+// LogReplay.h:
+//   Declaration of baseband log replay engine used by post process
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __LOG_REPLAY_H__
+#define __LOG_REPLAY_H__
+
+#include "CommonDefines.h"
+
+// replay item types, one text sentence or part of one binary record each
+#define REPLAY_DATA				0	// $PDATA or data record
+#define REPLAY_MEAS_BEGIN		1	// $PMSRP or epoch header of measurement record
+#define REPLAY_MEAS_CHANNEL		2	// $PBMSR or one channel of measurement record
+#define REPLAY_MEAS_END			3	// $PMSRE or end of measurement record
+
+#define REPLAY_QUEUE_SIZE		4096	// items in queue between parser and PVT, must be power of 2
+#define REPLAY_PUBLISH_SIZE		64		// items handed to PVT thread at once
+
+typedef struct
+{
+	int Type;
+	int LogicChannel, Svid, Signal;		// for REPLAY_DATA and REPLAY_MEAS_CHANNEL
+	union
+	{
+		struct { int SymbolIndex; U32 TickCount; U32 DataStream; } Data;
+		struct { U32 TickCount; int Interval; int ClockAdjust; } Begin;
+		struct { S32 CarrierFreq; U32 CarrierPhase; S32 CarrierCount; S32 CodeCount; U32 CodePhase; int WeekMsCount; U32 State; int CN0; int TrackingTime; } Meas;
+		struct { char TimeQuality; int GpsMsCount; int BdsMsCount; } End;
+	} u;
+} REPLAY_ITEM, *PREPLAY_ITEM;
+
+typedef struct
+{
+	long long Bytes;		// size of log file
+	long long Items;		// items parsed
+	int Epochs;				// REPLAY_MEAS_END items
+	double Seconds;			// wall time from mapping to last item processed
+} REPLAY_STAT, *PREPLAY_STAT;
+
+typedef void (*ReplayFunction)(PREPLAY_ITEM Item);
+
+int ReplayLogFile(const char *FileName, ReplayFunction ItemFunction, int Pipelined, PREPLAY_STAT Stat);
+
+#endif //__LOG_REPLAY_H__
@@ -9,6 +9,7 @@
 #include "TimeManager.h"
 #include "PvtEntry.h"
 #include "SystemConfig.h"
+#include "LogReplay.h"
 
 CHANNEL_STATE ChannelStateArray[TOTAL_CHANNEL_NUMBER];
 int FrameInfoInit[TOTAL_CHANNEL_NUMBER];
@@ -26,25 +27,23 @@ extern void SaveAllParameters();
 
 enum TimeAccuracy GetTimeQuality(char TimeQuanlity);
 
+static void ApplyReplayItem(PREPLAY_ITEM Item);
+
+// usage: PostProc [file] [pipe|serial]
+//   pipe: log parsed on a separate thread (default)
+//   serial: log parsed and processed on one thread
 int main(int argc, char *argv[])
 {
 	char MessageBuffer[256];
-	FILE *fp_bbmsg;
-	int i, MeasurementNumber = 0;
-	int LogicChannel, Svid, FreqID;
-	PBB_MEASUREMENT BasebandMeas;
-	int CodeRate;
-	char TimeQuality;
-	int DataNumber;
+	int i;
+	int Pipelined = !(argc > 2 && strcmp(argv[2], "serial") == 0);
+	REPLAY_STAT Stat;
 
 	if (argc > 1)
 		strcpy(MessageBuffer, argv[1]);
 	else
 		strcpy(MessageBuffer, "test_obs2.bbo");
 
-	if ((fp_bbmsg = fopen(MessageBuffer, "r")) == NULL)
-		return 1;
-
 	MeasurementParam.MeasMask = 0;
 	memset(ChannelStateArray, 0, sizeof(ChannelStateArray));
 	for (i = 0; i < TOTAL_CHANNEL_NUMBER; i ++)
@@ -58,50 +57,71 @@ int main(int argc, char *argv[])
 	PvtProcInit(ColdStart, &InitTime, &InitPosition);
 	NominalMeasInterval = DEFAULT_MEAS_INTERVAL;
 
-	while (!feof(fp_bbmsg))
+	if (!ReplayLogFile(MessageBuffer, ApplyReplayItem, Pipelined, &Stat))
+		return 1;
+	// PVT output may go to stdout, so statistics goes to stderr
+	fprintf(stderr, "%d epochs (%lld items, %lld bytes) in %.3fs, %.1f epochs/s\n", Stat.Epochs, Stat.Items, Stat.Bytes, Stat.Seconds,
+		(Stat.Seconds > 0) ? Stat.Epochs / Stat.Seconds : 0.);
+	SaveAllParameters();
+	return 0;
+}
+
+//*************** Process one item from log replay ****************
+//* text sentences and binary records both come here, so bad input is handled in one place
+//* channel of $PBMSR is marked only when all fields are valid (whole sentence dropped by parser otherwise)
+//* tasks are only added by data decode and measurement process, so DoAllTasks() called after them
+// Parameters:
+//   Item: replay item
+static void ApplyReplayItem(PREPLAY_ITEM Item)
+{
+	PBB_MEASUREMENT BasebandMeas;
+
+	switch (Item->Type)
 	{
-		fgets(MessageBuffer, 255, fp_bbmsg);
-		if (strstr(MessageBuffer, "$PDATA"))	// baseband data message
-		{
-			if ((DataNumber = sscanf(MessageBuffer + 7, "%d,%d,%d\r\n", &LogicChannel, &Svid, &FreqID)) != 3)
-				continue;
-			ChannelStateArray[LogicChannel].Svid = Svid;
-			ChannelStateArray[LogicChannel].FreqID = FreqID;
-			DataForDecode.ChannelState = &ChannelStateArray[LogicChannel];
-			if ((DataNumber = sscanf(MessageBuffer + 16, "%d,%u,%x\r\n", &(DataForDecode.SymbolIndex), &(DataForDecode.TickCount), &(DataForDecode.DataStream))) == 3)
-				DoDataDecode((void *)(&DataForDecode));
-		}
-		else if (strstr(MessageBuffer, "$PMSRP"))	// begin of baseband measurement
-		{
-			if ((DataNumber = sscanf(MessageBuffer + 7, "%d,%d,%d,%d", &MeasurementNumber, &(MeasurementParam.TickCount), &(MeasurementParam.Interval), &(MeasurementParam.ClockAdjust))) != 4)
-				continue;
-			MeasurementParam.MeasMask = 0;
-		}
-		else if (strstr(MessageBuffer, "$PBMSR"))	// baseband measurement of one channel
-		{
-			if ((DataNumber = sscanf(MessageBuffer + 7, "%d,%d,%d\r\n", &LogicChannel, &Svid, &FreqID)) != 3)
-				continue;
-			ChannelStateArray[LogicChannel].Svid = Svid;
-			ChannelStateArray[LogicChannel].FreqID = FreqID;
-			MeasurementParam.MeasMask |= (1 << LogicChannel);
-			BasebandMeas = &BasebandMeasurement[LogicChannel];
-			if ((DataNumber = sscanf(MessageBuffer + 16, "%u,%u,%u,%d,%u,%d,%d,%x,%d,%u\r\n",
-				&(BasebandMeas->CarrierFreq), &(BasebandMeas->CarrierPhase), &(BasebandMeas->CarrierCount), &(BasebandMeas->CodeCount), &(BasebandMeas->CodePhase), &CodeRate,
-				&(BasebandMeas->WeekMsCount), &(BasebandMeas->ChannelState->State), &(BasebandMeas->ChannelState->CN0), &(BasebandMeas->ChannelState->TrackingTime))) != 10)
-				continue;
-		}
-		else if (strstr(MessageBuffer, "$PMSRE"))	// end of baseband measurement
-		{
-			if ((DataNumber = sscanf(MessageBuffer + 7, "%c,%d,%d", &TimeQuality, &(GnssTime.GpsMsCount), &(GnssTime.BdsMsCount))) == 3)
-			{
-				GnssTime.TickCount = MeasurementParam.TickCount;
-				GnssTime.TimeQuality = GetTimeQuality(TimeQuality);
-				MeasProcTask((void *)(&MeasurementParam));
-			}
-		}
+	case REPLAY_DATA:
+		if ((unsigned int)Item->LogicChannel >= TOTAL_CHANNEL_NUMBER)
+			return;
+		ChannelStateArray[Item->LogicChannel].Svid = Item->Svid;
+		ChannelStateArray[Item->LogicChannel].Signal = Item->Signal;
+		DataForDecode.ChannelState = &ChannelStateArray[Item->LogicChannel];
+		DataForDecode.SymbolIndex = Item->u.Data.SymbolIndex;
+		DataForDecode.TickCount = Item->u.Data.TickCount;
+		DataForDecode.DataStream = Item->u.Data.DataStream;
+		DoDataDecode((void *)(&DataForDecode));
+		DoAllTasks();
+		break;
+	case REPLAY_MEAS_BEGIN:
+		MeasurementParam.TickCount = Item->u.Begin.TickCount;
+		MeasurementParam.Interval = Item->u.Begin.Interval;
+		MeasurementParam.ClockAdjust = Item->u.Begin.ClockAdjust;
+		MeasurementParam.MeasMask = 0;
+		break;
+	case REPLAY_MEAS_CHANNEL:
+		if ((unsigned int)Item->LogicChannel >= TOTAL_CHANNEL_NUMBER)
+			return;
+		ChannelStateArray[Item->LogicChannel].Svid = Item->Svid;
+		ChannelStateArray[Item->LogicChannel].Signal = Item->Signal;
+		MeasurementParam.MeasMask |= (1 << Item->LogicChannel);
+		BasebandMeas = &BasebandMeasurement[Item->LogicChannel];
+		BasebandMeas->CarrierFreq = Item->u.Meas.CarrierFreq;
+		BasebandMeas->CarrierPhase = Item->u.Meas.CarrierPhase;
+		BasebandMeas->CarrierCount = Item->u.Meas.CarrierCount;
+		BasebandMeas->CodeCount = Item->u.Meas.CodeCount;
+		BasebandMeas->CodePhase = Item->u.Meas.CodePhase;
+		BasebandMeas->WeekMsCount = Item->u.Meas.WeekMsCount;
+		BasebandMeas->State = Item->u.Meas.State;
+		BasebandMeas->CN0 = Item->u.Meas.CN0;
+		BasebandMeas->TrackingTime = Item->u.Meas.TrackingTime;
+		break;
+	case REPLAY_MEAS_END:
+		GnssTime.GpsMsCount = Item->u.End.GpsMsCount;
+		GnssTime.BdsMsCount = Item->u.End.BdsMsCount;
+		GnssTime.TickCount = MeasurementParam.TickCount;
+		GnssTime.TimeQuality = GetTimeQuality(Item->u.End.TimeQuality);
+		MeasProcTask((void *)(&MeasurementParam));
 		DoAllTasks();
+		break;
 	}
-	SaveAllParameters();
 }
 
 PCHANNEL_STATE GetChannelStateArray(int Group)
@@ -0,0 +1,138 @@
+//----------------------------------------------------------------------
+// NoiseCheck.cpp:
+//   Self check of SimModel Gauss noise generator and covariance factor cache
+//   fixed seed sequence, mean/variance of each sampler, covariance of relative noise
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <math.h>
+
+#include "GaussNoise.h"
+
+#define SAMPLE_NUMBER 1000000
+#define COVAR_DIM 8
+#define COVAR_VECTORS 200000
+
+// top 53bit of first xoshiro256** outputs of NOISE_DEFAULT_SEED stream 0, from reference implementation
+static const unsigned long long UniformGolden[4] = {
+	0xaa6183bd712e4ULL, 0x153f54381c6ee1ULL, 0x1d74a72baba214ULL, 0x6751b76f470baULL,
+};
+// first ziggurat values of NOISE_DEFAULT_SEED stream NOISE_STREAM_CHANNEL, from reference implementation
+// table is built with libm exp/log, so only compared to 1e-12
+static const double ZigguratGolden[4] = {
+	0.5042549599949167, -0.3999870271886616, -0.6827234585872867, 0.9917865680756167,
+};
+
+static int ErrorCount = 0;
+
+static void Check(bool Pass, const char *Item, double Value, double Expected)
+{
+	printf("%-40s %14.10f %14.10f %s\n", Item, Value, Expected, Pass ? "ok" : "FAIL");
+	if (!Pass)
+		ErrorCount ++;
+}
+
+// uniform stream is integer only, so it must match reference bit by bit
+static void CheckUniformSequence()
+{
+	int i;
+	unsigned long long Value;
+
+	SetNoiseGenerator(NOISE_GEN_ZIGGURAT, NOISE_DEFAULT_SEED);
+	for (i = 0; i < 4; i ++)
+	{
+		Value = (unsigned long long)(GenerateUniform() * 9007199254740992.);
+		Check(Value == UniformGolden[i], "uniform sequence", (double)Value, (double)UniformGolden[i]);
+	}
+}
+
+static void CheckNormalSequence()
+{
+	int i;
+	NOISE_RNG Rng;
+	complex_number Noise[2];
+
+	SetNoiseGenerator(NOISE_GEN_ZIGGURAT, NOISE_DEFAULT_SEED);
+	NoiseRngSeed(&Rng, NOISE_DEFAULT_SEED, NOISE_STREAM_CHANNEL);
+	Noise[0] = GenerateNoise(&Rng, 1.0);
+	Noise[1] = GenerateNoise(&Rng, 1.0);
+	for (i = 0; i < 4; i ++)
+	{
+		double Value = (i & 1) ? Noise[i >> 1].imag : Noise[i >> 1].real;
+		Check(fabs(Value - ZigguratGolden[i]) < 1e-12, "ziggurat sequence", Value, ZigguratGolden[i]);
+	}
+}
+
+// mean 0 and variance Sigma^2 on each of real and imaginary part, 5 sigma bound of estimation error
+static void CheckMoments(int Generator, const char *Name)
+{
+	int i;
+	double Sigma = 2.0, Sum = 0, SumSq = 0, Tail = 0, Mean, Variance;
+	complex_number Noise;
+	char Item[64];
+
+	SetNoiseGenerator(Generator, NOISE_DEFAULT_SEED);
+	for (i = 0; i < SAMPLE_NUMBER; i ++)
+	{
+		Noise = GenerateNoise(Sigma);
+		Sum += Noise.real + Noise.imag;
+		SumSq += Noise.real * Noise.real + Noise.imag * Noise.imag;
+		Tail += (fabs(Noise.real) > 3 * Sigma) + (fabs(Noise.imag) > 3 * Sigma);
+	}
+	Mean = Sum / (2 * SAMPLE_NUMBER);
+	Variance = SumSq / (2 * SAMPLE_NUMBER) - Mean * Mean;
+	Tail /= 2 * SAMPLE_NUMBER;
+	snprintf(Item, sizeof(Item), "%s mean", Name);
+	Check(fabs(Mean) < 5 * Sigma / sqrt(2. * SAMPLE_NUMBER), Item, Mean, 0.0);
+	snprintf(Item, sizeof(Item), "%s variance", Name);
+	Check(fabs(Variance - Sigma * Sigma) < 5 * Sigma * Sigma * sqrt(2. / (2 * SAMPLE_NUMBER)), Item, Variance, Sigma * Sigma);
+	// P(|x|>3 sigma) = erfc(3/sqrt(2)) = 0.0026998, checks ziggurat tail and wedge
+	snprintf(Item, sizeof(Item), "%s P(|x|>3 sigma)", Name);
+	Check(fabs(Tail - 0.0026998) < 5 * sqrt(0.0026998 / (2 * SAMPLE_NUMBER)), Item, Tail, 0.0026998);
+}
+
+// empirical covariance of batched relative noise against triangular correlation model
+static void CheckCovariance(int Interval)
+{
+	static complex_number Noise[COVAR_VECTORS * COVAR_DIM];
+	const double *Factor = GetCovarFactor(COVAR_DIM, Interval);
+	double Covar, Expected, MaxError = 0;
+	NOISE_RNG Rng;
+	int i, j, n, diff;
+	char Item[64];
+
+	Check(Factor == GetCovarFactor(COVAR_DIM, Interval), "covariance factor cached", 1.0, 1.0);
+	NoiseRngSeed(&Rng, NOISE_DEFAULT_SEED, 1);
+	GenerateRelativeNoiseBatch(COVAR_DIM, Interval, Factor, 1.0, COVAR_VECTORS, Noise, &Rng);
+	for (i = 0; i < COVAR_DIM; i ++)
+		for (j = 0; j <= i; j ++)
+		{
+			Covar = 0;
+			for (n = 0; n < COVAR_VECTORS; n ++)
+				Covar += Noise[n * COVAR_DIM + i].real * Noise[n * COVAR_DIM + j].real + Noise[n * COVAR_DIM + i].imag * Noise[n * COVAR_DIM + j].imag;
+			Covar /= 2 * COVAR_VECTORS;
+			diff = i - j;
+			Expected = (diff >= Interval) ? 0.0 : 1 - (double)diff / Interval;
+			if (MaxError < fabs(Covar - Expected))
+				MaxError = fabs(Covar - Expected);
+		}
+	snprintf(Item, sizeof(Item), "covariance Interval=%d max error", Interval);
+	Check(MaxError < 5 * sqrt(2. / (2 * COVAR_VECTORS)), Item, MaxError, 0.0);
+}
+
+int main()
+{
+	CheckUniformSequence();
+	CheckNormalSequence();
+	CheckMoments(NOISE_GEN_ZIGGURAT, "ziggurat");
+	CheckMoments(NOISE_GEN_POLAR, "polar");
+	CheckMoments(NOISE_GEN_RAND, "rand");
+	CheckCovariance(2);
+	CheckCovariance(4);
+	CheckCovariance(8);
+	printf("%d check(s) failed\n", ErrorCount);
+	return ErrorCount ? 1 : 0;
+}
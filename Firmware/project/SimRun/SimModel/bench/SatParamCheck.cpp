@@ -0,0 +1,162 @@
+//----------------------------------------------------------------------
+// SatParamCheck.cpp:
+//   Error budget check of satellite parameter interpolation in SimModel
+//   range and relative speed of circular orbit satellites over half a day are interpolated
+//   between exact nodes and compared with exact values at every millisecond
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <math.h>
+
+#include "SatParamInterp.h"
+
+#define MU 3.986005e14
+#define OMEGA_E 7.2921151467e-5
+#define LIGHT_SPEED 299792458.
+#define DEG2RAD (3.1415926535897932384626433832795 / 180)
+#define DIFF_STEP 1e-2		// step in second to get range rate by differential
+
+#define SAT_NUMBER 24
+#define START_NUMBER 12		// start time every hour over half a day
+
+typedef struct
+{
+	double a, inc, raan, m0;
+} ORBIT;
+
+// receiver state at time Start, propagated with Acc
+typedef struct
+{
+	double Start;
+	double Pos[3], Vel[3], Acc[3];
+} RECEIVER;
+
+static int ErrorCount = 0;
+
+static void SatPos(const ORBIT *Orbit, double t, double Pos[3])
+{
+	double u = Orbit->m0 + sqrt(MU / (Orbit->a * Orbit->a * Orbit->a)) * t;
+	double raan = Orbit->raan - OMEGA_E * t;	// earth fixed frame
+	double x = Orbit->a * cos(u), y = Orbit->a * sin(u) * cos(Orbit->inc), z = Orbit->a * sin(u) * sin(Orbit->inc);
+
+	Pos[0] = x * cos(raan) - y * sin(raan);
+	Pos[1] = x * sin(raan) + y * cos(raan);
+	Pos[2] = z;
+}
+
+static void ReceiverPos(const RECEIVER *Receiver, double t, double Pos[3])
+{
+	int i;
+
+	t -= Receiver->Start;
+	for (i = 0; i < 3; i ++)
+		Pos[i] = Receiver->Pos[i] + (Receiver->Vel[i] + 0.5 * Receiver->Acc[i] * t) * t;
+}
+
+// state at time t to predict from, acceleration of prediction replaced by Acc
+static void ReceiverState(const RECEIVER *Receiver, double t, const double Acc[3], RECEIVER *State)
+{
+	int i;
+
+	ReceiverPos(Receiver, t, State->Pos);
+	for (i = 0; i < 3; i ++)
+	{
+		State->Vel[i] = Receiver->Vel[i] + Receiver->Acc[i] * (t - Receiver->Start);
+		State->Acc[i] = Acc[i];
+	}
+	State->Start = t;
+}
+
+// geometric range with light travel time
+static double Range(const ORBIT *Orbit, const RECEIVER *Receiver, double t)
+{
+	int i, j;
+	double Sat[3], Rcv[3], Distance = 0, TravelTime = 0.07;
+
+	ReceiverPos(Receiver, t, Rcv);
+	for (i = 0; i < 10; i ++)
+	{
+		SatPos(Orbit, t - TravelTime, Sat);
+		for (j = 0, Distance = 0; j < 3; j ++)
+			Distance += (Sat[j] - Rcv[j]) * (Sat[j] - Rcv[j]);
+		Distance = sqrt(Distance);
+		TravelTime = Distance / LIGHT_SPEED;
+	}
+	return Distance;
+}
+
+static double RangeRate(const ORBIT *Orbit, const RECEIVER *Receiver, double t)
+{
+	return (-Range(Orbit, Receiver, t + 2 * DIFF_STEP) + 8 * Range(Orbit, Receiver, t + DIFF_STEP)
+		- 8 * Range(Orbit, Receiver, t - DIFF_STEP) + Range(Orbit, Receiver, t - 2 * DIFF_STEP)) / (12 * DIFF_STEP);
+}
+
+// each node is calculated with receiver predicted from its state 2 intervals earlier using PredictAcc
+// as when SimModel moves to next interval, true receiver moves with Receiver->Acc
+static void CheckInterval(const RECEIVER *Receiver, const double PredictAcc[3], int Interval, const char *Name)
+{
+	int sat, start, i, ms;
+	double t0, t, Coef[SAT_PARAM_NODES], NodeRange[SAT_PARAM_NODES], NodeSpeed[SAT_PARAM_NODES];
+	double RangeError, SpeedError, MaxRangeError = 0, MaxSpeedError = 0;
+	ORBIT Orbit;
+	RECEIVER Truth = *Receiver, Predict;
+	bool Pass;
+
+	for (sat = 0; sat < SAT_NUMBER; sat ++)
+	{
+		Orbit.a = 26560e3; Orbit.inc = 55 * DEG2RAD; Orbit.raan = 15 * sat * DEG2RAD; Orbit.m0 = 37 * sat * DEG2RAD;
+		for (start = 0; start < START_NUMBER; start ++)
+		{
+			t0 = start * 3600.;
+			Truth.Start = t0;
+			for (i = 0; i < SAT_PARAM_NODES; i ++)
+			{
+				t = t0 + (i - 1) * Interval / 1000.;
+				ReceiverState(&Truth, t - 2 * Interval / 1000., PredictAcc, &Predict);
+				NodeRange[i] = Range(&Orbit, &Predict, t);
+				NodeSpeed[i] = RangeRate(&Orbit, &Predict, t);
+			}
+			for (ms = 0; ms < Interval; ms ++)
+			{
+				t = t0 + ms / 1000.;
+				SatParamInterpCoef((double)ms / Interval, Coef);
+				RangeError = fabs(SatParamInterp(Coef, NodeRange[0], NodeRange[1], NodeRange[2], NodeRange[3]) - Range(&Orbit, &Truth, t));
+				SpeedError = fabs(SatParamInterp(Coef, NodeSpeed[0], NodeSpeed[1], NodeSpeed[2], NodeSpeed[3]) - RangeRate(&Orbit, &Truth, t));
+				MaxRangeError = (RangeError > MaxRangeError) ? RangeError : MaxRangeError;
+				MaxSpeedError = (SpeedError > MaxSpeedError) ? SpeedError : MaxSpeedError;
+			}
+		}
+	}
+	Pass = MaxRangeError < SAT_PARAM_RANGE_BUDGET && MaxSpeedError < SAT_PARAM_SPEED_BUDGET;
+	printf("%-36s %4dms: max range error %.3em, max speed error %.3em/s %s\n", Name, Interval, MaxRangeError, MaxSpeedError, Pass ? "ok" : "FAIL");
+	if (!Pass)
+		ErrorCount ++;
+}
+
+int main()
+{
+	static const int Intervals[] = { 2, 5, 10, SAT_PARAM_INTERVAL, 50, 100, 200 };
+	double Lat = 30 * DEG2RAD;
+	RECEIVER Static = { 0, { 6378137 * cos(Lat), 0, 6378137 * sin(Lat) }, { 0, 0, 0 }, { 0, 0, 0 } };
+	RECEIVER Dynamic = { 0, { 6378137 * cos(Lat), 0, 6378137 * sin(Lat) }, { 200, 100, 0 }, { 5, -3, 2 } };
+	RECEIVER Drift = Dynamic;
+	int i;
+
+	// acceleration changes just below threshold on all axes, so SimModel keeps predicting with old acceleration
+	for (i = 0; i < 3; i ++)
+		Drift.Acc[i] += SAT_PARAM_ACC_THRESHOLD;
+
+	for (i = 0; i < (int)(sizeof(Intervals) / sizeof(Intervals[0])); i ++)
+	{
+		CheckInterval(&Static, Static.Acc, Intervals[i], "static receiver");
+		CheckInterval(&Dynamic, Dynamic.Acc, Intervals[i], "constant acceleration receiver");
+	}
+	// prediction error of receiver grows with square of interval, so only intervals up to default are within budget
+	for (i = 0; Intervals[i] <= SAT_PARAM_INTERVAL; i ++)
+		CheckInterval(&Drift, Dynamic.Acc, Intervals[i], "acceleration at threshold");
+	printf("%d check(s) failed\n", ErrorCount);
+	return ErrorCount ? 1 : 0;
+}
@@ -15,8 +15,29 @@
 #define SUM_N(n) (((n)*(n+1))>>1)	// 1 sum to n
 #define DIAG_INDEX(n) (SUM_N(n)+n)	// diagonal index of n
 
+// Gauss noise generator selection
+#define NOISE_GEN_RAND		0	// libc rand() with Box-Muller, sequence depends on C library
+#define NOISE_GEN_ZIGGURAT	1	// xoshiro256** with ziggurat sampler (default)
+#define NOISE_GEN_POLAR		2	// xoshiro256** with polar Box-Muller sampler
+
+#define NOISE_DEFAULT_SEED 0x5eed5eed5eed5eedULL
+#define NOISE_STREAM_CHANNEL 0x10000	// first stream index of per channel streams, below are thread streams
+
+// state of xoshiro256** uniform generator, one for each thread or noise stream
+typedef struct
+{
+	unsigned long long s[4];
+} NOISE_RNG;
+
+void SetNoiseGenerator(int Generator, unsigned long long Seed);
+unsigned long long GetNoiseSeed();
+void NoiseRngSeed(NOISE_RNG *Rng, unsigned long long Seed, unsigned int Stream);
+double GenerateUniform();
 complex_number GenerateNoise(double Sigma);
+complex_number GenerateNoise(NOISE_RNG *Rng, double Sigma);
 void CalculateCovar(int dim, int Interval, double CovarMatrix[]);
-void GenerateRelativeNoise(int dim, int max_index, double CovarMatrix[], double Sigma, complex_number Noise[]);
+const double *GetCovarFactor(int dim, int Interval);
+void GenerateRelativeNoise(int dim, int max_index, const double CovarMatrix[], double Sigma, complex_number Noise[]);
+void GenerateRelativeNoiseBatch(int dim, int max_index, const double CovarMatrix[], double Sigma, int Number, complex_number Noise[], NOISE_RNG *Rng);
 
 #endif //!defined(__GAUSS_NOISE_H__)
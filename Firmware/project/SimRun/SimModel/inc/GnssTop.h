@@ -13,6 +13,10 @@
 #include "TeFifoSim.h"
 #include "AcqEngineFast.h"
 #include "TrackingEngine.h"
+#include "SatParamInterp.h"
+
+// scenario gives start time and position (UtcTime and StartPos), IF file of C model does not
+#define GNSS_TOP_SCENARIO
 
 typedef void (*InterruptFunction)();
 typedef int S32;
@@ -22,6 +26,14 @@ typedef unsigned int U32;
 #define TOTAL_BDS_SAT 63
 #define TOTAL_GAL_SAT 50
 
+// exact satellite parameters at 4 nodes around current time, parameters between nodes are interpolated
+struct SatParamHistory
+{
+	SATELLITE_PARAM Node[SAT_PARAM_NODES];	// Node[1] is at or before current time
+	int NodeNumber;			// number of valid nodes
+	unsigned int NodeTime;	// ParamTime of Node[1]
+};
+
 class CGnssTop
 {
 public:
@@ -31,6 +43,8 @@ public:
 	void Clear(U32 ClearMask);
 	void SetRegValue(int Address, U32 Value);
 	U32 GetRegValue(int Address);
+	void SetRegBurst(int Address, const U32 *Buffer, int WordNumber);
+	void GetRegBurst(int Address, U32 *Buffer, int WordNumber);
 
 	// global registers
 	U32 TrackingEngineEnable;		// 1bit
@@ -63,6 +77,13 @@ public:
 	PSATELLITE_PARAM SatParamList[TOTAL_GPS_SAT+TOTAL_BDS_SAT+TOTAL_GAL_SAT];
 	int GpsSatNumber, BdsSatNumber, GalSatNumber;	// number of visible GPS satellite
 	int TotalSatNumber;	// total number of visible GPS satellite
+	SatParamHistory GpsHistory[TOTAL_GPS_SAT], BdsHistory[TOTAL_BDS_SAT], GalHistory[TOTAL_GAL_SAT];
+	int SatParamInterval;	// 1 to calculate exact satellite parameters every millisecond
+	int SatParamCheck;		// compare interpolated parameters with exact values
+	unsigned int ParamTime;	// milliseconds since scenario start
+	double PrevVel[3], RefAcc[3];	// receiver velocity of last millisecond and acceleration used to predict nodes ahead
+	double MaxRangeError, MaxSpeedError;	// maximum error found in check mode
+	int OverBudgetCount;	// interpolations replaced by exact values in check mode
 
 	CTrackingEngine TrackingEngine;
 	CAcqEngine AcqEngine;
@@ -71,8 +92,14 @@ public:
 
 	int Process(int BlockSize);
 	void SetInputFile(char *FileName);
+	void SetThreadNumber(int ThreadNumber) { TrackingEngine.SetParallelMode(ThreadNumber); }
 	int StepToNextTime();
 	void UpdateSatParamList();
+	void UpdateSatParam(GnssSystem system, PGPS_EPHEMERIS Eph, LLA_POSITION &PosLLA, SATELLITE_PARAM *SatParam, SatParamHistory *History);
+	void PredictSatParam(GnssSystem system, PGPS_EPHEMERIS Eph, int OffsetMs, SATELLITE_PARAM *SatParam);
+	void SetSatParamInterval(int Interval, int Check);
+	void ResetSatParamHistory();
+	void SetTEBuffer(int Index, U32 Value);
 	int GetAeProcessTime();
 
 	InterruptFunction InterruptService;
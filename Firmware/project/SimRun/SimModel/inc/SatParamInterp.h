@@ -0,0 +1,27 @@
+//----------------------------------------------------------------------
+// SatParamInterp.h:
+//   Definition of cubic interpolation of satellite parameters between exact nodes
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined (__SAT_PARAM_INTERP_H__)
+#define __SAT_PARAM_INTERP_H__
+
+// exact satellite parameters are calculated at nodes -1, 0, 1 and 2 (in unit of interval)
+// parameters within [0, 1) are interpolated by cubic polynomial through the 4 nodes
+#define SAT_PARAM_NODES 4
+
+// nodes ahead use receiver predicted with constant acceleration over 2 intervals, with acceleration change just
+// below SAT_PARAM_ACC_THRESHOLD on all axes this gives 1.4e-5m and 7e-4m/s at 20ms, speed is over budget beyond 20ms
+// interpolation itself stays at rounding level (3e-8m, 3e-6m/s) up to 200ms, checked by SatParamCheck
+#define SAT_PARAM_INTERVAL 20			// default interval in ms of exact satellite parameter calculation, 1 for no interpolation
+#define SAT_PARAM_ACC_THRESHOLD 0.01	// receiver acceleration change (m/s^2) to restart from exact calculation
+#define SAT_PARAM_RANGE_BUDGET 1e-4		// maximum range error (m) of interpolation allowed in check mode
+#define SAT_PARAM_SPEED_BUDGET 1e-3		// maximum relative speed error (m/s) of interpolation allowed in check mode
+
+void SatParamInterpCoef(double x, double Coef[SAT_PARAM_NODES]);
+double SatParamInterp(const double Coef[SAT_PARAM_NODES], double Value0, double Value1, double Value2, double Value3);
+
+#endif //!defined(__SAT_PARAM_INTERP_H__)
@@ -40,7 +40,7 @@ public:
 	void SetChannelStates(unsigned int AddressOffset, U32 Value);
 	U32 GetChannelStates(unsigned int AddressOffset);
 	int FindSvid(unsigned int ConfigArray[], int ArraySize, U32 PrnConfig);
-	void GetCorrelationResult(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, int DumpDataI[], int DumpDataQ[], int CorIndex[], int CorPos[], int NHCode[], int DataLength);
+	void GetCorrelationResult(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, int DumpDataI[], int DumpDataQ[], int CorIndex[], int CorPos[], int NHCode[], int DataLength, complex_number RelativeNoise[]);
 	int CalculateCounter(int BlockSize, int CorIndex[], int CorPos[], int NHCode[], int &DataLength);
 	void DecodeDataAcc(int DataValue);
 	double NarrowCompensation(int CorIndex, int NarrowFactor);
@@ -92,8 +92,8 @@ public:
 	// for carrier difference calculation
 	CarrierState CarrierParam;
 
-	// co-variance matrix to generate relative Gauss noise
-	static double CovarMatrix[4][SUM_N(COR_NUMBER)];
+	// factor of co-variance matrix to generate relative Gauss noise, from GetCovarFactor()
+	static const double *CovarMatrix[4];
 
 	// correlation peak shape values
 	static const double Bpsk4PeakValues[160];
@@ -12,11 +12,14 @@
 #include "CommonDefines.h"
 #include "SignalSim.h"
 #include "TrackingChannel.h"
+#include "GaussNoise.h"
+#include "WorkerPool.h"
 
 #define LOGICAL_CHANNEL_NUMBER 32
 #define TE_BUFFER_SIZE (LOGICAL_CHANNEL_NUMBER * 128)
 #define COR_NUMBER 8
 #define NOISE_AMP 625.
+#define MAX_NOISE_ROUND 2	// at most 16 correlator outputs in 1ms, so 2 rounds of correlator 0~7
 
 class CTrackingEngine
 {
@@ -37,6 +40,8 @@ public:
 	void SetTEBuffer(unsigned int Address, U32 Value);
 	U32 GetTEBuffer(unsigned int Address);
 	int ProcessData(int BlockSize, GNSS_TIME CurTime, PSATELLITE_PARAM SatParam[], int SatNumber);
+	void SetParallelMode(int ThreadNumber);
+	static void ChannelTask(void *Param, int TaskIndex, int WorkerIndex);
 
 	SATELLITE_PARAM* FindSatParam(int ChannelId, PSATELLITE_PARAM SatParam[], int SatNumber);
 
@@ -44,6 +49,23 @@ public:
 	CTrackingChannel LogicChannel[LOGICAL_CHANNEL_NUMBER];
 	int SmoothScale;
 	double NoiseFloor;
+	complex_number RelativeNoise[LOGICAL_CHANNEL_NUMBER * MAX_NOISE_ROUND * COR_NUMBER];	// relative noise of all channels in 1ms
+
+	// counters and correlation results of each channel within ProcessData()
+	int CorIndex[LOGICAL_CHANNEL_NUMBER][16], CorPos[LOGICAL_CHANNEL_NUMBER][16];
+	int NHCode[LOGICAL_CHANNEL_NUMBER][16];
+	int DataLength[LOGICAL_CHANNEL_NUMBER];
+	int NoiseRound[LOGICAL_CHANNEL_NUMBER], NoiseOffset[LOGICAL_CHANNEL_NUMBER];
+	int DumpDataI[LOGICAL_CHANNEL_NUMBER][16], DumpDataQ[LOGICAL_CHANNEL_NUMBER][16];
+
+	// parallel mode, correlation results calculated on worker threads with noise stream of each channel
+	CWorkerPool *WorkerPool;
+	NOISE_RNG ChannelRng[LOGICAL_CHANNEL_NUMBER];
+	int ParallelChannelNumber;
+	int ParallelChannelIndex[LOGICAL_CHANNEL_NUMBER];
+	GNSS_TIME TaskTime;
+	PSATELLITE_PARAM *TaskSatParam;
+	int TaskSatNumber;
 };
 
 #endif //__TRACKING_ENGINE_SIM_H__
@@ -216,8 +216,8 @@ U32 CAcqEngine::GetRegValue(int Address)
 #define NONCOH_TABLE_VALUE(N, Table) ((N <= 20) ? Table[N-1] : Table[19] + (Table[19]-Table[18]) * (N-20));
 void CAcqEngine::GetNoisePeaks(double NoisePeaks[3])
 {
-	int RandomValue, Segment;
-	double SegmentWidth, k, RamdomBasic;
+	int Segment;
+	double RandomValue, SegmentWidth, k, RamdomBasic;
 	double Sigma = SIGMA0 * sqrt((double)CoherentNumber);
 	int SampleFactor = ((CoherentNumber <= DFT_NUMBER) ? CoherentNumber : DFT_NUMBER) * StrideNumber * CodeSpan;
 	double logn = log((double)SampleFactor);
@@ -226,12 +226,12 @@ void CAcqEngine::GetNoisePeaks(double NoisePeaks[3])
 
 	// generate a basic distributed random variable
 //	for (int i = 0; i < 500000; i ++) {
-	RandomValue = rand();	// a value between 0 and RAND_MAX
-	Segment = RandomValue & 0xff;	// 8bit ramdom value as segment
+	RandomValue = GenerateUniform();	// a value between 0 and 1
+	Segment = (int)(RandomValue * 256);	// 8bit ramdom value as segment
 	SegmentWidth = BasecPdfSegment[Segment+1] - BasecPdfSegment[Segment];	// xb-xa
 	k = (BasicPdfValues[Segment+1] - BasicPdfValues[Segment]) / SegmentWidth;	// (b-a)/(xb-xa)
-	RandomValue = rand();	// a value between 0 and RAND_MAX
-	RamdomBasic = BasicPdfValues[Segment] * BasicPdfValues[Segment] + k * RandomValue / (RAND_MAX+1) / 128;	// a^2+2AkR (A=1/256)
+	RandomValue = GenerateUniform();	// a value between 0 and 1
+	RamdomBasic = BasicPdfValues[Segment] * BasicPdfValues[Segment] + k * RandomValue / 128;	// a^2+2AkR (A=1/256)
 	RamdomBasic = (sqrt(RamdomBasic) - BasicPdfValues[Segment]) / k + BasecPdfSegment[Segment];	// (sqrt(a^2+2AkR)-a)/k+xa
 //	RamdomBasic = (BasecPdfSegment[Segment+1] - BasecPdfSegment[Segment]) * RandomValue / (RAND_MAX+1) + BasecPdfSegment[Segment];	// evenly distributed within segment
 //	printf("%.8f\n", RamdomBasic); } exit(0);
@@ -250,10 +250,10 @@ void CAcqEngine::GetNoisePeaks(double NoisePeaks[3])
 	// get second and third maximum value
 	lambda2 = 1.0 / (LAMBDA_PARAM1 + NonCoherentNumber * LAMBDA_PARAM2);
 	lambda2 += LAMBDA_SLOPE / NonCoherentNumber * logn;
-	RandomValue = RAND_MAX + 1 - rand();	// a value between 1 and RAND_MAX+1
-	NoisePeaks[1] = NoisePeaks[0] + Sigma * log((double)RandomValue / (RAND_MAX+1)) / sqrt(lambda2);
-	RandomValue = RAND_MAX + 1 - rand();	// a value between 1 and RAND_MAX+1
-	NoisePeaks[2] = NoisePeaks[1] + Sigma * log((double)RandomValue / (RAND_MAX+1)) / sqrt(lambda2) / 1.9;
+	RandomValue = 1.0 - GenerateUniform();	// a value between 0 (not included) and 1
+	NoisePeaks[1] = NoisePeaks[0] + Sigma * log(RandomValue) / sqrt(lambda2);
+	RandomValue = 1.0 - GenerateUniform();	// a value between 0 (not included) and 1
+	NoisePeaks[2] = NoisePeaks[1] + Sigma * log(RandomValue) / sqrt(lambda2) / 1.9;
 }
 
 double CAcqEngine::GetSignalPeak(AeBufferSatParam *pSatParam, int &FreqBin, int &Cor)
@@ -444,10 +444,10 @@ void CAcqEngine::SearchOneChannel(AeBufferSatParam *pSatParam, int Channel)
 		{
 			PeakAmp = ((int)NoisePeaks[i]) >> GlobalExp;
 			// random FreqBin
-			PeakFreqBin = (rand() % (8 * StrideNumber)) - (StrideNumber - 1) / 2 * 8;
+			PeakFreqBin = (int)(GenerateUniform() * (8 * StrideNumber)) - (StrideNumber - 1) / 2 * 8;
 			if (CoherentNumber == 1)
 				PeakFreqBin &= ~7;	// no DFT, DFT bin field always 0
-			PeakCor = rand() % MaxCor;
+			PeakCor = (int)(GenerateUniform() * MaxCor);
 		}
 		ChannelConfig[Channel][5+i] = (PeakAmp << 24) | ((PeakFreqBin & 0x1ff) << 15) | PeakCor;
 	}
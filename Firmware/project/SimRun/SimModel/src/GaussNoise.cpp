@@ -10,21 +10,205 @@
 #include <memory.h>
 #include <stdlib.h>
 
+#include <atomic>
+#include <mutex>
+
 #include "GaussNoise.h"
-#include "ConstVal.h"
+
+// only constant needed from SignalSim, so noise generator builds and is checked on its own
+#if !defined PI2
+#define PI2 (3.1415926535897932384626433832795*2)
+#endif
+
+#define ZIG_LAYERS 128
+#define ZIG_R 3.442619855899			// start of tail of 128 layer ziggurat
+#define ZIG_V 9.91256303526217e-3		// area of each layer
+#define UNIFORM_53(value) ((double)(long long)((value) >> 11) * (1.0 / 9007199254740992.))	// top 53bit to [0,1)
+
+#define COVAR_CACHE_SIZE 16
 
 static double CorValue(int diff, int Interval);
 
+// lower triangular factor of covariance matrix for each (dim, Interval) ever requested
+// entries are never replaced, so pointers returned by GetCovarFactor() stay valid
+static struct CovarCacheEntry
+{
+	int dim;
+	int Interval;
+	double Factor[SUM_N(MAX_DIM)];
+} CovarCache[COVAR_CACHE_SIZE];
+static int CovarCacheNumber = 0;
+static std::mutex CovarCacheMutex;
+
+static int NoiseGenerator = NOISE_GEN_ZIGGURAT;
+static unsigned long long NoiseSeed = NOISE_DEFAULT_SEED;
+static std::atomic<unsigned int> SeedGeneration(1);	// increase on each SetNoiseGenerator() to reseed all threads
+static std::atomic<unsigned int> ThreadStream(0);		// stream index assigned to each thread on reseed
+static thread_local NOISE_RNG ThreadRng;
+static thread_local unsigned int ThreadGeneration = 0;
+
+// ziggurat layer boundaries, ZigX[0] is width of base layer including tail, ZigX[ZIG_LAYERS] is 0
+// built with libm exp/log, so normal values (also wedge and tail test) may differ in last bits between libm versions
+static struct ZigguratTable
+{
+	double X[ZIG_LAYERS+1];
+	double F[ZIG_LAYERS+1];	// exp(-x*x/2) at each boundary
+
+	ZigguratTable()
+	{
+		int i;
+
+		F[1] = exp(-0.5 * ZIG_R * ZIG_R);
+		X[0] = ZIG_V / F[1];
+		X[1] = ZIG_R;
+		F[0] = 1.0;		// only used to share the wedge test with other layers, never reached for layer 0
+		for (i = 2; i < ZIG_LAYERS; i ++)
+		{
+			X[i] = sqrt(-2 * log(ZIG_V / X[i-1] + F[i-1]));
+			F[i] = exp(-0.5 * X[i] * X[i]);
+		}
+		X[ZIG_LAYERS] = 0.0;
+		F[ZIG_LAYERS] = 1.0;
+	}
+} Zig;
+
+static unsigned long long SplitMix64(unsigned long long &x)
+{
+	unsigned long long z = (x += 0x9e3779b97f4a7c15ULL);
+
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static inline unsigned long long Rotl(unsigned long long x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+// xoshiro256**, integer only so the uniform sequence is identical on all platforms
+static inline unsigned long long NoiseRngNext(NOISE_RNG *Rng)
+{
+	unsigned long long *s = Rng->s;
+	unsigned long long result = Rotl(s[1] * 5, 7) * 9;
+	unsigned long long t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = Rotl(s[3], 45);
+	return result;
+}
+
+// standard normal value with 128 layer ziggurat (Marsaglia and Tsang)
+// 98.8% of values take the fast path with one 64bit random number and one multiply
+static double ZigguratNormal(NOISE_RNG *Rng)
+{
+	unsigned long long value;
+	int layer;
+	double x, a, b;
+
+	while (1)
+	{
+		value = NoiseRngNext(Rng);
+		layer = (int)(value & (ZIG_LAYERS - 1));	// bit0~6 for layer, bit7 for sign, bit11~63 for position
+		x = UNIFORM_53(value) * Zig.X[layer];
+		if (x < Zig.X[layer+1])	// within rectangle fully under the curve
+			break;
+		if (layer == 0)	// tail beyond ZIG_R
+		{
+			do
+			{
+				a = -log(1.0 - UNIFORM_53(NoiseRngNext(Rng))) / ZIG_R;
+				b = -log(1.0 - UNIFORM_53(NoiseRngNext(Rng)));
+			} while (b + b < a * a);
+			x = ZIG_R + a;
+			break;
+		}
+		// wedge between curve and rectangle
+		if (Zig.F[layer] + UNIFORM_53(NoiseRngNext(Rng)) * (Zig.F[layer+1] - Zig.F[layer]) < exp(-0.5 * x * x))
+			break;
+	}
+	return (value & ZIG_LAYERS) ? -x : x;
+}
+
+// pair of standard normal values with polar Box-Muller, one log and sqrt for two values
+static void PolarNormal(NOISE_RNG *Rng, double &value1, double &value2)
+{
+	double u, v, s;
+
+	do
+	{
+		u = UNIFORM_53(NoiseRngNext(Rng)) * 2 - 1;
+		v = UNIFORM_53(NoiseRngNext(Rng)) * 2 - 1;
+		s = u * u + v * v;
+	} while (s >= 1.0 || s == 0.0);
+	s = sqrt(-2 * log(s) / s);
+	value1 = u * s;
+	value2 = v * s;
+}
+
+// generator of calling thread, each thread gets its own stream after reseed
+static NOISE_RNG *GetThreadRng()
+{
+	unsigned int Generation = SeedGeneration.load(std::memory_order_acquire);
+
+	if (ThreadGeneration != Generation)
+	{
+		NoiseRngSeed(&ThreadRng, NoiseSeed, ThreadStream ++);
+		ThreadGeneration = Generation;
+	}
+	return &ThreadRng;
+}
+
+// select noise generator and seed, call before simulation starts
+// threads reseed on next noise generated, threads are given streams 0, 1, 2... in order of first use
+void SetNoiseGenerator(int Generator, unsigned long long Seed)
+{
+	NoiseGenerator = Generator;
+	NoiseSeed = Seed;
+	if (Generator == NOISE_GEN_RAND)
+		srand((unsigned int)Seed);
+	ThreadStream = 0;
+	SeedGeneration.fetch_add(1, std::memory_order_release);
+}
+
+unsigned long long GetNoiseSeed()
+{
+	return NoiseSeed;
+}
+
+// initialize state from seed with splitmix64, different streams of the same seed are independent
+void NoiseRngSeed(NOISE_RNG *Rng, unsigned long long Seed, unsigned int Stream)
+{
+	unsigned long long x = Seed ^ ((unsigned long long)Stream * 0xd1b54a32d192ed03ULL);
+
+	Rng->s[0] = SplitMix64(x);
+	Rng->s[1] = SplitMix64(x);
+	Rng->s[2] = SplitMix64(x);
+	Rng->s[3] = SplitMix64(x);
+}
+
+// uniform random value within [0,1) from the selected generator
+double GenerateUniform()
+{
+	if (NoiseGenerator == NOISE_GEN_RAND)
+		return (double)rand() / (RAND_MAX + 1.);
+	return UNIFORM_53(NoiseRngNext(GetThreadRng()));
+}
+
 complex_number GenerateNoise(double Sigma)
 {
-	int value1, value2;
 	double fvalue1, fvalue2;
 	complex_number noise;
 
-	value1 = RAND_MAX + 1 - rand();	// range from 1 to RAND_MAX
-	value2 = RAND_MAX + 1 - rand();	// range from 1 to RAND_MAX
-	fvalue1 = (double)value1 / (RAND_MAX + 1);
-	fvalue2 = (double)value2 / (RAND_MAX + 1);
+	if (NoiseGenerator != NOISE_GEN_RAND)
+		return GenerateNoise(GetThreadRng(), Sigma);
+
+	fvalue1 = (RAND_MAX + 1. - rand()) / (RAND_MAX + 1.);	// range from 1/(RAND_MAX+1) to 1, no int overflow if RAND_MAX is INT_MAX
+	fvalue2 = (RAND_MAX + 1. - rand()) / (RAND_MAX + 1.);
 	// scale noise power to be Sigma^2
 	noise.real = sqrt(-log(fvalue1) * 2) * cos(PI2 * fvalue2) * Sigma;
 	noise.imag = sqrt(-log(fvalue1) * 2) * sin(PI2 * fvalue2) * Sigma;
@@ -32,6 +216,25 @@ complex_number GenerateNoise(double Sigma)
 	return noise;
 }
 
+// noise from given stream, NOISE_GEN_RAND falls back to ziggurat because rand() has no separate stream
+complex_number GenerateNoise(NOISE_RNG *Rng, double Sigma)
+{
+	complex_number noise;
+
+	if (NoiseGenerator == NOISE_GEN_POLAR)
+	{
+		PolarNormal(Rng, noise.real, noise.imag);
+		noise.real *= Sigma;
+		noise.imag *= Sigma;
+	}
+	else
+	{
+		noise.real = ZigguratNormal(Rng) * Sigma;
+		noise.imag = ZigguratNormal(Rng) * Sigma;
+	}
+	return noise;
+}
+
 void CalculateCovar(int dim, int Interval, double CovarMatrix[])
 {
 	int i, j, k, end;
@@ -79,27 +282,61 @@ void CalculateCovar(int dim, int Interval, double CovarMatrix[])
 	}
 }
 
-void GenerateRelativeNoise(int dim, int max_index, double CovarMatrix[], double Sigma, complex_number Noise[])
+// get factor of covariance matrix, calculated on first request and shared by all channels and epochs
+// Interval is number of correlator spacings within which correlator outputs are correlated
+// return NULL if cache is full
+const double *GetCovarFactor(int dim, int Interval)
 {
-	int i, j, start;
-	complex_number noise[MAX_DIM];
-	double *p;
+	int i;
+	std::lock_guard<std::mutex> Lock(CovarCacheMutex);
+
+	for (i = 0; i < CovarCacheNumber; i ++)
+		if (CovarCache[i].dim == dim && CovarCache[i].Interval == Interval)
+			return CovarCache[i].Factor;
+	if (CovarCacheNumber == COVAR_CACHE_SIZE || dim > MAX_DIM || Interval > dim)
+		return NULL;
+	CovarCache[i].dim = dim;
+	CovarCache[i].Interval = Interval;
+	CalculateCovar(dim, Interval, CovarCache[i].Factor);
+	CovarCacheNumber ++;
+	return CovarCache[i].Factor;
+}
+
+void GenerateRelativeNoise(int dim, int max_index, const double CovarMatrix[], double Sigma, complex_number Noise[])
+{
+	GenerateRelativeNoiseBatch(dim, max_index, CovarMatrix, Sigma, 1, Noise, NULL);
+}
+
+// generate Number noise vectors of dim elements into Noise[Number*dim], from stream Rng or thread generator if NULL
+// all Gauss noise is generated first, then each vector is multiplied by factor in place
+// from last element backward, because element i only depends on elements up to i
+void GenerateRelativeNoiseBatch(int dim, int max_index, const double CovarMatrix[], double Sigma, int Number, complex_number Noise[], NOISE_RNG *Rng)
+{
+	int i, j, n, start;
+	complex_number *Vector;
+	const double *p;
+	double real, imag;
 
 	// first generate normalized complex Gauss noise
-	for (i = 0; i < dim; i ++)
-		noise[i] = GenerateNoise(Sigma);
+	for (i = 0; i < dim * Number; i ++)
+		Noise[i] = Rng ? GenerateNoise(Rng, Sigma) : GenerateNoise(Sigma);
 
 	// generate relative noise
-	for (i = 0; i < dim; i ++)
+	for (n = 0, Vector = Noise; n < Number; n ++, Vector += dim)
 	{
-		start = i - max_index + 1;
-		if (start < 0) start = 0;
-		Noise[i].real = Noise[i].imag = 0.0;
-		p = CovarMatrix + SUM_N(i) + start;
-		for (j = start; j <= i; j ++, p ++)
+		for (i = dim - 1; i >= 0; i --)
 		{
-			Noise[i].real += noise[j].real * (*p);
-			Noise[i].imag += noise[j].imag * (*p);
+			start = i - max_index + 1;
+			if (start < 0) start = 0;
+			real = imag = 0.0;
+			p = CovarMatrix + SUM_N(i) + start;
+			for (j = start; j <= i; j ++, p ++)
+			{
+				real += Vector[j].real * (*p);
+				imag += Vector[j].imag * (*p);
+			}
+			Vector[i].real = real;
+			Vector[i].imag = imag;
 		}
 	}
 }
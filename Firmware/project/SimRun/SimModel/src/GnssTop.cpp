@@ -9,11 +9,12 @@
 #include <stdio.h>
 #include <malloc.h>
 #include <string.h>
+#include <math.h>
 #include "RegAddress.h"
 #include "GnssTop.h"
 #include "SignalSim.h"
 
-double CTrackingChannel::CovarMatrix[4][SUM_N(COR_NUMBER)];
+const double *CTrackingChannel::CovarMatrix[4];
 
 CGnssTop::CGnssTop()
 {
@@ -22,16 +23,25 @@ CGnssTop::CGnssTop()
 	NavBitArray[1] = &GalBits;	// for Galileo E1
 	NavBitArray[2] = &BdsBits;	// for BDS B1C
 	NavBitArray[3] = &GpsBits;	// for GPS L1C
-	// calculate relative matrix for noise generation
-	CalculateCovar(COR_NUMBER, 2, CTrackingChannel::CovarMatrix[0]);
-	CalculateCovar(COR_NUMBER, 4, CTrackingChannel::CovarMatrix[1]);
-	CalculateCovar(COR_NUMBER, 8, CTrackingChannel::CovarMatrix[2]);
-	CalculateCovar(COR_NUMBER, 2, CTrackingChannel::CovarMatrix[3]);
+	// get relative matrix for noise generation, factorized once and shared by all channels
+	CTrackingChannel::CovarMatrix[0] = GetCovarFactor(COR_NUMBER, 2);
+	CTrackingChannel::CovarMatrix[1] = GetCovarFactor(COR_NUMBER, 4);
+	CTrackingChannel::CovarMatrix[2] = GetCovarFactor(COR_NUMBER, 8);
+	CTrackingChannel::CovarMatrix[3] = GetCovarFactor(COR_NUMBER, 2);
 	TickCount = 0;
+	memset(GpsHistory, 0, sizeof(GpsHistory));
+	memset(BdsHistory, 0, sizeof(BdsHistory));
+	memset(GalHistory, 0, sizeof(GalHistory));
+	memset(PrevVel, 0, sizeof(PrevVel));
+	memset(RefAcc, 0, sizeof(RefAcc));
+	SetSatParamInterval(SAT_PARAM_INTERVAL, 0);
+	ParamTime = 0;
 }
 
 CGnssTop::~CGnssTop()
 {
+	if (SatParamCheck)
+		printf("satellite parameter interval %dms: max range error %.3em, max speed error %.3em/s, %d over budget\n", SatParamInterval, MaxRangeError, MaxSpeedError, OverBudgetCount);
 }
 
 void CGnssTop::Reset(U32 ResetMask)
@@ -48,8 +58,6 @@ void CGnssTop::Clear(U32 ClearMask)
 void CGnssTop::SetRegValue(int Address, U32 Value)
 {
 	int AddressOffset = Address & 0xfff;
-	int ChannelNumber;
-	SATELLITE_PARAM *pSatParam;
 
 	switch (Address & 0xf000)
 	{
@@ -105,13 +113,7 @@ void CGnssTop::SetRegValue(int Address, U32 Value)
 	case ADDR_BASE_PERIPHERIAL:
 		break;
 	case ADDR_BASE_TE_BUFFER:
-		TrackingEngine.SetTEBuffer(AddressOffset >> 2, Value);
-		if (((AddressOffset >> 2) & 0x1f) == STATE_OFFSET_PRN_CONFIG)	// if set PRN_CONFIG, assume initial channel with new SVID
-		{
-			ChannelNumber = (Address >> 7) & 0x1f;
-			if ((pSatParam = TrackingEngine.FindSatParam(ChannelNumber, SatParamList, TotalSatNumber)) != NULL)
-				TrackingEngine.LogicChannel[ChannelNumber].Initial(CurTime, pSatParam, NavBitArray[TrackingEngine.LogicChannel[ChannelNumber].SystemSel]);
-		}
+		SetTEBuffer(AddressOffset >> 2, Value);
 		break;
 	case ADDR_BASE_AE_BUFFER:
 		AcqEngine.ChannelConfig[AddressOffset >> 5][(AddressOffset >> 2) & 0x7] = Value;
@@ -166,6 +168,80 @@ U32 CGnssTop::GetRegValue(int Address)
 	}
 }
 
+// write TE buffer, setting PRN_CONFIG is assumed to initial channel with new SVID
+void CGnssTop::SetTEBuffer(int Index, U32 Value)
+{
+	int ChannelNumber;
+	SATELLITE_PARAM *pSatParam;
+
+	TrackingEngine.SetTEBuffer(Index, Value);
+	if ((Index & 0x1f) == STATE_OFFSET_PRN_CONFIG)
+	{
+		ChannelNumber = (Index >> 5) & 0x1f;
+		if ((pSatParam = TrackingEngine.FindSatParam(ChannelNumber, SatParamList, TotalSatNumber)) != NULL)
+			TrackingEngine.LogicChannel[ChannelNumber].Initial(CurTime, pSatParam, NavBitArray[TrackingEngine.LogicChannel[ChannelNumber].SystemSel]);
+	}
+}
+
+// burst write of consecutive DWORDs, TE buffer and AE buffer are accessed without address decoding of each DWORD
+// register space or range crossing end of buffer is written one by one
+void CGnssTop::SetRegBurst(int Address, const U32 *Buffer, int WordNumber)
+{
+	int i, Index = (Address & 0xfff) >> 2;
+
+	switch (Address & 0xf000)
+	{
+	case ADDR_BASE_TE_BUFFER:
+		if (Index + WordNumber <= TE_BUFFER_SIZE / 4)
+		{
+			for (i = 0; i < WordNumber; i ++)
+				SetTEBuffer(Index + i, Buffer[i]);
+			return;
+		}
+		break;
+	case ADDR_BASE_AE_BUFFER:
+		if (Index + WordNumber <= MAX_CHANNEL * CHANNEL_CONFIG_LEN)
+		{
+			memcpy(&AcqEngine.ChannelConfig[0][0] + Index, Buffer, WordNumber * sizeof(U32));
+			return;
+		}
+		break;
+	default:
+		break;
+	}
+	for (i = 0; i < WordNumber; i ++)
+		SetRegValue(Address + i * 4, Buffer[i]);
+}
+
+// burst read of consecutive DWORDs, same address handling as SetRegBurst()
+void CGnssTop::GetRegBurst(int Address, U32 *Buffer, int WordNumber)
+{
+	int i, Index = (Address & 0xfff) >> 2;
+
+	switch (Address & 0xf000)
+	{
+	case ADDR_BASE_TE_BUFFER:
+		if (Index + WordNumber <= TE_BUFFER_SIZE / 4)
+		{
+			for (i = 0; i < WordNumber; i ++)
+				Buffer[i] = TrackingEngine.GetTEBuffer(Index + i);
+			return;
+		}
+		break;
+	case ADDR_BASE_AE_BUFFER:
+		if (Index + WordNumber <= MAX_CHANNEL * CHANNEL_CONFIG_LEN)
+		{
+			memcpy(Buffer, &AcqEngine.ChannelConfig[0][0] + Index, WordNumber * sizeof(U32));
+			return;
+		}
+		break;
+	default:
+		break;
+	}
+	for (i = 0; i < WordNumber; i ++)
+		Buffer[i] = GetRegValue(Address + i * 4);
+}
+
 void CGnssTop::SetInputFile(char *FileName)
 {
 	int i = 0;
@@ -218,6 +294,7 @@ void CGnssTop::SetInputFile(char *FileName)
 	GpsSatNumber = (OutputParam.FreqSelect[GpsSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, GpsSystem, GpsEph, 32, GpsEphVisible) : 0;
 	BdsSatNumber = (OutputParam.FreqSelect[BdsSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, BdsSystem, BdsEph, TOTAL_BDS_SAT, BdsEphVisible) : 0;
 	GalSatNumber = (OutputParam.FreqSelect[GalileoSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, GalileoSystem, GalEph, TOTAL_GAL_SAT, GalEphVisible) : 0;
+	ParamTime = 0;
 	UpdateSatParamList();
 }
 
@@ -267,6 +344,7 @@ int CGnssTop::StepToNextTime()
 		CurTime.Week ++;
 		CurTime.MilliSeconds -= 604800000;
 	}
+	ParamTime ++;
 	if ((CurTime.MilliSeconds % 60000) == 0)	// recalculate visible satellite at minute boundary
 	{
 		GpsSatNumber = (OutputParam.FreqSelect[GpsSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, GpsSystem, GpsEph, 32, GpsEphVisible) : 0;
@@ -283,31 +361,155 @@ void CGnssTop::UpdateSatParamList()
 	LLA_POSITION PosLLA = EcefToLla(CurPos);
 	PSIGNAL_POWER PowerList;
 	int ListCount = PowerControl.GetPowerControlList(1, PowerList);;
+	double Acc[3];
+
+	// nodes ahead assume constant receiver acceleration, restart from exact calculation if it changes
+	Acc[0] = (CurPos.vx - PrevVel[0]) * 1000;
+	Acc[1] = (CurPos.vy - PrevVel[1]) * 1000;
+	Acc[2] = (CurPos.vz - PrevVel[2]) * 1000;
+	if (ParamTime <= 1 || fabs(Acc[0] - RefAcc[0]) > SAT_PARAM_ACC_THRESHOLD || fabs(Acc[1] - RefAcc[1]) > SAT_PARAM_ACC_THRESHOLD || fabs(Acc[2] - RefAcc[2]) > SAT_PARAM_ACC_THRESHOLD)
+	{
+		ResetSatParamHistory();
+		memcpy(RefAcc, Acc, sizeof(RefAcc));
+	}
+	PrevVel[0] = CurPos.vx; PrevVel[1] = CurPos.vy; PrevVel[2] = CurPos.vz;
 
 	TotalSatNumber = 0;
 	for (i = 0; i < GpsSatNumber; i ++)
 	{
 		index = GpsEphVisible[i]->svid - 1;
-		GetSatelliteParam(CurPos, PosLLA, CurTime, GpsSystem, GpsEphVisible[i], NavData.GetGpsIono(), &GpsSatParam[index]);
+		UpdateSatParam(GpsSystem, GpsEphVisible[i], PosLLA, &GpsSatParam[index], &GpsHistory[index]);
 		GetSatelliteCN0(ListCount, PowerList, PowerControl.InitCN0, PowerControl.Adjust, &GpsSatParam[index]);
 		SatParamList[TotalSatNumber ++] = &GpsSatParam[index];
 	}
 	for (i = 0; i < BdsSatNumber; i ++)
 	{
 		index = BdsEphVisible[i]->svid - 1;
-		GetSatelliteParam(CurPos, PosLLA, CurTime, BdsSystem, BdsEphVisible[i], NavData.GetGpsIono(), &BdsSatParam[index]);
+		UpdateSatParam(BdsSystem, BdsEphVisible[i], PosLLA, &BdsSatParam[index], &BdsHistory[index]);
 		GetSatelliteCN0(ListCount, PowerList, PowerControl.InitCN0, PowerControl.Adjust, &BdsSatParam[index]);
 		SatParamList[TotalSatNumber ++] = &BdsSatParam[index];
 	}
 	for (i = 0; i < GalSatNumber; i ++)
 	{
 		index = GalEphVisible[i]->svid - 1;
-		GetSatelliteParam(CurPos, PosLLA, CurTime, GalileoSystem, GalEphVisible[i], NavData.GetGpsIono(), &GalSatParam[index]);
+		UpdateSatParam(GalileoSystem, GalEphVisible[i], PosLLA, &GalSatParam[index], &GalHistory[index]);
 		GetSatelliteCN0(ListCount, PowerList, PowerControl.InitCN0, PowerControl.Adjust, &GalSatParam[index]);
 		SatParamList[TotalSatNumber ++] = &GalSatParam[index];
 	}
 }
 
+// cubic interpolation through 4 nodes at -1, 0, 1 and 2 intervals
+#define INTERPOLATE(field) SatParamInterp(Coef, History->Node[0].field, History->Node[1].field, History->Node[2].field, History->Node[3].field)
+
+// calculate satellite parameters exactly at nodes every SatParamInterval ms and interpolate in between
+// nodes ahead of current time use receiver position predicted with RefAcc, see SatParamInterp.h for error budget
+// travel time, iono delay, group delay, relative speed and elevation are interpolated, other fields are kept from Node[1]
+// azimuth is also kept from Node[1], so it is never interpolated across 0/2PI wrap
+// in check mode, exact values are used if interpolation error exceeds SAT_PARAM_RANGE_BUDGET or SAT_PARAM_SPEED_BUDGET
+void CGnssTop::UpdateSatParam(GnssSystem system, PGPS_EPHEMERIS Eph, LLA_POSITION &PosLLA, SATELLITE_PARAM *SatParam, SatParamHistory *History)
+{
+	int i, Elapsed = (int)(ParamTime - History->NodeTime);
+	double RangeError, SpeedError, Coef[SAT_PARAM_NODES];
+	SATELLITE_PARAM ExactParam;
+
+	if (SatParamInterval <= 1)
+	{
+		GetSatelliteParam(CurPos, PosLLA, CurTime, system, Eph, NavData.GetGpsIono(), SatParam);
+		return;
+	}
+	if (History->NodeNumber < SAT_PARAM_NODES || Elapsed < 0 || Elapsed > SatParamInterval)	// restart with all nodes around current time
+	{
+		for (i = 0; i < SAT_PARAM_NODES; i ++)
+			PredictSatParam(system, Eph, (i - 1) * SatParamInterval, &History->Node[i]);
+		History->NodeNumber = SAT_PARAM_NODES;
+		History->NodeTime = ParamTime;
+		Elapsed = 0;
+	}
+	else if (Elapsed == SatParamInterval)	// move to next interval, only the farthest node is new
+	{
+		for (i = 0; i < SAT_PARAM_NODES - 1; i ++)
+			History->Node[i] = History->Node[i+1];
+		PredictSatParam(system, Eph, (SAT_PARAM_NODES - 2) * SatParamInterval, &History->Node[SAT_PARAM_NODES-1]);
+		History->NodeTime = ParamTime;
+		Elapsed = 0;
+	}
+
+	SatParamInterpCoef((double)Elapsed / SatParamInterval, Coef);
+	*SatParam = History->Node[1];
+	SatParam->TravelTime = INTERPOLATE(TravelTime);
+	SatParam->IonoDelay = INTERPOLATE(IonoDelay);
+	for (i = 0; i < (int)(sizeof(SatParam->GroupDelay) / sizeof(SatParam->GroupDelay[0])); i ++)
+		SatParam->GroupDelay[i] = INTERPOLATE(GroupDelay[i]);
+	SatParam->RelativeSpeed = INTERPOLATE(RelativeSpeed);
+	SatParam->Elevation = INTERPOLATE(Elevation);
+
+	if (SatParamCheck)
+	{
+		GetSatelliteParam(CurPos, PosLLA, CurTime, system, Eph, NavData.GetGpsIono(), &ExactParam);
+		RangeError = fabs(GetTravelTime(SatParam, 0) - GetTravelTime(&ExactParam, 0)) * 299792458.;
+		SpeedError = fabs(SatParam->RelativeSpeed - ExactParam.RelativeSpeed);
+		MaxRangeError = (RangeError > MaxRangeError) ? RangeError : MaxRangeError;
+		MaxSpeedError = (SpeedError > MaxSpeedError) ? SpeedError : MaxSpeedError;
+		if (RangeError > SAT_PARAM_RANGE_BUDGET || SpeedError > SAT_PARAM_SPEED_BUDGET)
+		{
+			*SatParam = ExactParam;
+			OverBudgetCount ++;
+		}
+	}
+}
+
+// exact satellite parameters at OffsetMs from current time, receiver moves with current velocity and RefAcc
+void CGnssTop::PredictSatParam(GnssSystem system, PGPS_EPHEMERIS Eph, int OffsetMs, SATELLITE_PARAM *SatParam)
+{
+	KINEMATIC_INFO Position = CurPos;
+	GNSS_TIME Time = CurTime;
+	LLA_POSITION PosLLA;
+	double dt = OffsetMs / 1000.;
+
+	Position.x += (CurPos.vx + 0.5 * RefAcc[0] * dt) * dt;
+	Position.y += (CurPos.vy + 0.5 * RefAcc[1] * dt) * dt;
+	Position.z += (CurPos.vz + 0.5 * RefAcc[2] * dt) * dt;
+	Position.vx += RefAcc[0] * dt;
+	Position.vy += RefAcc[1] * dt;
+	Position.vz += RefAcc[2] * dt;
+	Time.MilliSeconds += OffsetMs;
+	if (Time.MilliSeconds < 0)
+	{
+		Time.Week --;
+		Time.MilliSeconds += 604800000;
+	}
+	else if (Time.MilliSeconds >= 604800000)
+	{
+		Time.Week ++;
+		Time.MilliSeconds -= 604800000;
+	}
+	PosLLA = EcefToLla(Position);
+	GetSatelliteParam(Position, PosLLA, Time, system, Eph, NavData.GetGpsIono(), SatParam);
+}
+
+// set interval in ms of exact satellite parameter calculation, 1 to calculate every millisecond
+// if Check is not zero, exact values are also calculated to record maximum interpolation error and enforce error budget
+void CGnssTop::SetSatParamInterval(int Interval, int Check)
+{
+	SatParamInterval = (Interval > 1) ? Interval : 1;
+	SatParamCheck = Check;
+	MaxRangeError = MaxSpeedError = 0.0;
+	OverBudgetCount = 0;
+	ResetSatParamHistory();
+}
+
+void CGnssTop::ResetSatParamHistory()
+{
+	int i;
+
+	for (i = 0; i < TOTAL_GPS_SAT; i ++)
+		GpsHistory[i].NodeNumber = 0;
+	for (i = 0; i < TOTAL_BDS_SAT; i ++)
+		BdsHistory[i].NodeNumber = 0;
+	for (i = 0; i < TOTAL_GAL_SAT; i ++)
+		GalHistory[i].NodeNumber = 0;
+}
+
 #define AE_CLK_FREQ_MHz 100		// clock frequency for AE module
 #define BLOCK_LENGTH_US 1000	// length in us for each data block
 #define CLK_NUMBER_IN_BLOCK (AE_CLK_FREQ_MHz * BLOCK_LENGTH_US)
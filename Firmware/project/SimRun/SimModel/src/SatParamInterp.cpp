@@ -0,0 +1,26 @@
+//----------------------------------------------------------------------
+// SatParamInterp.cpp:
+//   Implementation of cubic interpolation of satellite parameters between exact nodes
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include "SatParamInterp.h"
+
+// Lagrange coefficients of nodes at -1, 0, 1 and 2 for position x within [0, 1)
+// error is about 4th derivative * interval^4 / 24 * 0.5625, far below rounding of range for intervals up to 200ms
+void SatParamInterpCoef(double x, double Coef[SAT_PARAM_NODES])
+{
+	double xm1 = x - 1, xm2 = x - 2, xp1 = x + 1;
+
+	Coef[0] = -x * xm1 * xm2 / 6;
+	Coef[1] = xp1 * xm1 * xm2 / 2;
+	Coef[2] = -xp1 * x * xm2 / 2;
+	Coef[3] = xp1 * x * xm1 / 6;
+}
+
+double SatParamInterp(const double Coef[SAT_PARAM_NODES], double Value0, double Value1, double Value2, double Value3)
+{
+	return Coef[0] * Value0 + Coef[1] * Value1 + Coef[2] * Value2 + Coef[3] * Value3;
+}
@@ -237,7 +237,7 @@ int CTrackingChannel::FindSvid(unsigned int ConfigArray[], int ArraySize, U32 Pr
 	return 0;	// not found
 }
 
-void CTrackingChannel::GetCorrelationResult(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, int DumpDataI[], int DumpDataQ[], int CorIndex[], int CorPos[], int NHCode[], int DataLength)
+void CTrackingChannel::GetCorrelationResult(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, int DumpDataI[], int DumpDataQ[], int CorIndex[], int CorPos[], int NHCode[], int DataLength, complex_number RelativeNoise[])
 {
 	int i;
 	double Alpha;
@@ -261,11 +261,14 @@ void CTrackingChannel::GetCorrelationResult(GNSS_TIME CurTime, SATELLITE_PARAM *
 	FrameLength = (SystemSel == SignalL1CA) ? 6000 : ((SystemSel == SignalE1) ? 2000 : 18000);
 	BitLength = (SystemSel == SignalL1CA) ? 20 : ((SystemSel == SignalE1) ? 4 : 10);
 
-	// first generate relative noise
+	// first get relative noise, RelativeNoise has 8 Gauss Noise for each round of correlator 0~7
 	while (CorCount < DataLength)
 	{
-		if ((CorIndex[CorCount] >> 2) == 0)	// new round of correlator 0~7, generate 8 Gauss Noise
-			GenerateRelativeNoise(8, (2 << NarrowFactor), CovarMatrix[NarrowFactor], NOISE_AMP, GaussNoise);
+		if ((CorIndex[CorCount] >> 2) == 0)	// new round of correlator 0~7, take next 8 Gauss Noise
+		{
+			memcpy(GaussNoise, RelativeNoise, sizeof(GaussNoise));
+			RelativeNoise += COR_NUMBER;
+		}
 		CorResult[CorCount ++] = GaussNoise[CorIndex[CorCount] >> 2];
 	}
 //	memset(CorResult, 0, sizeof(CorResult));
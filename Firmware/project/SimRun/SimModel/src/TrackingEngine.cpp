@@ -20,6 +20,7 @@
 
 CTrackingEngine::CTrackingEngine()
 {
+	WorkerPool = NULL;
 	Reset();
 	memset(TEBuffer, 0, TE_BUFFER_SIZE);
 	memset(LogicChannel, 0, sizeof(LogicChannel));
@@ -27,6 +28,7 @@ CTrackingEngine::CTrackingEngine()
 
 CTrackingEngine::~CTrackingEngine()
 {
+	SetParallelMode(1);
 }
 
 void CTrackingEngine::Reset()
@@ -142,12 +144,9 @@ U32 CTrackingEngine::GetTEBuffer(unsigned int Address)
 int CTrackingEngine::ProcessData(int BlockSize, GNSS_TIME CurTime, PSATELLITE_PARAM SatParam[], int SatNumber)
 {
 	unsigned int EnableMask;
-	int i, j;
+	int i, j, NarrowFactor;
 	SATELLITE_PARAM *pSatParam;
-	int DumpDataI[16], DumpDataQ[16];
-	int CorIndex[16], CorPos[16];
-	int NHCode[16];
-	int DataLength;
+	int RoundNumber, TotalRound;
 	unsigned int CohData;
 	S16 CohDataI, CohDataQ;
 	int DataValue;
@@ -158,6 +157,57 @@ int CTrackingEngine::ProcessData(int BlockSize, GNSS_TIME CurTime, PSATELLITE_PA
 	CohDataReady = 0;
 	OverwriteProtectChannel = 0;
 
+	// recalculate corresponding counter of all channels and count rounds of correlator 0~7 output
+	ParallelChannelNumber = 0;
+	for (i = 0, EnableMask = 1; i < 32; i ++, EnableMask <<= 1)
+	{
+		if ((ChannelEnable & EnableMask) == 0)
+			continue;
+		if (LogicChannel[i].CalculateCounter(BlockSize, CorIndex[i], CorPos[i], NHCode[i], DataLength[i]))
+			CohDataReady |= EnableMask;
+		NoiseRound[i] = 0;
+		for (j = 0; j < DataLength[i]; j ++)
+			if ((CorIndex[i][j] >> 2) == 0)
+				NoiseRound[i] ++;
+		ParallelChannelIndex[ParallelChannelNumber ++] = i;
+	}
+
+	if (WorkerPool)
+	{
+		// each channel generates noise from its own stream, so result does not depend on thread number
+		TaskTime = CurTime;
+		TaskSatParam = SatParam;
+		TaskSatNumber = SatNumber;
+		WorkerPool->RunTasks(ParallelChannelNumber, ChannelTask, this);
+	}
+	else
+	{
+		// generate relative noise of all channels in one batch for each narrow factor
+		for (NarrowFactor = 0, TotalRound = 0; NarrowFactor < 4; NarrowFactor ++)
+		{
+			RoundNumber = 0;
+			for (i = 0, EnableMask = 1; i < 32; i ++, EnableMask <<= 1)
+			{
+				if ((ChannelEnable & EnableMask) == 0 || LogicChannel[i].NarrowFactor != NarrowFactor)
+					continue;
+				NoiseOffset[i] = (TotalRound + RoundNumber) * COR_NUMBER;
+				RoundNumber += NoiseRound[i];
+			}
+			if (RoundNumber)
+				GenerateRelativeNoiseBatch(COR_NUMBER, (2 << NarrowFactor), CTrackingChannel::CovarMatrix[NarrowFactor], NOISE_AMP, RoundNumber, RelativeNoise + TotalRound * COR_NUMBER, NULL);
+			TotalRound += RoundNumber;
+		}
+		// calculate 1ms correlation result
+		for (j = 0; j < ParallelChannelNumber; j ++)
+		{
+			i = ParallelChannelIndex[j];
+			// find whether there is visible satellite match current channel
+			pSatParam = FindSatParam(i, SatParam, SatNumber);
+			LogicChannel[i].GetCorrelationResult(CurTime, pSatParam, DumpDataI[i], DumpDataQ[i], CorIndex[i], CorPos[i], NHCode[i], DataLength[i], RelativeNoise + NoiseOffset[i]);
+		}
+	}
+
+	// coherent sum and data decode in channel order
 	for (i = 0, EnableMask = 1; i < 32; i ++, EnableMask <<= 1)
 	{
 		if ((ChannelEnable & EnableMask) == 0)
@@ -165,46 +215,37 @@ int CTrackingEngine::ProcessData(int BlockSize, GNSS_TIME CurTime, PSATELLITE_PA
 		if (ShiftBits < 0)
 			ShiftBits = LogicChannel[i].PreShiftBits;
 
-		// find whether there is visible satellite match current channel
-		pSatParam = FindSatParam(i, SatParam, SatNumber);
-
-		// recalculate corresponding counter of channel
-		if (LogicChannel[i].CalculateCounter(BlockSize, CorIndex, CorPos, NHCode, DataLength))
-			CohDataReady |= EnableMask;
-		// calculate 1ms correlation result
-		LogicChannel[i].GetCorrelationResult(CurTime, pSatParam, DumpDataI, DumpDataQ, CorIndex, CorPos, NHCode, DataLength);
-		// do coherent sum
-		for (j = 0; j < DataLength; j ++)
+		for (j = 0; j < DataLength[i]; j ++)
 		{
 			// if overwrite protect bit is set, set corresponding flag bit and set address and value. do NOT accumulate
-			if (CorIndex[j] & 2)
+			if (CorIndex[i][j] & 2)
 			{
 				OverwriteProtectChannel |= EnableMask;
-				OverwriteProtectAddr = COH_OFFSET(i, CorIndex[j]) << 2;
-				OverwriteProtectValue = ((DumpDataI[j] & 0xffff) << 16) | (DumpDataQ[j] & 0xffff);
+				OverwriteProtectAddr = COH_OFFSET(i, CorIndex[i][j]) << 2;
+				OverwriteProtectValue = ((DumpDataI[i][j] & 0xffff) << 16) | (DumpDataQ[i][j] & 0xffff);
 				continue;
 			}
 
 			// if this is first epoch of coherent data accumulation, clear stored value
-			if (CorIndex[j] & 1)
+			if (CorIndex[i][j] & 1)
 				CohData = 0;
 			else
-				CohData = TEBuffer[COH_OFFSET(i, CorIndex[j])];
+				CohData = TEBuffer[COH_OFFSET(i, CorIndex[i][j])];
 			CohDataI = (S16)(CohData >> 16);
 			CohDataQ = (S16)(CohData & 0xffff);
-			CohDataI += (S16)DumpDataI[j];
-			CohDataQ += (S16)DumpDataQ[j];
+			CohDataI += (S16)DumpDataI[i][j];
+			CohDataQ += (S16)DumpDataQ[i][j];
 			CohData = ((unsigned int)CohDataI << 16) | ((unsigned int)CohDataQ & 0xffff);
-			TEBuffer[COH_OFFSET(i, CorIndex[j])] = CohData;
+			TEBuffer[COH_OFFSET(i, CorIndex[i][j])] = CohData;
 			// do data decode
-			if (LogicChannel[i].BitLength && LogicChannel[i].EnableSecondPrn && ((CorIndex[j] >> 2) == 0) && LogicChannel[i].BitCount == 0)
+			if (LogicChannel[i].BitLength && LogicChannel[i].EnableSecondPrn && ((CorIndex[i][j] >> 2) == 0) && LogicChannel[i].BitCount == 0)
 			{
 				DataValue = LogicChannel[i].DataInQBranch ? CohDataQ : CohDataI;
 				LogicChannel[i].DecodeDataAcc(DataValue);
 			}
 		}
-		if (DataLength)
-			LogicChannel[i].CurrentCor = ((CorIndex[DataLength-1] >> 2) + 1) & 0x7;	// CurrentCor is next to the last output correlator
+		if (DataLength[i])
+			LogicChannel[i].CurrentCor = ((CorIndex[i][DataLength[i]-1] >> 2) + 1) & 0x7;	// CurrentCor is next to the last output correlator
 	}
 
 	// update noise floor
@@ -216,6 +257,42 @@ int CTrackingEngine::ProcessData(int BlockSize, GNSS_TIME CurTime, PSATELLITE_PA
 	return (CohDataReady != 0);
 }
 
+// set number of threads to calculate channel correlation results, ThreadNumber includes the calling thread
+// 1 for sequential processing, each channel uses its own noise stream of current seed in parallel mode
+// so call after SetNoiseGenerator()
+void CTrackingEngine::SetParallelMode(int ThreadNumber)
+{
+	int i;
+
+	if (WorkerPool)
+	{
+		delete WorkerPool;
+		WorkerPool = NULL;
+	}
+	if (ThreadNumber <= 1)
+		return;
+
+	WorkerPool = new CWorkerPool(ThreadNumber);
+	for (i = 0; i < LOGICAL_CHANNEL_NUMBER; i ++)
+		NoiseRngSeed(&ChannelRng[i], GetNoiseSeed(), NOISE_STREAM_CHANNEL + i);
+}
+
+// noise generation and correlation of one channel, only state of this channel is modified
+// satellite parameters and navigation bits are shared and only read
+void CTrackingEngine::ChannelTask(void *Param, int TaskIndex, int WorkerIndex)
+{
+	CTrackingEngine *Engine = (CTrackingEngine *)Param;
+	int i = Engine->ParallelChannelIndex[TaskIndex];
+	int NarrowFactor = Engine->LogicChannel[i].NarrowFactor;
+	complex_number *Noise = Engine->RelativeNoise + i * MAX_NOISE_ROUND * COR_NUMBER;
+	SATELLITE_PARAM *pSatParam;
+
+	if (Engine->NoiseRound[i])
+		GenerateRelativeNoiseBatch(COR_NUMBER, (2 << NarrowFactor), CTrackingChannel::CovarMatrix[NarrowFactor], NOISE_AMP, Engine->NoiseRound[i], Noise, &(Engine->ChannelRng[i]));
+	pSatParam = Engine->FindSatParam(i, Engine->TaskSatParam, Engine->TaskSatNumber);
+	Engine->LogicChannel[i].GetCorrelationResult(Engine->TaskTime, pSatParam, Engine->DumpDataI[i], Engine->DumpDataQ[i], Engine->CorIndex[i], Engine->CorPos[i], Engine->NHCode[i], Engine->DataLength[i], Noise);
+}
+
 SATELLITE_PARAM* CTrackingEngine::FindSatParam(int ChannelId, PSATELLITE_PARAM SatParam[], int SatNumber)
 {
 	int i;
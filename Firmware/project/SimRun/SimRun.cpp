@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <string.h>
 
@@ -9,6 +10,7 @@ extern "C" {
 
 #include "ConstVal.h"
 #include "GnssTop.h"
+#include "GaussNoise.h"
 
 void DebugOutput(void *DebugParam, int DebugValue);
 
@@ -22,6 +24,15 @@ int main(int argc, char *argv[])
 		strcpy(ScenarioFile, argv[1]);
 	else
 		strcpy(ScenarioFile, "test_obs2.json");
+	// optional noise seed and generator (rand, zig or polar) for Monte Carlo runs
+	if (argc > 2)
+		SetNoiseGenerator((argc <= 3 || strcmp(argv[3], "zig") == 0) ? NOISE_GEN_ZIGGURAT : (strcmp(argv[3], "polar") == 0) ? NOISE_GEN_POLAR : NOISE_GEN_RAND, strtoull(argv[2], NULL, 0));
+	// optional number of threads to calculate channel correlation results
+	if (argc > 4)
+		SetModelThreads(atoi(argv[4]));
+	// optional interval in ms of exact satellite parameter calculation and check mode to report interpolation error
+	if (argc > 5)
+		SetSatParamInterval(atoi(argv[5]), (argc > 6) ? atoi(argv[6]) : 0);
 
 	DebugFile = fopen("TrackState.txt", "w");
 	SetInputFile(ScenarioFile);
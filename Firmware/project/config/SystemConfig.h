@@ -0,0 +1,44 @@
+//----------------------------------------------------------------------
+// SystemConfig.h:
+//   Sample system configuration of PC projects (ModelRun, PostProc)
+//   copy to project directory and set GRETA_SYSTEM_CONFIG_DIR to use another configuration
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __SYSTEM_CONFIG_H__
+#define __SYSTEM_CONFIG_H__
+
+// stream ports, each port writes to a file on PC
+#define MAX_STREAM_ID				4
+#define STREAM_FILE_PREFIX			"Stream%d.txt"	// file name format with port number
+#define USE_STDOUT_AS_STREAM0		0
+#define DEFAULT_DEBUG_OUTPUT_PORT	-1				// -1 for stdout
+
+// baseband measurement and data output
+#define DEFAULT_BB_MEAS_PORT		1
+#define DEFAULT_BB_DATA_PORT		1
+#define DEFAULT_MEAS_INTERVAL		100	// measurement interval in ms, must be multiple of 2
+
+// debug output levels, message of a type is output if its level is not higher than OUTPUT_LEVEL_xxx given
+#define OUTPUT_LEVEL_OFF		0
+#define OUTPUT_LEVEL_ERROR		1
+#define OUTPUT_LEVEL_WARNING	2
+#define OUTPUT_LEVEL_INFO		3
+#define OUTPUT_LEVEL_DEBUG		4
+#define OUTPUT_LEVEL_NONE		5	// no output for any level
+
+#define OUTPUT_MASK_ACQUISITION		OUTPUT_LEVEL_NONE
+#define OUTPUT_MASK_COH_PROC		OUTPUT_LEVEL_NONE
+#define OUTPUT_MASK_TRACKING_LOOP	OUTPUT_LEVEL_NONE
+#define OUTPUT_MASK_TRACKING_SWITCH	OUTPUT_LEVEL_NONE
+#define OUTPUT_MASK_DATA_DECODE		OUTPUT_LEVEL_NONE
+#define OUTPUT_MASK_MEASUREMENT		OUTPUT_LEVEL_NONE
+#define OUTPUT_MASK_PVT				OUTPUT_LEVEL_INFO
+#define OUTPUT_MASK_TASK_QUEUE		OUTPUT_LEVEL_ERROR
+
+// PVT
+#define ENABLE_KALMAN_FILTER	1
+
+#endif //__SYSTEM_CONFIG_H__
@@ -0,0 +1,96 @@
+//----------------------------------------------------------------------
+// BenchConfig.cpp:
+//   Channel configurations for all_signal.bin shared by benchmark and regression
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <string.h>
+#include "CommonOps.h"
+#include "InitSet.h"
+#include "BenchConfig.h"
+
+BenchSignal BenchSignals[] = {
+	{ 0, 1,     0, 200.2, 0,  1, 0, 0 },
+	{ 1, 1,     0, 200.2, 1,  4, 1, 1 },
+	{ 2, 3,   800, 300.3, 0, 10, 1, 1 },
+	{ 3, 5, -1300, 400.4, 2, 10, 1, 0 },
+	{ 0, 3,   800, 300.3, 1,  1, 0, 0 },
+	{ 1, 3,   800, 300.3, 0,  4, 1, 1 },
+	{ 2, 5, -1300, 400.4, 1, 10, 1, 1 },
+	{ 3, 1,     0, 200.2, 0, 10, 1, 0 },
+	{ 0, 5, -1300, 400.4, 2,  1, 0, 0 },
+	{ 1, 5, -1300, 400.4, 1,  4, 1, 1 },
+	{ 2, 1,     0, 200.2, 2, 10, 1, 1 },
+	{ 3, 3,   800, 300.3, 1, 10, 1, 0 },
+};
+const int BenchSignalNumber = (int)(sizeof(BenchSignals) / sizeof(BenchSignals[0]));
+
+// fill channel state words of a signal in the same way firmware initializes TEBuffer
+// MemCodeBuffer is needed to get the first PRN state word of memory code (E1)
+void InitChannelState(unsigned int State[32], BenchSignal &Signal, unsigned int *MemCodeBuffer)
+{
+	int CodeLength = (Signal.Type == 0) ? 1023 : (Signal.Type == 1) ? 4092 : 10230;
+	double StartPhase = CodeLength - Signal.CodeStart;
+	int Phase = (int)StartPhase, Phase16 = (int)(StartPhase * 16);
+	long long CarrierFreq = IF_FREQ + Signal.Doppler + ((Signal.Type == 0) ? 0 : 1023000);
+
+	memset(State, 0, 32 * sizeof(unsigned int));
+	State[0] = (unsigned int)((CarrierFreq << 32) / SAMPLE_RATE);
+	State[1] = (unsigned int)((((RF_FREQ + (long long)Signal.Doppler) << 32) / 770) / SAMPLE_RATE);
+	State[2] = (Signal.CoherentNumber << 21) | (Signal.CoherentNumber << 16) | (Signal.NarrowFactor << 10) | (Signal.EnableBOC << 7) | (Signal.EnableSecondPrn << 6);
+	State[4] = 1023;
+	switch (Signal.Type)
+	{
+	case 0:
+		State[5] = CAPrnInit[Signal.Svid-1];
+		State[6] = CAPrnInit[Signal.Svid-1] & 0x0fffffff;
+		State[7] = (Phase % 1023) << 14;
+		break;
+	case 1:
+		State[5] = 0xc0000004 + ((49 + Signal.Svid) << 6);
+		State[14] = 0xc0000004 + ((Signal.Svid - 1) << 6);
+		State[7] = ((Phase / 1023) << 10) + Phase % 1023;
+		State[6] = MemCodeBuffer[((State[5] >> 4) & 0xfff) * 32 + ((State[7] & 0x3fff) >> 5)];
+		State[15] = MemCodeBuffer[((State[14] >> 4) & 0xfff) * 32 + ((State[7] & 0x3fff) >> 5)];
+		break;
+	case 2:
+		State[5] = B1CPilotInit[Signal.Svid-1];
+		State[14] = B1CDataInit[Signal.Svid-1];
+		State[7] = Phase;
+		break;
+	default:
+		State[5] = L1CPilotInit[Signal.Svid-1];
+		State[14] = L1CDataInit[Signal.Svid-1];
+		State[7] = Phase;
+		break;
+	}
+	State[10] = (unsigned int)Phase16 << 29;
+	State[11] = (Phase % 1023) << 16;
+	State[12] = ((Phase16 >> 3) & 1) << 8;
+}
+
+// fill AE channel config of a signal, stride interval is 500Hz, frequency center at Doppler of the signal
+// rate adaptor down converts L1 center frequency to zero, so BOC signals are searched at center frequency
+void InitAcqConfig(unsigned int Config[CHANNEL_CONFIG_LEN], BenchSignal &Signal, int StrideNumber, int CoherentNumber, int NonCoherentNumber)
+{
+	int CodeSpan = (Signal.Type == 0) ? 3 : (Signal.Type == 1) ? 12 : 30;
+
+	memset(Config, 0, CHANNEL_CONFIG_LEN * sizeof(unsigned int));
+	Config[0] = (NonCoherentNumber << 16) | (CoherentNumber << 8) | StrideNumber;
+	Config[1] = (Signal.Type << 30) | (Signal.Svid << 24) | ((unsigned int)(((long long)Signal.Doppler << 20) / AE_SAMPLE_RATE) & 0xfffff);
+	Config[2] = (((500 << 10) / 1000) << 20) | CodeSpan;
+	Config[3] = (unsigned int)((500LL << 32) / AE_SAMPLE_RATE);
+}
+
+// rate adaptor settings for AE, down convert IF to zero and resample to 2.046MHz
+unsigned int AcqCarrierFreq()
+{
+	return (unsigned int)(((long long)IF_FREQ << 32) / SAMPLE_RATE);
+}
+
+unsigned int AcqCodeRatio()
+{
+	return (unsigned int)((double)AE_SAMPLE_RATE / SAMPLE_RATE * 16777216. + 0.5);
+}
@@ -0,0 +1,47 @@
+//----------------------------------------------------------------------
+// BenchConfig.h:
+//   Declaration of channel configurations for all_signal.bin shared by benchmark and regression
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __BENCH_CONFIG_H__
+#define __BENCH_CONFIG_H__
+
+#include "CommonOps.h"
+#include "AcqEngine.h"
+
+#if !defined BENCH_IF_FILE
+#define BENCH_IF_FILE "../if_data/all_signal.bin"
+#endif
+
+// attributes of all_signal.bin, see if_data/description.txt
+#define SAMPLE_RATE 4113000
+#define IF_FREQ 141000
+#define RF_FREQ 1575420000
+#define BLOCK_SIZE 4113				// samples in 1ms
+#define AE_SAMPLE_RATE 2046000
+
+// correlator configuration of one signal in all_signal.bin
+struct BenchSignal
+{
+	int Type;			// 0 for L1CA, 1 for E1, 2 for B1C, 3 for L1C
+	int Svid;
+	int Doppler;
+	double CodeStart;	// code chips from file start to code cycle start
+	int NarrowFactor;
+	int CoherentNumber;
+	int EnableSecondPrn;
+	int EnableBOC;
+};
+
+extern BenchSignal BenchSignals[];
+extern const int BenchSignalNumber;
+
+void InitChannelState(unsigned int State[32], BenchSignal &Signal, unsigned int *MemCodeBuffer);
+void InitAcqConfig(unsigned int Config[CHANNEL_CONFIG_LEN], BenchSignal &Signal, int StrideNumber, int CoherentNumber, int NonCoherentNumber);
+unsigned int AcqCarrierFreq();
+unsigned int AcqCodeRatio();
+
+#endif //__BENCH_CONFIG_H__
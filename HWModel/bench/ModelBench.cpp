@@ -0,0 +1,311 @@
+//----------------------------------------------------------------------
+// ModelBench.cpp:
+//   Micro benchmark of hardware model hot paths
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <chrono>
+#include "CommonOps.h"
+#include "RegAddress.h"
+#include "GnssTop.h"
+#include "BenchConfig.h"
+
+#define MAX_SAMPLE_NUMBER (SAMPLE_RATE / 5)
+
+// one fixture result, Unit counts the items of each timed run
+struct BenchResult
+{
+	const char *Name;
+	const char *Unit;
+	double UnitNumber;
+	double SampleNumber;	// IF samples consumed by each timed run, 0 if not applicable
+	double BestTime;		// second
+};
+
+typedef void (*BenchFunction)(void *Param);
+
+static CGnssTop Top;
+static complex_int *IfSamples;
+static int IfSampleNumber;
+static int RepeatNumber = 3;
+static const char *Filter = NULL;
+
+static double Now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// run Function RepeatNumber times after one warm up run, print the best time
+static void RunBench(BenchResult &Result, BenchFunction Function, void *Param)
+{
+	int i;
+	double Start, Time;
+
+	if (Filter && strstr(Result.Name, Filter) == NULL)
+		return;
+	Function(Param);
+	Result.BestTime = 1e30;
+	for (i = 0; i < RepeatNumber; i ++)
+	{
+		Start = Now();
+		Function(Param);
+		Time = Now() - Start;
+		if (Time < Result.BestTime)
+			Result.BestTime = Time;
+	}
+
+	printf("%-28s %10.3f %12.3f %9s %12.2f", Result.Name, Result.BestTime * 1e3, Result.BestTime * 1e9 / Result.UnitNumber, Result.Unit, Result.UnitNumber / Result.BestTime * 1e-6);
+	if (Result.SampleNumber > 0)
+		printf(" %10.2f %8.2f", Result.SampleNumber / Result.BestTime * 1e-6, Result.SampleNumber / Result.BestTime / SAMPLE_RATE);
+	printf("\n");
+}
+
+//*************** IF file read ****************
+static void BenchReadFile(void *)
+{
+	CIfFile &IfFile = Top.IfFile;
+	complex_int *Data = Top.FileData;
+
+	IfFile.Seek(0);
+	while (IfFile.ReadFile(BLOCK_SIZE, Data))
+		;
+}
+
+static void BenchReadFilePrefetch(void *)
+{
+	CIfFile &IfFile = Top.IfFile;
+	complex_int *Data = Top.FileData;
+
+	IfFile.Seek(0);
+	IfFile.StartPrefetch(BLOCK_SIZE, 8);
+	while (IfFile.ReadFile(BLOCK_SIZE, Data))
+		;
+	IfFile.StopPrefetch();
+}
+
+//*************** rate adaptor ****************
+static void BenchRateAdaptor(void *Param)
+{
+	CRateAdaptor *RateAdaptor = (CRateAdaptor *)Param;
+	int i;
+
+	RateAdaptor->Reset();
+	for (i = 0; i + BLOCK_SIZE <= IfSampleNumber; i += BLOCK_SIZE)
+		RateAdaptor->DoRateAdaptor(IfSamples + i, BLOCK_SIZE, Top.SampleQuant);
+}
+
+//*************** TE FIFO ****************
+// each block written once and read by 4 rounds of physical channels as 16 channel tracking does
+static void BenchTeFifo(void *Param)
+{
+	CTeFifoMem *TeFifo = (CTeFifoMem *)Param;
+	complex_int *Data = Top.TrackingEngine.FifoData;
+	int i, j, ReadNumber;
+
+	TeFifo->Clear();
+	for (i = 0; i + BLOCK_SIZE <= IfSampleNumber; i += BLOCK_SIZE)
+	{
+		TeFifo->WriteBlock(BLOCK_SIZE, IfSamples + i);
+		for (j = 0; j < 4; j ++)
+		{
+			TeFifo->ReadData(ReadNumber, Data);
+			TeFifo->RewindPointer();
+		}
+		TeFifo->SkipBlock();
+	}
+}
+
+//*************** correlator ****************
+struct CorrelatorBench
+{
+	CCorrelator *Correlator;
+	int ChannelNumber;
+	unsigned int *ChannelState;		// 32 words for each channel, same layout as TEBuffer
+	unsigned int *InitState;
+};
+
+// all channels correlated by one correlator block by block, as tracking engine does with one physical channel
+static void BenchCorrelation(void *Param)
+{
+	CorrelatorBench *Bench = (CorrelatorBench *)Param;
+	CCorrelator *Correlator = Bench->Correlator;
+	S16 DumpDataI[16], DumpDataQ[16];
+	int CorIndex[16], DumpDataLength;
+	int i, ch;
+
+	memcpy(Bench->ChannelState, Bench->InitState, Bench->ChannelNumber * 32 * sizeof(unsigned int));
+	for (i = 0; i + BLOCK_SIZE <= IfSampleNumber; i += BLOCK_SIZE)
+	{
+		for (ch = 0; ch < Bench->ChannelNumber; ch ++)
+		{
+			Correlator->FillState(Bench->ChannelState + ch * 32);
+			Correlator->Correlation(BLOCK_SIZE, IfSamples + i, DumpDataI, DumpDataQ, CorIndex, DumpDataLength);
+			Correlator->DecodeDataAcc(0);
+			Correlator->DumpState(Bench->ChannelState + ch * 32);
+		}
+	}
+}
+
+//*************** acquisition engine ****************
+struct AcqBench
+{
+	CAcqEngine *AcqEngine;
+	unsigned int Config[CHANNEL_CONFIG_LEN];
+	int CallNumber;
+};
+
+static void BenchMatchFilter(void *Param)
+{
+	AcqBench *Bench = (AcqBench *)Param;
+	complex_int CorResult[MF_CORE_DEPTH];
+	int i;
+
+	for (i = 0; i < Bench->CallNumber; i ++)
+		Bench->AcqEngine->MatchFilterCore(MF_CORE_DEPTH, CorResult);
+}
+
+static void BenchSearchOneChannel(void *Param)
+{
+	AcqBench *Bench = (AcqBench *)Param;
+
+	Bench->AcqEngine->LoadChannelConfig(Bench->Config);
+	Bench->AcqEngine->SearchOneChannel();
+	Bench->AcqEngine->SaveChannelResult(Bench->Config);
+}
+
+// fill AE buffer with 20ms samples and set a L1CA SV01 search with 5 strides of 4ms coherent, 2 non-coherent
+static void PrepareAcqEngine(AcqBench &Bench)
+{
+	CAcqEngine &AcqEngine = Top.AcqEngine;
+	int i;
+
+	Top.SetRegValue(ADDR_AE_CARRIER_FREQ, AcqCarrierFreq());
+	Top.SetRegValue(ADDR_AE_CODE_RATIO, AcqCodeRatio());
+	Top.SetRegValue(ADDR_AE_THRESHOLD, 37);
+	Top.SetRegValue(ADDR_AE_BUFFER_CONTROL, 0x300 + 20);
+	Top.IfFile.Seek(0);
+	for (i = 0; i < 20; i ++)
+		Top.Process(BLOCK_SIZE);
+
+	Bench.AcqEngine = &AcqEngine;
+	InitAcqConfig(Bench.Config, BenchSignals[0], 5, 4, 2);
+	// load samples and code of the first segment for match filter fixtures
+	BenchSearchOneChannel(&Bench);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *FileName = (argc > 1) ? argv[1] : BENCH_IF_FILE;
+	static const int CorrelatorChannels[3] = { 1, 4, 32 };
+	static const char *CorrelatorName[3] = { "Correlation x1", "Correlation x4", "Correlation x32" };
+	static const char *MatchFilterName[3] = { "MatchFilterCore direct", "MatchFilterCore fft", "MatchFilterCore bitslice" };
+	BenchResult Result;
+	CRateAdaptor RateAdaptor;
+	CTeFifoMem TeFifo(0, 10240);
+	CorrelatorBench CorBench;
+	AcqBench AeBench;
+	int i, ch, Mode;
+	unsigned int PolySettings[4];
+
+	if (argc > 2)
+		RepeatNumber = atoi(argv[2]) > 0 ? atoi(argv[2]) : 1;
+	if (argc > 3)
+		Filter = argv[3];
+	if (!Top.IfFile.OpenIfFile((char *)FileName))
+	{
+		printf("Cannot open IF file %s\n", FileName);
+		printf("Usage: %s [IfFile] [RepeatNumber] [FixtureFilter]\n", argv[0]);
+		return 1;
+	}
+
+	// decode whole file once so fixtures after file read are not affected by file access
+	IfSamples = (complex_int *)malloc(MAX_SAMPLE_NUMBER * sizeof(complex_int));
+	IfSampleNumber = 0;
+	while (IfSampleNumber + BLOCK_SIZE <= MAX_SAMPLE_NUMBER && Top.IfFile.ReadFile(BLOCK_SIZE, IfSamples + IfSampleNumber))
+		IfSampleNumber += BLOCK_SIZE;
+
+	printf("IF file %s, %d samples, best of %d runs, SIMD level %d\n", FileName, IfSampleNumber, RepeatNumber, GetSimdLevel());
+	printf("%-28s %10s %12s %9s %12s %10s %8s\n", "fixture", "ms/run", "ns/unit", "unit", "Munit/s", "Msample/s", "realtime");
+
+	// IF file, all samples of the file read in 1ms blocks
+	Result.SampleNumber = Result.UnitNumber = (double)Top.IfFile.GetSampleNumber();
+	Result.Unit = "sample";
+	Result.Name = "IfFile.ReadFile";
+	RunBench(Result, BenchReadFile, NULL);
+	Result.Name = "IfFile.ReadFile prefetch";
+	RunBench(Result, BenchReadFilePrefetch, NULL);
+
+	// rate adaptor with 2.046MHz output rate as AE fill
+	RateAdaptor.CarrierFreq = AcqCarrierFreq();
+	RateAdaptor.CodeRateAdjustRatio = AcqCodeRatio();
+	RateAdaptor.Threshold = 37;
+	Result.SampleNumber = Result.UnitNumber = (double)(IfSampleNumber / BLOCK_SIZE * BLOCK_SIZE);
+	for (Mode = 1; Mode >= 0; Mode --)
+	{
+		RateAdaptor.BlockMode = Mode;
+		Result.Name = Mode ? "RateAdaptor block" : "RateAdaptor serial";
+		RunBench(Result, BenchRateAdaptor, &RateAdaptor);
+	}
+
+	// TE FIFO write and read path
+	TeFifo.SetRegValue(ADDR_OFFSET_TE_FIFO_BLOCK_SIZE, BLOCK_SIZE);
+	TeFifo.SetFifoEnable(1);
+	Result.Name = "TeFifoMem write/read x4";
+	RunBench(Result, BenchTeFifo, &TeFifo);
+
+	// correlator, one correlator time shared by all channels
+	Top.SetRegValue(ADDR_TE_POLYNOMIAL, 0x00e98204);
+	Top.SetRegValue(ADDR_TE_CODE_LENGTH, 0x00ffc000);
+	for (i = 0; i < 4; i ++)
+		PolySettings[i] = Top.TrackingEngine.PrnPolyLength[i];
+	CorBench.Correlator = new CCorrelator(PolySettings, Top.MemCodeBuffer);
+	CorBench.ChannelState = (unsigned int *)malloc(LOGICAL_CHANNEL_NUMBER * 32 * sizeof(unsigned int));
+	CorBench.InitState = (unsigned int *)malloc(LOGICAL_CHANNEL_NUMBER * 32 * sizeof(unsigned int));
+	for (ch = 0; ch < LOGICAL_CHANNEL_NUMBER; ch ++)
+		InitChannelState(CorBench.InitState + ch * 32, BenchSignals[ch % BenchSignalNumber], Top.MemCodeBuffer);
+	Result.Unit = "cor-smp";
+	for (i = 0; i < 3; i ++)
+	{
+		CorBench.ChannelNumber = CorrelatorChannels[i];
+		Result.Name = CorrelatorName[i];
+		Result.SampleNumber = (double)(IfSampleNumber / BLOCK_SIZE * BLOCK_SIZE);
+		Result.UnitNumber = Result.SampleNumber * CorBench.ChannelNumber;
+		RunBench(Result, BenchCorrelation, &CorBench);
+	}
+	delete CorBench.Correlator;
+	free(CorBench.ChannelState);
+	free(CorBench.InitState);
+
+	// acquisition engine, one match filter call gives MF_CORE_DEPTH correlation outputs
+	PrepareAcqEngine(AeBench);
+	AeBench.CallNumber = 100;
+	Result.Unit = "output";
+	Result.SampleNumber = 0;
+	Result.UnitNumber = (double)AeBench.CallNumber * MF_CORE_DEPTH;
+	for (Mode = MF_MODE_DIRECT; Mode <= MF_MODE_BITSLICE; Mode ++)
+	{
+		if (Top.AcqEngine.SetMatchFilterMode(Mode, 0) != Mode)
+			continue;
+		Result.Name = MatchFilterName[Mode];
+		RunBench(Result, BenchMatchFilter, &AeBench);
+	}
+	// search cells are code phase by frequency bins of all strides
+	Result.Unit = "cell";
+	Result.UnitNumber = 5. * 3 * 3 * MF_CORE_DEPTH * DFT_NUMBER;
+	for (Mode = MF_MODE_DIRECT; Mode <= MF_MODE_BITSLICE; Mode ++)
+	{
+		if (Top.AcqEngine.SetMatchFilterMode(Mode, 0) != Mode)
+			continue;
+		Result.Name = (Mode == MF_MODE_DIRECT) ? "SearchOneChannel direct" : (Mode == MF_MODE_FFT) ? "SearchOneChannel fft" : "SearchOneChannel bitslice";
+		RunBench(Result, BenchSearchOneChannel, &AeBench);
+	}
+
+	free(IfSamples);
+	return 0;
+}
@@ -0,0 +1,590 @@
+//----------------------------------------------------------------------
+// ModelRegress.cpp:
+//   Bit exact regression of hardware model against golden result of all_signal.bin
+//   built with REGRESS_FIRMWARE, firmware runs cold start on the model and its measurement output is compared
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <chrono>
+#include "CommonOps.h"
+#include "RegAddress.h"
+#include "GnssTop.h"
+#include "BenchConfig.h"
+#include "ModelProfile.h"
+#if defined REGRESS_FIRMWARE
+#include "SystemConfig.h"
+#include "HWCtrl.h"
+extern "C" {
+#include "FirmwarePortal.h"
+}
+#undef NULL
+#define NULL 0		// CommonDefines.h defines NULL as (void *)0, which C++ does not convert to other pointers
+#endif
+
+// golden file is a header followed by records, all in 32bit words of host byte order
+// header: GOLDEN_MAGIC, GOLDEN_VERSION, millisecond number, TE channel number, AE channel number, total record words
+// record: Type at bit24~31, Channel at bit16~23 and data word number at bit0~15, then millisecond, then data words
+// built with REGRESS_FIRMWARE, golden file is text written by firmware to baseband measurement stream port
+#define GOLDEN_MAGIC 0x444c4f47		// "GOLD"
+#define GOLDEN_VERSION 1
+#define GOLDEN_HEADER_SIZE 6
+
+#define RECORD_COH_DATA		1	// 8 coherent sum words of a channel with coherent data ready
+#define RECORD_OVERWRITE	2	// overwrite protect address and value
+#define RECORD_MEASUREMENT	3	// PRN count, carrier phase, carrier count, code phase, PRN code and correlator state words
+#define RECORD_ACQ_RESULT	4	// 4 search result words of an AE channel
+#define RECORD_TYPE_NUMBER	5
+
+#define TE_CHANNEL_NUMBER 12
+#define MEASUREMENT_INTERVAL 10		// ms between measurement interrupts
+#define MAX_REPORT_NUMBER 64
+
+static const char *RecordName[RECORD_TYPE_NUMBER] = { "", "coherent", "overwrite", "measurement", "acquisition" };
+
+// AE search rounds, signals searched with stride, coherent and non-coherent number
+struct AcqRound
+{
+	int StartMs;
+	int SignalNumber;
+	int SignalIndex[4];
+	int StrideNumber;
+	int CoherentNumber;
+	int NonCoherentNumber;
+};
+
+static AcqRound AcqRounds[] = {
+	{ 30, 3, { 0, 4, 8 }, 5, 4, 2 },
+	{ 100, 3, { 1, 2, 3 }, 1, 1, 1 },
+};
+#define ACQ_ROUND_NUMBER ((int)(sizeof(AcqRounds) / sizeof(AcqRounds[0])))
+
+// growing array of record words
+struct RecordStream
+{
+	unsigned int *Data;
+	int Size;
+	int Capacity;
+};
+
+#if defined REGRESS_FIRMWARE
+static CGnssTop &Top = *GetBasebandModel();	// model options set before firmware starts
+#else
+static CGnssTop Top;
+#endif
+static RecordStream Result;
+static int CurrentMs;
+static int AcqChannelNumber;
+
+static void AddRecord(int Type, int Channel, unsigned int Words[], int WordNumber)
+{
+	int i;
+
+	if (Result.Size + WordNumber + 2 > Result.Capacity)
+	{
+		Result.Capacity = (Result.Capacity + WordNumber + 2) * 2;
+		Result.Data = (unsigned int *)realloc(Result.Data, Result.Capacity * sizeof(unsigned int));
+	}
+	Result.Data[Result.Size ++] = (Type << 24) | (Channel << 16) | WordNumber;
+	Result.Data[Result.Size ++] = CurrentMs;
+	for (i = 0; i < WordNumber; i ++)
+		Result.Data[Result.Size ++] = Words[i];
+}
+
+// read channel state through registers as firmware does
+static void ReadChannelWords(int Channel, int Offset, int WordNumber, unsigned int Words[])
+{
+	int i;
+
+	for (i = 0; i < WordNumber; i ++)
+		Words[i] = Top.GetRegValue(ADDR_BASE_TE_BUFFER + (((Channel << 5) + Offset + i) << 2));
+}
+
+//*************** Interrupt service recording baseband output ****************
+static void RegressISR()
+{
+	U32 Flag = Top.GetRegValue(ADDR_INTERRUPT_FLAG);
+	unsigned int Words[8];
+	unsigned int Mask;
+	int i, ch;
+
+	if (Flag & 0x100)	// coherent data ready
+	{
+		Mask = Top.GetRegValue(ADDR_TE_COH_DATA_READY);
+		for (ch = 0; ch < 32; ch ++)
+		{
+			if ((Mask & (1 << ch)) == 0)
+				continue;
+			ReadChannelWords(ch, 24, 8, Words);
+			AddRecord(RECORD_COH_DATA, ch, Words, 8);
+		}
+		Mask = Top.GetRegValue(ADDR_TE_OVERWRITE_PROTECT_CHANNEL);
+		for (ch = 0; ch < 32; ch ++)
+		{
+			if ((Mask & (1 << ch)) == 0)
+				continue;
+			Words[0] = Top.GetRegValue(ADDR_TE_OVERWRITE_PROTECT_ADDR);
+			Words[1] = Top.GetRegValue(ADDR_TE_OVERWRITE_PROTECT_VALUE);
+			AddRecord(RECORD_OVERWRITE, ch, Words, 2);
+		}
+	}
+	if (Flag & 0x200)	// measurement
+	{
+		Mask = Top.GetRegValue(ADDR_TE_CHANNEL_ENABLE);
+		for (ch = 0; ch < 32; ch ++)
+		{
+			if ((Mask & (1 << ch)) == 0)
+				continue;
+			ReadChannelWords(ch, STATE_OFFSET_PRN_COUNT, 6, Words);
+			AddRecord(RECORD_MEASUREMENT, ch, Words, 6);
+		}
+	}
+	if (Flag & 0x800)	// acquisition done
+	{
+		for (ch = 0; ch < AcqChannelNumber; ch ++)
+		{
+			for (i = 0; i < 4; i ++)
+				Words[i] = Top.GetRegValue(ADDR_BASE_AE_BUFFER + (ch << 5) + ((i + 4) << 2));
+			AddRecord(RECORD_ACQ_RESULT, ch, Words, 4);
+		}
+	}
+	Top.SetRegValue(ADDR_INTERRUPT_FLAG, Flag);
+}
+
+// start AE search of one round, result interrupt is raised after simulated process time
+static void StartAcquisition(AcqRound &Round)
+{
+	unsigned int Config[CHANNEL_CONFIG_LEN];
+	int i, j;
+
+	for (i = 0; i < Round.SignalNumber; i ++)
+	{
+		InitAcqConfig(Config, BenchSignals[Round.SignalIndex[i]], Round.StrideNumber, Round.CoherentNumber, Round.NonCoherentNumber);
+		for (j = 0; j < 4; j ++)
+			Top.SetRegValue(ADDR_BASE_AE_BUFFER + (i << 5) + (j << 2), Config[j]);
+	}
+	AcqChannelNumber = Round.SignalNumber;
+	Top.SetRegValue(ADDR_AE_CONTROL, 0x100 | Round.SignalNumber);
+}
+
+// replay IF file with fixed baseband configuration, return number of milliseconds processed
+static int RunScenario(int MsNumber)
+{
+	unsigned int State[32];
+	int i, ch, Round = 0;
+
+	Top.SetRegValue(ADDR_TE_POLYNOMIAL, 0x00e98204);
+	Top.SetRegValue(ADDR_TE_CODE_LENGTH, 0x00ffc000);
+	Top.SetRegValue(ADDR_TE_NOISE_CONFIG, 1);
+	Top.SetRegValue(ADDR_TE_NOISE_FLOOR, 784 >> 1);
+	Top.SetRegValue(ADDR_TE_FIFO_CONFIG, 0);
+	Top.SetRegValue(ADDR_TE_FIFO_BLOCK_SIZE, BLOCK_SIZE);
+	Top.SetRegValue(ADDR_MEAS_NUMBER, MEASUREMENT_INTERVAL);
+	Top.SetRegValue(ADDR_INTERRUPT_MASK, 0xf00);
+	Top.SetRegValue(ADDR_BB_ENABLE, 0x100);
+	for (ch = 0; ch < TE_CHANNEL_NUMBER; ch ++)
+	{
+		InitChannelState(State, BenchSignals[ch % BenchSignalNumber], Top.MemCodeBuffer);
+		for (i = 0; i < 32; i ++)
+			Top.SetRegValue(ADDR_BASE_TE_BUFFER + (((ch << 5) + i) << 2), State[i]);
+	}
+	Top.SetRegValue(ADDR_TE_CHANNEL_ENABLE, (1 << TE_CHANNEL_NUMBER) - 1);
+	Top.SetRegValue(ADDR_AE_CARRIER_FREQ, AcqCarrierFreq());
+	Top.SetRegValue(ADDR_AE_CODE_RATIO, AcqCodeRatio());
+	Top.SetRegValue(ADDR_AE_THRESHOLD, 37);
+	Top.SetRegValue(ADDR_AE_BUFFER_CONTROL, 0x300 + 20);
+	Top.InterruptService = RegressISR;
+
+	for (CurrentMs = 0; CurrentMs < MsNumber; CurrentMs ++)
+	{
+		if (Round < ACQ_ROUND_NUMBER && CurrentMs == AcqRounds[Round].StartMs)
+			StartAcquisition(AcqRounds[Round ++]);
+		// apply code jumps as tracking loop adjustment does
+		if (CurrentMs == 37)
+			Top.SetRegValue(ADDR_BASE_TE_BUFFER + (((1 << 5) + STATE_OFFSET_PRN_CODE) << 2), (Top.GetRegValue(ADDR_BASE_TE_BUFFER + (((1 << 5) + STATE_OFFSET_PRN_CODE) << 2)) & ~0xff00) | (3 << 8));
+		if (CurrentMs == 61)
+			Top.SetRegValue(ADDR_BASE_TE_BUFFER + (((4 << 5) + STATE_OFFSET_PRN_CODE) << 2), (Top.GetRegValue(ADDR_BASE_TE_BUFFER + (((4 << 5) + STATE_OFFSET_PRN_CODE) << 2)) & ~0xff00) | (0xfb << 8));
+		if (Top.Process(BLOCK_SIZE) < 0)
+			break;
+	}
+
+	return CurrentMs;
+}
+
+#if defined REGRESS_FIRMWARE
+static void CountMs(void *DebugParam, int DebugValue)
+{
+	(void)DebugParam;
+	CurrentMs = DebugValue + 1;
+}
+
+// cold start firmware on IF file, return number of milliseconds processed
+static int RunFirmware()
+{
+	AttachDebugFunc(CountMs);
+	FirmwareInitialize(ColdStart, (PSYSTEM_TIME)0, (LLH *)0);	// IF file has no time and position information
+	EnableRF();
+	fflush(NULL);	// stream port files are kept open by platform
+	return CurrentMs;
+}
+
+// read whole text file, return NULL if file cannot be read
+static char *LoadText(const char *FileName)
+{
+	FILE *fp;
+	char *Text;
+	long Size;
+
+	if ((fp = fopen(FileName, "rb")) == NULL)
+		return NULL;
+	fseek(fp, 0, SEEK_END);
+	Size = ftell(fp);
+	rewind(fp);
+	Text = (char *)malloc(Size + 1);
+	if (Size < 0 || (long)fread(Text, 1, Size, fp) != Size)
+	{
+		free(Text);
+		Text = NULL;
+	}
+	else
+		Text[Size] = 0;
+	fclose(fp);
+	return Text;
+}
+
+static int CountLines(const char *Text, const char *Prefix)
+{
+	int Count = 0;
+	size_t Length = strlen(Prefix);
+
+	while (Text)
+	{
+		if (strncmp(Text, Prefix, Length) == 0)
+			Count ++;
+		if ((Text = strchr(Text, '\n')) != NULL)
+			Text ++;
+	}
+	return Count;
+}
+
+// compare output line by line, print first differing lines, return number of differing lines
+static int CompareText(const char *Golden, const char *Output)
+{
+	const char *GoldenEnd, *OutputEnd;
+	int Line = 1, GoldenLength, OutputLength, DiffNumber = 0;
+
+	while (*Golden || *Output)
+	{
+		GoldenLength = (int)(((GoldenEnd = strchr(Golden, '\n')) != NULL) ? GoldenEnd - Golden : strlen(Golden));
+		OutputLength = (int)(((OutputEnd = strchr(Output, '\n')) != NULL) ? OutputEnd - Output : strlen(Output));
+		if (GoldenLength != OutputLength || strncmp(Golden, Output, GoldenLength) != 0)
+		{
+			if (DiffNumber ++ < MAX_REPORT_NUMBER)
+				printf("  line %d\n    golden %.*s\n    new    %.*s\n", Line, GoldenLength, Golden, OutputLength, Output);
+		}
+		Golden += GoldenLength + (GoldenEnd != NULL);
+		Output += OutputLength + (OutputEnd != NULL);
+		Line ++;
+	}
+	return DiffNumber;
+}
+
+// record or check measurement output of firmware, return value of main()
+static int FirmwareResult(int Record, const char *GoldenFile, int MsNumber, double Time)
+{
+	char StreamFile[32];
+	char *Output, *Golden;
+	int MeasNumber, DiffNumber;
+	FILE *fp;
+
+	sprintf(StreamFile, STREAM_FILE_PREFIX, DEFAULT_BB_MEAS_PORT);
+	if ((Output = LoadText(StreamFile)) == NULL)
+	{
+		printf("Cannot read measurement output %s\n", StreamFile);
+		return 2;
+	}
+	MeasNumber = CountLines(Output, "$PBMSR");
+	printf("replayed %dms in %.3fs (%.2fx realtime), %d channel measurements in %s\n", MsNumber, Time, MsNumber / 1000. / Time, MeasNumber, StreamFile);
+	// an empty golden file would pass with every model option
+	if (MeasNumber == 0)
+	{
+		printf("FAIL: no channel measurement, replay longer to let firmware acquire and track\n");
+		free(Output);
+		return 1;
+	}
+
+	if (Record)
+	{
+		if ((fp = fopen(GoldenFile, "wb")) == NULL)
+		{
+			printf("Cannot write golden file %s\n", GoldenFile);
+			free(Output);
+			return 2;
+		}
+		fwrite(Output, 1, strlen(Output), fp);
+		fclose(fp);
+		free(Output);
+		printf("golden result saved to %s\n", GoldenFile);
+		return 0;
+	}
+
+	if ((Golden = LoadText(GoldenFile)) == NULL)
+	{
+		printf("Cannot read golden file %s\n", GoldenFile);
+		free(Output);
+		return 2;
+	}
+	DiffNumber = CompareText(Golden, Output);
+	free(Golden);
+	free(Output);
+	if (DiffNumber)
+	{
+		printf("FAIL: %d lines differ from golden\n", DiffNumber);
+		return 1;
+	}
+	printf("PASS: identical to golden\n");
+
+	return 0;
+}
+#endif
+
+static int SaveGolden(const char *FileName, unsigned int Header[GOLDEN_HEADER_SIZE])
+{
+	FILE *fp;
+
+	if ((fp = fopen(FileName, "wb")) == NULL)
+		return 0;
+	fwrite(Header, sizeof(unsigned int), GOLDEN_HEADER_SIZE, fp);
+	fwrite(Result.Data, sizeof(unsigned int), Result.Size, fp);
+	fclose(fp);
+	return 1;
+}
+
+static unsigned int *LoadGolden(const char *FileName, unsigned int Header[GOLDEN_HEADER_SIZE])
+{
+	FILE *fp;
+	unsigned int *Data;
+
+	if ((fp = fopen(FileName, "rb")) == NULL)
+		return NULL;
+	if (fread(Header, sizeof(unsigned int), GOLDEN_HEADER_SIZE, fp) != GOLDEN_HEADER_SIZE || Header[0] != GOLDEN_MAGIC || Header[1] != GOLDEN_VERSION)
+	{
+		fclose(fp);
+		return NULL;
+	}
+	Data = (unsigned int *)malloc((Header[5] + 1) * sizeof(unsigned int));
+	if (fread(Data, sizeof(unsigned int), Header[5], fp) != Header[5])
+	{
+		free(Data);
+		Data = NULL;
+	}
+	fclose(fp);
+	return Data;
+}
+
+// find next record of given type and channel starting from Pos, return -1 if not found
+static int NextRecord(unsigned int Data[], int Size, int Pos, int Type, int Channel)
+{
+	while (Pos < Size)
+	{
+		if ((int)(Data[Pos] >> 24) == Type && (int)((Data[Pos] >> 16) & 0xff) == Channel)
+			return Pos;
+		Pos += (Data[Pos] & 0xffff) + 2;
+	}
+	return -1;
+}
+
+// compare record streams of each type and channel, print first divergence of each stream
+// return number of streams with difference
+static int CompareRecords(unsigned int Golden[], int GoldenSize)
+{
+	int Type, Channel, GoldenPos, NewPos, WordNumber, i;
+	int RecordNumber, DiffNumber, FirstMs, FirstWord, Reported = 0, DiffStream = 0;
+	unsigned int GoldenValue, NewValue;
+
+	for (Type = 1; Type < RECORD_TYPE_NUMBER; Type ++)
+		for (Channel = 0; Channel < 32; Channel ++)
+		{
+			RecordNumber = DiffNumber = 0;
+			FirstMs = -1;
+			FirstWord = 0;
+			GoldenValue = NewValue = 0;
+			GoldenPos = NextRecord(Golden, GoldenSize, 0, Type, Channel);
+			NewPos = NextRecord(Result.Data, Result.Size, 0, Type, Channel);
+			while (GoldenPos >= 0 || NewPos >= 0)
+			{
+				RecordNumber ++;
+				if (GoldenPos < 0 || NewPos < 0 || Golden[GoldenPos] != Result.Data[NewPos] || Golden[GoldenPos+1] != Result.Data[NewPos+1])
+				{
+					// record missing or at different time, streams cannot be aligned any more
+					if (FirstMs < 0)
+					{
+						FirstMs = (int)((GoldenPos >= 0) ? Golden[GoldenPos+1] : Result.Data[NewPos+1]);
+						FirstWord = -1;
+					}
+					DiffNumber ++;
+					break;
+				}
+				WordNumber = Golden[GoldenPos] & 0xffff;
+				for (i = 0; i < WordNumber; i ++)
+					if (Golden[GoldenPos+2+i] != Result.Data[NewPos+2+i])
+						break;
+				if (i < WordNumber)
+				{
+					if (FirstMs < 0)
+					{
+						FirstMs = (int)Golden[GoldenPos+1];
+						FirstWord = i;
+						GoldenValue = Golden[GoldenPos+2+i];
+						NewValue = Result.Data[NewPos+2+i];
+					}
+					DiffNumber ++;
+				}
+				GoldenPos = NextRecord(Golden, GoldenSize, GoldenPos + WordNumber + 2, Type, Channel);
+				NewPos = NextRecord(Result.Data, Result.Size, NewPos + WordNumber + 2, Type, Channel);
+			}
+			if (DiffNumber == 0)
+				continue;
+			DiffStream ++;
+			if (Reported ++ >= MAX_REPORT_NUMBER)
+				continue;
+			if (FirstWord < 0)
+				printf("  %-11s ch%-2d first divergence at %dms: record missing or out of order\n", RecordName[Type], Channel, FirstMs);
+			else
+				printf("  %-11s ch%-2d first divergence at %dms word %d: golden %08x new %08x (%d of %d records differ)\n", RecordName[Type], Channel, FirstMs, FirstWord, GoldenValue, NewValue, DiffNumber, RecordNumber);
+		}
+
+	return DiffStream;
+}
+
+static void Usage(const char *Name)
+{
+	printf("Usage: %s record|check GoldenFile [options]\n", Name);
+	printf("  -i IfFile         input IF file (default %s)\n", BENCH_IF_FILE);
+	printf("  -ms N             number of milliseconds to replay, file wraps at end (default whole file once)\n");
+	printf("  -simd Level       correlator kernel level, 0 scalar, 1 SSE4.1, 2 AVX2\n");
+	printf("  -nocache          generate PRN code by PrnGen instead of cached chip table\n");
+	printf("  -te Mode Threads  tracking engine parallel mode\n");
+	printf("  -wide ChunkSize   tracking engine wide mode\n");
+	printf("  -mf Mode          AE match filter mode, 0 direct, 1 FFT, 2 bit slice\n");
+	printf("  -ae Mode Threads  AE parallel mode\n");
+	printf("  -ra Mode          rate adaptor block mode, 0 serial, 1 block\n");
+	printf("  -prefetch N       read IF file on background thread with N blocks\n");
+	printf("  -csv FileName     per second profile output when built with MODEL_PROFILE\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *FileName = BENCH_IF_FILE;
+	unsigned int Header[GOLDEN_HEADER_SIZE], GoldenHeader[GOLDEN_HEADER_SIZE];
+	unsigned int *Golden;
+	int Record, MsNumber = 0x7fffffff, Prefetch = 0;
+	int i, DiffStream;
+	double Start, Time;
+
+	if (argc < 3 || (strcmp(argv[1], "record") && strcmp(argv[1], "check")))
+	{
+		Usage(argv[0]);
+		return 2;
+	}
+	Record = (strcmp(argv[1], "record") == 0);
+	for (i = 3; i < argc; i ++)
+	{
+		if (!strcmp(argv[i], "-i") && i + 1 < argc)
+			FileName = argv[++ i];
+		else if (!strcmp(argv[i], "-ms") && i + 1 < argc)
+			MsNumber = atoi(argv[++ i]);
+		else if (!strcmp(argv[i], "-simd") && i + 1 < argc)
+			SetSimdLevel(atoi(argv[++ i]));
+		else if (!strcmp(argv[i], "-nocache"))
+			CCorrelator::EnablePrnCache = 0;
+		else if (!strcmp(argv[i], "-te") && i + 2 < argc)
+		{
+			Top.TrackingEngine.SetParallelMode(atoi(argv[i+1]), atoi(argv[i+2]));
+			i += 2;
+		}
+		else if (!strcmp(argv[i], "-wide") && i + 1 < argc)
+			Top.TrackingEngine.SetWideMode(atoi(argv[++ i]));
+		else if (!strcmp(argv[i], "-mf") && i + 1 < argc)
+			Top.AcqEngine.SetMatchFilterMode(atoi(argv[++ i]), 0);
+		else if (!strcmp(argv[i], "-ae") && i + 2 < argc)
+		{
+			Top.AcqEngine.SetParallelMode(atoi(argv[i+1]), atoi(argv[i+2]));
+			i += 2;
+		}
+		else if (!strcmp(argv[i], "-ra") && i + 1 < argc)
+			Top.AcqEngine.RateAdaptor.BlockMode = atoi(argv[++ i]);
+		else if (!strcmp(argv[i], "-prefetch") && i + 1 < argc)
+			Prefetch = atoi(argv[++ i]);
+		else if (!strcmp(argv[i], "-csv") && i + 1 < argc)
+			ProfileSetCsv(argv[++ i]);
+		else
+		{
+			Usage(argv[0]);
+			return 2;
+		}
+	}
+
+	if (!Top.IfFile.OpenIfFile((char *)FileName))
+	{
+		printf("Cannot open IF file %s\n", FileName);
+		return 2;
+	}
+	if (MsNumber != 0x7fffffff)
+		Top.IfFile.SetReplayLength((long long)MsNumber * BLOCK_SIZE);
+	if (Prefetch > 0)
+		Top.SetPrefetch(BLOCK_SIZE, Prefetch);
+
+	Start = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#if defined REGRESS_FIRMWARE
+	MsNumber = RunFirmware();
+#else
+	MsNumber = RunScenario(MsNumber);
+#endif
+	Time = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count() - Start;
+#if defined REGRESS_FIRMWARE
+	return FirmwareResult(Record, argv[2], MsNumber, Time);
+#endif
+	printf("replayed %dms of %s in %.3fs (%.2fx realtime), %d record words\n", MsNumber, FileName, Time, MsNumber / 1000. / Time, Result.Size);
+
+	Header[0] = GOLDEN_MAGIC;
+	Header[1] = GOLDEN_VERSION;
+	Header[2] = MsNumber;
+	Header[3] = TE_CHANNEL_NUMBER;
+	Header[4] = AcqChannelNumber;
+	Header[5] = Result.Size;
+	if (Record)
+	{
+		if (!SaveGolden(argv[2], Header))
+		{
+			printf("Cannot write golden file %s\n", argv[2]);
+			return 2;
+		}
+		printf("golden result saved to %s\n", argv[2]);
+		return 0;
+	}
+
+	if ((Golden = LoadGolden(argv[2], GoldenHeader)) == NULL)
+	{
+		printf("Cannot read golden file %s\n", argv[2]);
+		return 2;
+	}
+	if (GoldenHeader[2] != Header[2] || GoldenHeader[3] != Header[3])
+		printf("  golden file has %dms and %d channels, current run has %dms and %d channels\n", GoldenHeader[2], GoldenHeader[3], Header[2], Header[3]);
+	DiffStream = CompareRecords(Golden, (int)GoldenHeader[5]);
+	free(Golden);
+	free(Result.Data);
+	if (DiffStream || GoldenHeader[2] != Header[2] || GoldenHeader[3] != Header[3])
+	{
+		printf("FAIL: %d record streams differ from golden\n", DiffStream);
+		return 1;
+	}
+	printf("PASS: bit exact with golden\n");
+
+	return 0;
+}
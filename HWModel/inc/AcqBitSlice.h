@@ -0,0 +1,41 @@
+//----------------------------------------------------------------------
+// AcqBitSlice.h:
+//   Bit sliced match filter for acquisition engine declaration
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __ACQ_BIT_SLICE_H__
+#define __ACQ_BIT_SLICE_H__
+
+#include "CommonOps.h"
+
+#define BITSLICE_SAMPLE_BITS 6				// match filter input is 6bit signed for both I and Q
+#define BITSLICE_MAX_CODE_LENGTH 1024		// code chips (taps) in one match filter segment
+#define BITSLICE_MAX_SAMPLES 4096			// samples in one match filter segment
+#define BITSLICE_CODE_WORDS (BITSLICE_MAX_CODE_LENGTH / 64 + 1)
+#define BITSLICE_PLANE_WORDS (BITSLICE_MAX_SAMPLES / 128 + BITSLICE_CODE_WORDS + 1)
+
+typedef void (*BitSliceKernel)(const unsigned long long *Planes, const unsigned long long *ShiftedCode, int CodeWords, const int *WindowSum, int CodeLength, int CodeSum, int PhaseCount, complex_int CorResult[]);
+
+class CAcqBitSlice
+{
+public:
+	CAcqBitSlice();
+	~CAcqBitSlice();
+
+	void MatchFilter(const complex_int Samples[], const unsigned int Code[], int CodeLength, int PhaseCount, complex_int CorResult[]);
+
+private:
+	// bit planes of samples at even/odd position, index as [parity][I/Q][bit][word]
+	unsigned long long Planes[2][2][BITSLICE_SAMPLE_BITS][BITSLICE_PLANE_WORDS];
+	// prefix sum of sample value at even/odd position, index as [parity][I/Q][position]
+	int WindowSum[2][2][BITSLICE_MAX_SAMPLES/2+1];
+	// code bits shifted by 0 to 63 bits, bit t+shift is chip t
+	unsigned long long ShiftedCode[64][BITSLICE_CODE_WORDS];
+
+	BitSliceKernel Kernel;
+};
+
+#endif //__ACQ_BIT_SLICE_H__
@@ -16,6 +16,9 @@
 #include "WeilPrn.h"
 #include "PeakSorter.h"
 #include "RateAdaptor.h"
+#include "AcqFft.h"
+#include "AcqBitSlice.h"
+#include "WorkerPool.h"
 
 // definitions for intermediate data output
 #define INTERMEDIATE_RESULT_SAMPLE2BUFFER   0
@@ -38,6 +41,32 @@
 #define ADDER_TREE_WIDTH (MF_CORE_DEPTH/2)
 #define DFT_NUMBER 8
 
+// match filter implementation, model only, no corresponding hardware register
+#define MF_MODE_DIRECT	0	// add/sub each tap as adder tree in RTL does
+#define MF_MODE_FFT		1	// FFT cross correlation with cached code segment spectra, result rounded to integer
+#define MF_MODE_BITSLICE	2	// AND/popcount on bit planes of samples, 64 taps per word, bit exact
+
+// parallel mode of DoAcquisition, model only, no corresponding hardware register
+#define AE_PARALLEL_NONE	0	// search channels one by one as RTL does
+#define AE_PARALLEL_CHANNEL	1	// each channel is one task for worker threads
+#define AE_PARALLEL_STRIDE	2	// each code round of each stride is one task, peaks sorted in search order afterwards
+
+// number of tasks dispatched at once in AE_PARALLEL_STRIDE mode for each worker
+#define AE_BATCH_PER_WORKER 2
+// record words for one non-coherent round, MF_CORE_DEPTH peaks followed by NoiseFloor and NoncohExp
+#define AE_RECORD_ROUND_SIZE (MF_CORE_DEPTH+2)
+
+// peaks of one code round in one stride recorded by worker before inserting to peak sorter
+struct AcqPeakRecord
+{
+	int Channel;
+	int StrideCount;		// 0 for channel with nothing to search
+	int CodeRoundCount;
+	int RoundNumber;		// number of non-coherent rounds recorded
+	int Capacity;			// number of non-coherent rounds Data can hold
+	unsigned int *Data;		// each peak has Amp at bit0~15, Exp at bit16~23 and frequency bin at bit24~31
+};
+
 struct complex_exp10 {
 	int real;	// 10bit
 	int imag;	// 10bit
@@ -93,6 +122,8 @@ public:
 	void LoadSample();
 	void LoadCode();
 	void MatchFilterCore(int PhaseCount, complex_int CorResult[]);
+	void MatchFilterDirect(int PhaseCount, complex_int CorResult[]);
+	int SetMatchFilterMode(int Mode, int Check);
 	void GetDftFactor(complex_int DftFactor[DFT_NUMBER/2], int sign_cos[DFT_NUMBER/2], int sign_sin[DFT_NUMBER/2]);
 	void NonCoherentAcc(unsigned int MaxCohExp, int NoncohCount);
 	void DoNonCoherentSum();
@@ -103,10 +134,20 @@ public:
 	void InitPrnGen();
 	void SetStartAddr(int Addr) { ReadPointer = Addr; }
 	unsigned int ReadSample();
+	void LoadChannelConfig(unsigned int Config[CHANNEL_CONFIG_LEN]);
+	void SaveChannelResult(unsigned int Config[CHANNEL_CONFIG_LEN]);
+	void SetStrideOffset();
+	// interface functions for multi-thread acquisition
+	void SetParallelMode(int Mode, int ThreadNumber);
+	void SearchChannelParallel();
+	void SearchStrideParallel();
+	int ReplayPeakRecord(AcqPeakRecord &Record);
+	static void ChannelTask(void *Param, int TaskIndex, int WorkerIndex);
+	static void StrideTask(void *Param, int TaskIndex, int WorkerIndex);
 
 	static const int complex_mul_i[16][64];
 	static const int complex_mul_q[16][64];
-	static const int CAcqEngine::dft_table[128];
+	static const int dft_table[128];
 	static const unsigned int PrnPolySettings[2];	// GPS L1CA polynomial settings
 	static const unsigned int GpsInit[32+19];	// WAAS placed after GPS
 	static const unsigned int B1CInit[63];		// initial value for B1C code generation
@@ -136,6 +177,7 @@ public:
 	unsigned long long NonCoherentBuffer[MF_CORE_DEPTH+2];
 	unsigned int ChannelConfig[MAX_CHANNEL][CHANNEL_CONFIG_LEN];
 	unsigned char AEBuffer[AE_BUFFER_SIZE];
+	unsigned char *SampleBuffer;	// AEBuffer of its own or AEBuffer shared from the engine owning the worker
 
 	CPrnGen *PrnGen[4];
 	CPeakSorter PeakSorter;
@@ -143,6 +185,22 @@ public:
 
 	// for reference intermediate result output
 	FILE *fp_out[TOTAL_INTERMEDIATE_RESULT];
+
+	// match filter implementation selection
+	int MatchFilterMode;
+	int MatchFilterCheck;		// compare with MF_MODE_DIRECT result on each segment
+	int MatchFilterMismatch;	// number of segments different from MF_MODE_DIRECT result
+	CAcqFft *MfFft;
+	CAcqBitSlice *MfBitSlice;
+
+	// worker pool for parallel mode, each worker is an engine reading SampleBuffer of this engine
+	unsigned int *MemCode;
+	int ParallelMode;
+	CWorkerPool *WorkerPool;
+	CAcqEngine *WorkerEngine[MAX_WORKER_NUMBER];
+	int UnitNumber;
+	AcqPeakRecord UnitRecord[MAX_WORKER_NUMBER*AE_BATCH_PER_WORKER];
+	AcqPeakRecord *PeakRecord;	// not NULL for worker recording peaks instead of inserting to peak sorter
 };
 
 #endif //__ACQ_ENGINE_H__
@@ -0,0 +1,58 @@
+//----------------------------------------------------------------------
+// AcqFft.h:
+//   FFT based matched filter for acquisition engine declaration
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __ACQ_FFT_H__
+#define __ACQ_FFT_H__
+
+#include "CommonOps.h"
+
+#define ACQ_FFT_ORDER 11
+#define ACQ_FFT_SIZE (1 << ACQ_FFT_ORDER)
+#define ACQ_MAX_CODE_LENGTH (ACQ_FFT_SIZE / 4)			// code chips (taps) in one match filter segment
+#define ACQ_CODE_WORDS (ACQ_MAX_CODE_LENGTH / 64)
+#define ACQ_SPECTRUM_CACHE_SIZE 64						// number of code segment spectra cached
+
+// correlation result before rounding should be within this distance to an integer
+// max |result| is ADDER_TREE_WIDTH*31, double precision FFT error is several orders below this
+#define ACQ_FFT_TOLERANCE 0.25
+
+// spectrum of one code segment, chip 1 mapped to -1 and chip 0 mapped to +1 at every other sample
+struct AcqCodeSpectrum
+{
+	unsigned long long Code[ACQ_CODE_WORDS];	// packed code as cache key
+	int CodeLength;
+	int CodeSum;								// number of chip 1 in code segment
+	double *Real, *Imag;
+};
+
+class CAcqFft
+{
+public:
+	CAcqFft();
+	~CAcqFft();
+
+	void MatchFilter(const complex_int Samples[], const unsigned int Code[], int CodeLength, int PhaseCount, complex_int CorResult[]);
+	void ClearCache();
+
+	double MaxResidual;				// maximum distance to nearest integer of result before rounding
+	int ExceedCount;				// number of results with residual larger than ACQ_FFT_TOLERANCE
+
+private:
+	void Transform(double Real[], double Imag[], int Inverse);
+	AcqCodeSpectrum *GetCodeSpectrum(const unsigned int Code[], int CodeLength);
+
+	double CosTable[ACQ_FFT_SIZE/2];
+	double SinTable[ACQ_FFT_SIZE/2];
+	int BitReverse[ACQ_FFT_SIZE];
+	double *SampleReal, *SampleImag;
+	AcqCodeSpectrum Spectrum[ACQ_SPECTRUM_CACHE_SIZE];
+	int SpectrumNumber;
+	int ReplaceIndex;				// next entry to be replaced when cache is full
+};
+
+#endif //__ACQ_FFT_H__
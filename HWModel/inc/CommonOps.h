@@ -66,7 +66,9 @@ do { \
 		data = (-(1 << (bit-1))); \
 } while(0)
 
+#if defined _MSC_VER	// implementation of __builtin_xxx in Visual Studio
 int __builtin_popcount(unsigned int data);
 int __builtin_clz(unsigned int data);
+#endif
 
 #endif //__COMMON_OPS_H__
@@ -15,6 +15,8 @@
 #include "MemoryPrn.h"
 #include "PrnGen.h"
 #include "NoiseCalc.h"
+#include "CorrelatorSimd.h"
+#include "PrnCache.h"
 
 typedef void (*DumpFunction)(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int DumpDataLength);
 
@@ -29,6 +31,8 @@ public:
 	CPrnGen *PrnGen[4];				// pointer to difference PRN generator
 	CPrnGen *PrnGen2[4];			// pointer to difference PRN generator
 	CNoiseCalc *NoiseCalc;			// pointer to noise floor calculator
+	PrnChipCursor PrnCursor;		// cached chips replacing PrnGen[PrnIndex] when available
+	PrnChipCursor PrnCursor2;		// cached chips replacing PrnGen2[PrnIndex2] when available
 
 	reg_uint CarrierFreq;			// 32bit RO
 	reg_uint CodeFreq;				// 32bit RO
@@ -72,19 +76,37 @@ public:
 	// data decode valid, internal use, will be cleared at the beginning of every round
 	int DataDecodeValid;
 
+	// block processing buffers, samples in [PendingStart, PendingEnd) are down converted but not yet accumulated
+	unsigned int *SampleIQ;
+	unsigned char *PrnValueBuffer;
+	int PendingStart, PendingEnd;
+	unsigned int PrnValueTable[4];	// PrnValue indexed by 2MSB of CodePhase
+
 	void Reset();
 	int Correlation(int SampleNumber, complex_int SampleData[], S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int &DumpDataLength);
+	void StartCorrelation(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int &DumpDataLength);
+	void CorrelateSamples(int SampleNumber, complex_int SampleData[], S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int &DumpDataLength);
+	int FinishCorrelation(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int &DumpDataLength);
 	void FillState(unsigned int *StateBuffer);
 	void DumpState(unsigned int *StateBuffer);
 	void DecodeDataAcc(unsigned int DataAcc);
 	complex_int DownConvert(complex_int InputData);
 	void AccumulateSample(complex_int Sample, int CorCount);
+	void DownConvertBlock(complex_int SampleData[], int SampleNumber);
+	unsigned int GetPrnValue(unsigned int Phase);
+	void UpdatePrnValue();
+	void FlushAccumulation();
+	int GetPrnCode() { return PrnCursor.Table ? PrnCursor.GetCode() : PrnGen[PrnIndex]->GetCode(); }
+	int ShiftPrnCode() { return PrnCursor.Table ? PrnCursor.ShiftCode() : PrnGen[PrnIndex]->ShiftCode(); }
+	int GetPrnCode2() { return PrnCursor2.Table ? PrnCursor2.GetCode() : PrnGen2[PrnIndex2]->GetCode(); }
+	int ShiftPrnCode2() { return PrnCursor2.Table ? PrnCursor2.ShiftCode() : PrnGen2[PrnIndex2]->ShiftCode(); }
 	int ProcessOverflow(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int &CurrentLength);
 	int DumpData(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int &CurrentLength);
 
 	DumpFunction DumpDataOutput;	// for debug purpose
 
 	static const complex_int DownConvertTable[64];
+	static int EnablePrnCache;		// set to 0 to always generate code by PrnGen
 };
 
 #endif // __CORRELATOR_H__
@@ -0,0 +1,34 @@
+//----------------------------------------------------------------------
+// CorrelatorSimd.h:
+//   Declaration of vectorized correlator kernels with runtime dispatch
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __CORRELATOR_SIMD_H__
+#define __CORRELATOR_SIMD_H__
+
+#include "CommonOps.h"
+
+// kernel implementation level, higher level will be clamped to what CPU supports
+#define SIMD_LEVEL_SCALAR	0
+#define SIMD_LEVEL_SSE41	1
+#define SIMD_LEVEL_AVX2		2
+
+// number of samples processed by kernels in one call
+#define CORRELATOR_BLOCK_SIZE 1024
+
+// down convert SampleNumber samples starting at CarrierPhase, output sample has I at bit0~15 and Q at bit16~31
+typedef void (*DownConvertKernel)(const complex_int SampleData[], int SampleNumber, unsigned int CarrierPhase, unsigned int CarrierFreq, int PreShiftBits, unsigned int SampleIQ[]);
+// add/sub SampleIQ to 8 correlators, bit n of PrnValue set means subtract sample for correlator n
+typedef void (*AccumulateKernel)(const unsigned int SampleIQ[], const unsigned char PrnValue[], int SampleNumber, S16 AccDataI[8], S16 AccDataQ[8]);
+
+int GetCpuSimdLevel();
+int SetSimdLevel(int Level);
+int GetSimdLevel();
+
+extern DownConvertKernel DownConvertSamples;
+extern AccumulateKernel AccumulateSamples;
+
+#endif // __CORRELATOR_SIMD_H__
@@ -32,6 +32,8 @@ public:
 	void Clear(U32 ClearMask);
 	void SetRegValue(int Address, U32 Value);
 	U32 GetRegValue(int Address);
+	void SetRegBurst(int Address, const U32 *Buffer, int WordNumber);
+	void GetRegBurst(int Address, U32 *Buffer, int WordNumber);
 
 	reg_uint TrackingEngineEnable;		// 1bit
 //	reg_uint AcquireEngineEnable;		// 1bit
@@ -43,6 +45,8 @@ public:
 	reg_uint IntMask;					// 4bit, bit8~11
 	reg_uint TickCount;					// 32bit
 
+	// ROM written only in constructor, chip tables of memory code are cached by this address (CPrnCache)
+	// call CPrnCache::Clear() if contents are ever changed after correlation starts
 	unsigned int MemCodeBuffer[128*100];
 	CIfFile IfFile;
 	CTeFifoMem TeFifo;
@@ -54,6 +58,8 @@ public:
 
 	int Process(int ReadBlockSize);
 	void SetInputFile(char *FileName) { IfFile.OpenIfFile(FileName); }
+	void SetThreadNumber(int ThreadNumber) { TrackingEngine.SetParallelMode((ThreadNumber > 1) ? TE_PARALLEL_CHANNEL : TE_PARALLEL_NONE, ThreadNumber); }
+	void SetPrefetch(int BlockSize, int BlockNumber) { IfFile.StartPrefetch(BlockSize, BlockNumber); }	// read input file on background thread
 	int GetAeProcessTime();
 
 	InterruptFunction InterruptService;
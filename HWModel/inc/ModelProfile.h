@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------
+// ModelProfile.h:
+//   Declaration of timing and counter instrumentation of C model
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __MODEL_PROFILE_H__
+#define __MODEL_PROFILE_H__
+
+#include <stdio.h>
+
+// set MODEL_PROFILE to 1 to compile in instrumentation, all PROFILE_xxx macros are empty otherwise
+#if !defined MODEL_PROFILE
+#define MODEL_PROFILE 0
+#endif
+
+// stages timed, time of a stage excludes time of stages started within it
+#define PROFILE_STAGE_IF_READ			0
+#define PROFILE_STAGE_RATE_ADAPTOR		1
+#define PROFILE_STAGE_TE_FIFO			2
+#define PROFILE_STAGE_TRACKING			3
+#define PROFILE_STAGE_ACQUISITION		4
+#define PROFILE_STAGE_INTERRUPT			5
+#define PROFILE_STAGE_BASEBAND_TASK		6
+#define PROFILE_STAGE_POST_MEAS_TASK	7
+#define PROFILE_STAGE_IN_OUT_TASK		8
+#define PROFILE_STAGE_NUMBER			9
+
+// event counters
+#define PROFILE_COUNT_SAMPLE			0	// IF samples read
+#define PROFILE_COUNT_COR_SAMPLE		1	// samples correlated, summed over active channels
+#define PROFILE_COUNT_CHANNEL			2	// active tracking channels, summed over milliseconds
+#define PROFILE_COUNT_AE_CHANNEL		3	// AE channels searched
+#define PROFILE_COUNT_AE_STRIDE			4	// AE strides searched
+#define PROFILE_COUNT_INT_COH			5	// coherent data ready interrupts
+#define PROFILE_COUNT_INT_MEAS			6	// measurement interrupts
+#define PROFILE_COUNT_INT_REQ			7	// request count interrupts
+#define PROFILE_COUNT_INT_AE			8	// AE done interrupts
+#define PROFILE_COUNT_TASK				9	// firmware tasks performed
+#define PROFILE_COUNTER_NUMBER			10
+
+#define PROFILE_MAX_DEPTH 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// stages and counters are updated by the thread running CGnssTop::Process() only, profile state is not thread safe
+// if task queues run on their own threads (ModelRunMT), task stages and task counter are not recorded
+void ProfileStart(int Stage);
+void ProfileStop(int Stage);
+void ProfileCount(int Counter, long long Value);
+void ProfileTick();
+int ProfileSetCsv(const char *FileName);
+void ProfileSummary(FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if MODEL_PROFILE
+#define PROFILE_START(stage)			ProfileStart(stage)
+#define PROFILE_STOP(stage)				ProfileStop(stage)
+#define PROFILE_COUNT(counter, value)	ProfileCount(counter, value)
+#define PROFILE_TICK()					ProfileTick()
+#else
+#define PROFILE_START(stage)
+#define PROFILE_STOP(stage)
+#define PROFILE_COUNT(counter, value)
+#define PROFILE_TICK()
+#endif
+
+#ifdef __cplusplus
+// stage timed within lifetime of the object, so early return is covered
+class CProfileScope
+{
+public:
+	CProfileScope(int Stage) { ScopeStage = Stage; ProfileStart(Stage); }
+	~CProfileScope() { ProfileStop(ScopeStage); }
+private:
+	int ScopeStage;
+};
+
+#if MODEL_PROFILE
+#define PROFILE_SCOPE(stage)	CProfileScope ProfileScope(stage)
+#else
+#define PROFILE_SCOPE(stage)
+#endif
+#endif
+
+#endif //__MODEL_PROFILE_H__
@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------
+// PrnCache.h:
+//   Shared packed PRN chip table cache declaration
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __PRN_CACHE_H__
+#define __PRN_CACHE_H__
+
+#include "CommonOps.h"
+
+#define PRN_CACHE_SIZE 512				// maximum number of code sequences cached
+#define PRN_CACHE_MAX_LENGTH 16384		// code longer than this is generated by CPrnGen
+
+// one primary code sequence generated by a PRN generator
+struct PrnChipTable
+{
+	// key of the table
+	int PrnType;						// 0/1 for general PRN, 2 for Weil PRN, 3 for memory PRN (same as PrnConfig>>30)
+	unsigned int PrnConfig;				// PrnConfig state word
+	unsigned int PolySettings[2];		// polynomial and length registers for general PRN
+	unsigned int *CodeMemory;			// code RAM for memory PRN, content treated as ROM
+
+	int Length;							// number of chips in one code round
+	unsigned long long *Chips;			// 1bit per chip, first chip at MSB, extra 64 chips at the end repeat from code start
+	unsigned int *StateWords;			// PRN state word and PRN count word after each chip (2 words per chip)
+};
+
+// chip pointer to a cached code sequence, replaces CPrnGen within correlation
+struct PrnChipCursor
+{
+	const PrnChipTable *Table;			// NULL means cached table not available
+	int ChipIndex;
+	int BitsLeft;
+	unsigned long long ChipWord;		// current chip at MSB
+
+	int Attach(const PrnChipTable *ChipTable, unsigned int *StateBuffer);
+	void Seek(int Index)
+	{
+		int WordIndex = Index >> 6, BitIndex = Index & 0x3f;
+
+		ChipIndex = Index;
+		ChipWord = BitIndex ? ((Table->Chips[WordIndex] << BitIndex) | (Table->Chips[WordIndex+1] >> (64 - BitIndex))) : Table->Chips[WordIndex];
+		BitsLeft = 64;
+	}
+	int GetCode() { return (int)(ChipWord >> 63); }
+	int ShiftCode()
+	{
+		int NewRound = 0;
+
+		ChipWord <<= 1;
+		if (++ChipIndex == Table->Length)
+		{
+			ChipIndex = 0;
+			NewRound = 1;
+		}
+		if (--BitsLeft == 0)
+			Seek(ChipIndex);
+		return NewRound;
+	}
+	void DumpState(unsigned int *StateBuffer)
+	{
+		StateBuffer[1] = Table->StateWords[ChipIndex*2];
+		StateBuffer[2] = Table->StateWords[ChipIndex*2+1];
+	}
+};
+
+class CPrnCache
+{
+public:
+	static const PrnChipTable *GetTable(int PrnType, unsigned int PrnConfig, const unsigned int PolySettings[2], unsigned int *CodeMemory);
+	static int GetChipIndex(const PrnChipTable *Table, unsigned int *StateBuffer);
+	static void Clear();
+
+private:
+	static PrnChipTable *BuildTable(int PrnType, unsigned int PrnConfig, const unsigned int PolySettings[2], unsigned int *CodeMemory);
+	static unsigned int HashKey(int PrnType, unsigned int PrnConfig, const unsigned int PolySettings[2], unsigned int *CodeMemory);
+
+	static PrnChipTable *Tables[PRN_CACHE_SIZE];
+	static int TableNumber;
+};
+
+#endif // __PRN_CACHE_H__
@@ -6,9 +6,17 @@
 //
 //----------------------------------------------------------------------
 
+#if !defined __RATE_ADAPTOR_H__
+#define __RATE_ADAPTOR_H__
+
 #include "CommonOps.h"
 
 #define CODE_RATE_FILTER_STAGE 6
+// number of input samples processed at a time in block mode
+#define RATE_ADAPTOR_BLOCK_SIZE 1024
+// block mode filters in 16bit, input larger than 4bit sign/magnitude goes to sample by sample process
+#define RATE_ADAPTOR_MAX_INPUT 15
+#define RATE_ADAPTOR_MAX_FILTER_INPUT (RATE_ADAPTOR_MAX_INPUT * 24)
 
 class CRateAdaptor
 {
@@ -20,13 +28,24 @@ public:
 	reg_uint CarrierNco;			// 32U
 	reg_uint CarrierFreq;			// 32U
 	reg_uint Threshold;				// ?U
+	int BlockMode;					// model only, 0 to process sample by sample as RTL does
 
 	void Reset();
 	int DoRateAdaptor(complex_int InputSignal[], int Length, unsigned char OutputSignal[]);
+	int DoRateAdaptorSerial(complex_int InputSignal[], int Length, unsigned char OutputSignal[]);
+	int DoRateAdaptorBlock(complex_int InputSignal[], int Length, unsigned char OutputSignal[]);
 	unsigned char Quant2Bit(complex_int Sample);
 
 	static const complex_int DownConvertTable[64];
 	static const int CodeRateFilterCoef[CODE_RATE_FILTER_STAGE/2];
 
 	complex_int CodeRateFilterBuffer[CODE_RATE_FILTER_STAGE];
+
+	// work buffers of block mode, down converted samples with CODE_RATE_FILTER_STAGE history samples ahead
+	S16 BlockDataI[RATE_ADAPTOR_BLOCK_SIZE+CODE_RATE_FILTER_STAGE];
+	S16 BlockDataQ[RATE_ADAPTOR_BLOCK_SIZE+CODE_RATE_FILTER_STAGE];
+	unsigned char BlockQuant[RATE_ADAPTOR_BLOCK_SIZE];
+	int BlockOutputPos[RATE_ADAPTOR_BLOCK_SIZE];
 };
+
+#endif //__RATE_ADAPTOR_H__
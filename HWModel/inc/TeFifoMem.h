@@ -16,6 +16,13 @@
 
 typedef void (*TriggerFunction)(int Index);
 
+// samples of one block in FIFO memory, second part is used when the block wraps around end of FIFO memory
+struct FifoSpan
+{
+	complex_int *Data[2];
+	int Length[2];
+};
+
 class CTeFifoMem
 {
 public:
@@ -28,7 +35,10 @@ public:
 	void RewindPointer();
 	void SkipBlock();
 	int WriteData(complex_int Data);
+	int WriteBlock(int Number, complex_int Data[]);
 	void ReadData(int &ReadNumber, complex_int Data[]);
+	void ReadBlock(int Number, complex_int Data[]);
+	int PeekSpan(FifoSpan &Span);
 	void LatchWriteAddress(int Source);
 	void SetFifoEnable(int Enable);
 	void SetTrigger(int SrcIndex);
@@ -64,6 +74,9 @@ public:
 
 	TriggerFunction TriggerCallback;
 	int FifoIndex;
+
+private:
+	void WriteSegment(int Number, complex_int Data[]);
 };
 
 #endif //__TE_FIFO_MEM_H__
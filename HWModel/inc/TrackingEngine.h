@@ -13,11 +13,40 @@
 #include "Correlator.h"
 #include "TeFifoMem.h"
 #include "NoiseCalc.h"
+#include "WorkerPool.h"
 
 #define PHYSICAL_CHANNEL_NUMBER 4
 #define LOGICAL_CHANNEL_NUMBER 32
 #define TE_BUFFER_SIZE (LOGICAL_CHANNEL_NUMBER * 128)
 
+// parallel mode of ProcessData, model only, no corresponding hardware register
+#define TE_PARALLEL_NONE	0	// process rounds of PHYSICAL_CHANNEL_NUMBER channels sequentially as RTL does
+#define TE_PARALLEL_ROUND	1	// each round of PHYSICAL_CHANNEL_NUMBER channels is one task for worker threads
+#define TE_PARALLEL_CHANNEL	2	// each logical channel is one task for worker threads
+
+// default number of samples fed to all channels in one step of wide mode
+#define TE_WIDE_CHUNK_SIZE	CORRELATOR_BLOCK_SIZE
+// depth of coherent data FIFO of one channel in one round
+#define TE_DUMP_FIFO_DEPTH	16
+
+// coherent data FIFO of one logical channel
+struct TeDumpFifo
+{
+	S16 DumpDataI[TE_DUMP_FIFO_DEPTH];
+	S16 DumpDataQ[TE_DUMP_FIFO_DEPTH];
+	int CorIndex[TE_DUMP_FIFO_DEPTH];
+	int DumpCount;
+};
+
+// register outputs of one logical channel, merged in channel order after all channels processed
+struct TeChannelResult
+{
+	int CohDataReady;
+	int OverwriteProtect;
+	unsigned int OverwriteProtectAddr;
+	unsigned int OverwriteProtectValue;
+};
+
 class CTeFifoMem;
 
 class CTrackingEngine
@@ -38,12 +67,35 @@ public:
 
 	int ProcessData();
 	int FindLeastIndex(unsigned int data);
+	void SetParallelMode(int Mode, int ThreadNumber);
+	void ProcessChannel(CCorrelator *pCorrelator, int ChannelIndex, FifoSpan &Span, TeChannelResult &Result);
+	void SaveDumpData(CCorrelator *pCorrelator, int ChannelIndex, TeDumpFifo &DumpFifo, TeChannelResult &Result);
+	void SetWideMode(int ChunkSize);
+	void ProcessWide(int ChannelNumber, int ChannelIndex[]);
+	void ProcessParallel(int ChannelNumber, int ChannelIndex[]);
+	static void ParallelTask(void *Param, int TaskIndex, int WorkerIndex);
 
 	unsigned int *TEBuffer;
 	CTeFifoMem *pTeFifo;
 	CCorrelator *Correlator[PHYSICAL_CHANNEL_NUMBER];
 	CNoiseCalc NoiseCalc;
 	complex_int *FifoData;
+	FifoSpan BlockSpan;					// block in TE FIFO used by parallel and wide mode
+	unsigned int *MemCodeBuffer;
+
+	// worker pool for parallel mode, each worker has its own correlator
+	int ParallelMode;
+	CWorkerPool *WorkerPool;
+	CCorrelator *WorkerCorrelator[MAX_WORKER_NUMBER];
+	int ParallelChannelNumber;
+	int ParallelChannelIndex[LOGICAL_CHANNEL_NUMBER];
+	TeChannelResult ChannelResult[LOGICAL_CHANNEL_NUMBER];
+
+	// wide mode, block read once and all channels correlated chunk by chunk, each channel has its own correlator
+	// 0 means rewind FIFO for each round of PHYSICAL_CHANNEL_NUMBER channels as RTL does
+	int WideChunkSize;
+	CCorrelator *WideCorrelator[LOGICAL_CHANNEL_NUMBER];
+	TeDumpFifo WideDumpFifo[LOGICAL_CHANNEL_NUMBER];
 };
 
 #endif //__TRACKING_ENGINE_H__
@@ -0,0 +1,50 @@
+//----------------------------------------------------------------------
+// WorkerPool.h:
+//   Fixed size worker thread pool declaration
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __WORKER_POOL_H__
+#define __WORKER_POOL_H__
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define MAX_WORKER_NUMBER 32
+
+// task function, TaskIndex in [0, TaskNumber), WorkerIndex in [0, WorkerNumber) identifies the executing thread
+typedef void (*WorkerTask)(void *Param, int TaskIndex, int WorkerIndex);
+
+class CWorkerPool
+{
+public:
+	CWorkerPool(int Number);
+	~CWorkerPool();
+
+	int GetWorkerNumber() { return WorkerNumber; }
+	void RunTasks(int TaskNumber, WorkerTask Task, void *Param);
+
+private:
+	static void WorkerThread(CWorkerPool *Pool, int WorkerIndex);
+	void ExecuteTasks(int WorkerIndex);
+
+	int WorkerNumber;				// number of workers including the calling thread as worker 0
+	std::thread *Threads[MAX_WORKER_NUMBER];
+	std::mutex Mutex;
+	std::condition_variable StartCondition;
+	std::condition_variable DoneCondition;
+
+	// current batch, guarded by Mutex
+	WorkerTask CurrentTask;
+	void *CurrentParam;
+	int TaskNumber;
+	int NextTask;
+	int BusyWorkers;
+	unsigned int Generation;		// increase for each batch to wake up workers
+	int Exiting;
+};
+
+#endif //__WORKER_POOL_H__
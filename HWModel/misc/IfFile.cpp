@@ -11,52 +11,334 @@
 #include <malloc.h>
 #include "IfFile.h"
 
+#if defined _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 CIfFile::CIfFile()
 {
+	int i;
+
 	fpIfFile = NULL;
+	MapData = NULL;
+#if defined _WIN32
+	FileHandle = INVALID_HANDLE_VALUE;
+	MapHandle = NULL;
+#endif
+	ReadBuffer = NULL;
+	ReadBufferSize = 0;
+	ReadStatus = IF_READ_OK;
+	SampleNumber = SampleIndex = 0;
+	ReplayLength = ReplayCount = 0;
+	PrefetchThread = NULL;
+	PrefetchBuffer = NULL;
+	PrefetchBlockSize = PrefetchBlockNumber = 0;
+	PrefetchIndex = 0;
+	PrefetchHead = PrefetchCount = 0;
+	PrefetchStatus = IF_READ_OK;
+	PrefetchExit = 0;
+
+	for (i = 0; i < 256; i ++)
+	{
+		DecodeTable[i].real = ((i & 0x70) >> 3) + 1;
+		if (i & 0x80)
+			DecodeTable[i].real = -DecodeTable[i].real;
+		DecodeTable[i].imag = ((i & 0x7) << 1) + 1;
+		if (i & 0x8)
+			DecodeTable[i].imag = -DecodeTable[i].imag;
+	}
 }
 
 CIfFile::~CIfFile()
 {
 	CloseIfFile();
+	free(ReadBuffer);
 }
 
 int CIfFile::OpenIfFile(char *FileName)
 {
+	CloseIfFile();
+	if (MapFile(FileName))
+		return 1;
+
+	// fall back to stream read
 	fpIfFile = fopen(FileName, "rb");
-	return (fpIfFile != NULL);
+	if (fpIfFile == NULL)
+		return 0;
+#if defined _WIN32
+	_fseeki64(fpIfFile, 0, SEEK_END);
+	SampleNumber = _ftelli64(fpIfFile);
+#else
+	fseeko(fpIfFile, 0, SEEK_END);
+	SampleNumber = ftello(fpIfFile);
+#endif
+	rewind(fpIfFile);
+	return 1;
 }
 
 void CIfFile::CloseIfFile()
 {
+	StopPrefetch();
+	UnmapFile();
 	if (fpIfFile)
 		fclose(fpIfFile);
 	fpIfFile = NULL;
+	SampleNumber = SampleIndex = 0;
+	ReplayCount = 0;
 }
 
 // return 1 for read success
-// return 0 for file end
+// return 0 for file end or read error, GetReadStatus() tells which
 int CIfFile::ReadFile(int Count, complex_int Data[])
+{
+	if (PrefetchThread)
+	{
+		if (Count == PrefetchBlockSize)
+			return ReadPrefetch(Data);
+		StopPrefetch();		// block size changed, go back to direct read
+	}
+	ReadStatus = ReadBlock(Count, Data);
+
+	return (ReadStatus == IF_READ_OK);
+}
+
+// read and decode Count samples from SampleIndex, return read status
+int CIfFile::ReadBlock(int Count, complex_int Data[])
 {
 	int i;
 	unsigned char *pBuf;
 
-	if (fpIfFile == NULL)
+	if (MapData == NULL && fpIfFile == NULL)
+		return IF_READ_ERROR;
+	if (ReplayLength > 0)
+	{
+		if (ReplayCount + Count > ReplayLength)
+			return IF_READ_END;
+		if (SampleIndex + Count > SampleNumber && Count <= SampleNumber && !SetPosition(0))
+			return IF_READ_ERROR;
+	}
+	if (SampleIndex + Count > SampleNumber)
+		return IF_READ_END;
+
+	if (MapData)
+		pBuf = MapData + SampleIndex;
+	else if (fpIfFile)
+	{
+		if (Count > ReadBufferSize)
+		{
+			free(ReadBuffer);
+			ReadBuffer = (unsigned char *)malloc(sizeof(char) * Count);
+			ReadBufferSize = Count;
+		}
+		pBuf = ReadBuffer;
+		if ((int)fread(pBuf, 1, Count, fpIfFile) != Count)
+			return ferror(fpIfFile) ? IF_READ_ERROR : IF_READ_END;
+	}
+
+	for (i = 0; i < Count; i ++)
+		Data[i] = DecodeTable[pBuf[i]];
+	SampleIndex += Count;
+	ReplayCount += Count;
+
+	return IF_READ_OK;
+}
+
+// move to sample at SampleIndex (sample count from file start)
+// return 0 if index out of file range
+int CIfFile::Seek(long long Index)
+{
+	StopPrefetch();
+	if (Index < 0 || Index > SampleNumber)
 		return 0;
+	return SetPosition(Index);
+}
 
-	pBuf = (unsigned char *)malloc(sizeof(char) * Count);
-	if ((fread(pBuf, 1, Count, fpIfFile)) != Count)
+// move file position without stopping prefetch, also used by prefetch thread to wrap at file end
+int CIfFile::SetPosition(long long Index)
+{
+	if (MapData == NULL)
+	{
+		if (fpIfFile == NULL)
 			return 0;
-	for (i = 0; i < Count; i ++)
+#if defined _WIN32
+		if (_fseeki64(fpIfFile, Index, SEEK_SET) != 0)
+#else
+		if (fseeko(fpIfFile, (off_t)Index, SEEK_SET) != 0)
+#endif
+			return 0;
+	}
+	SampleIndex = Index;
+
+	return 1;
+}
+
+// map whole file to memory, return 0 if file cannot be mapped
+int CIfFile::MapFile(char *FileName)
+{
+#if defined _WIN32
+	LARGE_INTEGER FileSize;
+
+	FileHandle = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (FileHandle == INVALID_HANDLE_VALUE)
+		return 0;
+	if (!GetFileSizeEx(FileHandle, &FileSize) || FileSize.QuadPart == 0 || (MapHandle = CreateFileMappingA(FileHandle, NULL, PAGE_READONLY, 0, 0, NULL)) == NULL)
 	{
-		Data[i].real = ((pBuf[i] & 0x70) >> 3) + 1;
-		if (pBuf[i] & 0x80)
-			Data[i].real = -Data[i].real;
-		Data[i].imag = ((pBuf[i] & 0x7) << 1) + 1;
-		if (pBuf[i] & 0x8)
-			Data[i].imag = -Data[i].imag;
+		UnmapFile();
+		return 0;
 	}
-	free(pBuf);
+	if ((MapData = (unsigned char *)MapViewOfFile(MapHandle, FILE_MAP_READ, 0, 0, 0)) == NULL)
+	{
+		UnmapFile();
+		return 0;
+	}
+	SampleNumber = FileSize.QuadPart;
+#else
+	int fd;
+	struct stat FileStat;
+	void *Address;
+
+	if ((fd = open(FileName, O_RDONLY)) < 0)
+		return 0;
+	if (fstat(fd, &FileStat) != 0 || FileStat.st_size == 0)
+	{
+		close(fd);
+		return 0;
+	}
+	Address = mmap(NULL, (size_t)FileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);	// mapping is kept after file closed
+	if (Address == MAP_FAILED)
+		return 0;
+	madvise(Address, (size_t)FileStat.st_size, MADV_SEQUENTIAL);
+	MapData = (unsigned char *)Address;
+	SampleNumber = FileStat.st_size;
+#endif
+	SampleIndex = 0;
+
+	return 1;
+}
+
+void CIfFile::UnmapFile()
+{
+#if defined _WIN32
+	if (MapData)
+		UnmapViewOfFile(MapData);
+	if (MapHandle)
+		CloseHandle(MapHandle);
+	if (FileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(FileHandle);
+	MapHandle = NULL;
+	FileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (MapData)
+		munmap(MapData, (size_t)SampleNumber);
+#endif
+	MapData = NULL;
+}
+
+// start thread reading BlockNumber blocks of BlockSize samples ahead, ReadFile() with other size stops prefetch
+// return 0 if file not opened
+int CIfFile::StartPrefetch(int BlockSize, int BlockNumber)
+{
+	StopPrefetch();
+	if (MapData == NULL && fpIfFile == NULL)
+		return 0;
+	if (BlockNumber < 2)
+		BlockNumber = 2;
+	if (BlockNumber > IF_MAX_PREFETCH_BLOCK)
+		BlockNumber = IF_MAX_PREFETCH_BLOCK;
+
+	PrefetchBuffer = (complex_int *)malloc(BlockSize * BlockNumber * sizeof(complex_int));
+	PrefetchBlockSize = BlockSize;
+	PrefetchBlockNumber = BlockNumber;
+	PrefetchIndex = SampleIndex;
+	PrefetchHead = PrefetchCount = 0;
+	PrefetchStatus = IF_READ_OK;
+	PrefetchExit = 0;
+	PrefetchThread = new std::thread(PrefetchLoop, this);
 
 	return 1;
 }
+
+// stop prefetch thread and move file position back to the first sample not returned to reader
+void CIfFile::StopPrefetch()
+{
+	if (PrefetchThread == NULL)
+		return;
+	{
+		std::lock_guard<std::mutex> Lock(PrefetchMutex);
+		PrefetchExit = 1;
+	}
+	SlotFree.notify_one();
+	PrefetchThread->join();
+	delete PrefetchThread;
+	PrefetchThread = NULL;
+	free(PrefetchBuffer);
+	PrefetchBuffer = NULL;
+
+	ReplayCount -= (long long)PrefetchCount * PrefetchBlockSize;	// blocks read ahead are replayed again
+	Seek(PrefetchIndex);
+}
+
+int CIfFile::ReadPrefetch(complex_int Data[])
+{
+	std::unique_lock<std::mutex> Lock(PrefetchMutex);
+	int Block;
+
+	while (PrefetchCount == 0 && PrefetchStatus == IF_READ_OK)
+		BlockReady.wait(Lock);
+	if (PrefetchCount == 0)		// all blocks before end of file or read error returned
+	{
+		ReadStatus = PrefetchStatus;
+		return 0;
+	}
+	Block = PrefetchHead;
+	Lock.unlock();
+
+	// prefetch thread does not write this block before PrefetchCount decreases
+	memcpy(Data, PrefetchBuffer + Block * PrefetchBlockSize, PrefetchBlockSize * sizeof(complex_int));
+	PrefetchIndex += PrefetchBlockSize;
+	if (ReplayLength > 0 && PrefetchIndex + PrefetchBlockSize > SampleNumber && PrefetchBlockSize <= SampleNumber)
+		PrefetchIndex = 0;		// same wrap as ReadBlock()
+
+	Lock.lock();
+	PrefetchHead = (PrefetchHead + 1) % PrefetchBlockNumber;
+	PrefetchCount --;
+	Lock.unlock();
+	SlotFree.notify_one();
+	ReadStatus = IF_READ_OK;
+
+	return 1;
+}
+
+// only prefetch thread accesses file until it exits
+void CIfFile::PrefetchLoop(CIfFile *File)
+{
+	std::unique_lock<std::mutex> Lock(File->PrefetchMutex);
+	int Block, Status;
+
+	while (1)
+	{
+		while (File->PrefetchCount == File->PrefetchBlockNumber && !File->PrefetchExit)
+			File->SlotFree.wait(Lock);
+		if (File->PrefetchExit)
+			break;
+		Block = (File->PrefetchHead + File->PrefetchCount) % File->PrefetchBlockNumber;
+		Lock.unlock();
+
+		Status = File->ReadBlock(File->PrefetchBlockSize, File->PrefetchBuffer + Block * File->PrefetchBlockSize);
+
+		Lock.lock();
+		if (Status == IF_READ_OK)
+			File->PrefetchCount ++;
+		else
+			File->PrefetchStatus = Status;
+		File->BlockReady.notify_one();
+		if (Status != IF_READ_OK)
+			break;
+	}
+}
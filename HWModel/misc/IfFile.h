@@ -10,8 +10,18 @@
 #define __IF_FILE_H__
 
 #include <stdio.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "CommonOps.h"
 
+// status of last read
+#define IF_READ_OK		0
+#define IF_READ_END		1	// not enough samples left in file
+#define IF_READ_ERROR	2	// file not opened or read fail
+
+#define IF_MAX_PREFETCH_BLOCK 64
+
 class CIfFile
 {
 public:
@@ -22,7 +32,54 @@ public:
 
 	FILE *fpIfFile;
 	
-	int CIfFile::ReadFile(int Count, complex_int Data[]);
+	int ReadFile(int Count, complex_int Data[]);
+	int Seek(long long Index);
+	void SetReplayLength(long long Length) { ReplayLength = Length; ReplayCount = 0; }	// call before read or prefetch
+	long long GetSampleNumber() { return SampleNumber; }
+	long long GetSampleIndex() { return PrefetchThread ? PrefetchIndex : SampleIndex; }
+	int GetReadStatus() { return ReadStatus; }
+	int StartPrefetch(int BlockSize, int BlockNumber);
+	void StopPrefetch();
+
+private:
+	int MapFile(char *FileName);
+	void UnmapFile();
+	int ReadBlock(int Count, complex_int Data[]);
+	int SetPosition(long long Index);
+	int ReadPrefetch(complex_int Data[]);
+	static void PrefetchLoop(CIfFile *File);
+
+	// one byte for each sample, 4bit sign/magnitude I at bit4~7 and Q at bit0~3
+	complex_int DecodeTable[256];
+	long long SampleNumber;		// total number of samples in file
+	long long SampleIndex;		// index of next sample to read
+	// file wraps to start until ReplayLength samples read (incomplete block at file end skipped), 0 to read file once
+	long long ReplayLength;
+	long long ReplayCount;		// samples read since SetReplayLength()
+	// whole file mapped to memory if system supports, otherwise read through fpIfFile
+	unsigned char *MapData;
+#if defined _WIN32
+	void *FileHandle;			// HANDLE of file and file mapping object
+	void *MapHandle;
+#endif
+	unsigned char *ReadBuffer;	// used when file not mapped
+	int ReadBufferSize;
+	int ReadStatus;
+
+	// prefetch thread reads and decodes blocks into ring buffer ahead of ReadFile()
+	std::thread *PrefetchThread;
+	std::mutex PrefetchMutex;
+	std::condition_variable BlockReady;		// prefetch thread to reader
+	std::condition_variable SlotFree;		// reader to prefetch thread
+	complex_int *PrefetchBuffer;
+	int PrefetchBlockSize;
+	int PrefetchBlockNumber;
+	long long PrefetchIndex;	// index of next sample to return to reader
+	// guarded by PrefetchMutex
+	int PrefetchHead;			// next block to return to reader
+	int PrefetchCount;			// number of blocks ready
+	int PrefetchStatus;			// status of read after last ready block
+	int PrefetchExit;
 };
 
 #endif //__IF_FILE_H__
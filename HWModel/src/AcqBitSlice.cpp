@@ -0,0 +1,154 @@
+//----------------------------------------------------------------------
+// AcqBitSlice.cpp:
+//   Bit sliced match filter for acquisition engine implementation
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <string.h>
+
+#include "AcqBitSlice.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define BITSLICE_X86
+#if defined _MSC_VER
+#include <intrin.h>
+#define BITSLICE_TARGET
+#define BITSLICE_INLINE __forceinline
+#if defined _M_X64
+#define POPCOUNT_HW(data) ((int)__popcnt64(data))
+#else
+#define POPCOUNT_HW(data) ((int)__popcnt((unsigned int)(data)) + (int)__popcnt((unsigned int)((data) >> 32)))
+#endif
+#else
+#define BITSLICE_TARGET __attribute__((target("popcnt")))
+#define BITSLICE_INLINE inline __attribute__((always_inline))
+#define POPCOUNT_HW(data) __builtin_popcountll(data)
+#endif
+#else
+#define BITSLICE_INLINE inline
+#endif
+
+static BITSLICE_INLINE int PopCount64(unsigned long long data)
+{
+	data = data - ((data >> 1) & 0x5555555555555555ULL);
+	data = (data & 0x3333333333333333ULL) + ((data >> 2) & 0x3333333333333333ULL);
+	data = (data + (data >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return (int)((data * 0x0101010101010101ULL) >> 56);
+}
+
+// for each phase i, count samples at position i+2t with bit b set and chip t is 1
+// the weighted sum over all bits gives sum of samples with chip 1, so
+// CorResult = sum(sample) - 2 * sum(sample with chip 1) - CodeSum
+static BITSLICE_INLINE void BitSliceSum(const unsigned long long *Planes, const unsigned long long *ShiftedCode, int CodeWords, const int *WindowSum, int CodeLength, int CodeSum, int PhaseCount, complex_int CorResult[], int HwPopcount)
+{
+	int i, k, bit, iq, Parity, Offset, Count, Sum, Result[2];
+	const unsigned long long *Plane, *Code;
+
+	for (i = 0; i < PhaseCount; i ++)
+	{
+		Parity = i & 1;
+		Offset = i >> 1;
+		Code = ShiftedCode + (Offset & 0x3f) * BITSLICE_CODE_WORDS;
+		for (iq = 0; iq < 2; iq ++)
+		{
+			Sum = 0;
+			for (bit = 0; bit < BITSLICE_SAMPLE_BITS; bit ++)
+			{
+				Plane = Planes + ((Parity * 2 + iq) * BITSLICE_SAMPLE_BITS + bit) * BITSLICE_PLANE_WORDS + (Offset >> 6);
+				Count = 0;
+				for (k = 0; k < CodeWords; k ++)
+#if defined BITSLICE_X86
+					Count += HwPopcount ? POPCOUNT_HW(Plane[k] & Code[k]) : PopCount64(Plane[k] & Code[k]);
+#else
+					Count += PopCount64(Plane[k] & Code[k]);
+#endif
+				// MSB has negative weight in two's complement
+				Sum += (bit == BITSLICE_SAMPLE_BITS - 1) ? -(Count << bit) : (Count << bit);
+			}
+			Result[iq] = WindowSum[(Parity * 2 + iq) * (BITSLICE_MAX_SAMPLES/2+1) + Offset + CodeLength] - WindowSum[(Parity * 2 + iq) * (BITSLICE_MAX_SAMPLES/2+1) + Offset] - 2 * Sum - CodeSum;
+		}
+		CorResult[i] = complex_int(Result[0], Result[1]);
+	}
+}
+
+static void BitSliceGeneric(const unsigned long long *Planes, const unsigned long long *ShiftedCode, int CodeWords, const int *WindowSum, int CodeLength, int CodeSum, int PhaseCount, complex_int CorResult[])
+{
+	BitSliceSum(Planes, ShiftedCode, CodeWords, WindowSum, CodeLength, CodeSum, PhaseCount, CorResult, 0);
+}
+
+#if defined BITSLICE_X86
+BITSLICE_TARGET static void BitSlicePopcnt(const unsigned long long *Planes, const unsigned long long *ShiftedCode, int CodeWords, const int *WindowSum, int CodeLength, int CodeSum, int PhaseCount, complex_int CorResult[])
+{
+	BitSliceSum(Planes, ShiftedCode, CodeWords, WindowSum, CodeLength, CodeSum, PhaseCount, CorResult, 1);
+}
+
+static int CpuHasPopcnt()
+{
+#if defined _MSC_VER
+	int CpuInfo[4];
+
+	__cpuid(CpuInfo, 1);
+	return (CpuInfo[2] & (1 << 23)) ? 1 : 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("popcnt") ? 1 : 0;
+#endif
+}
+#endif
+
+CAcqBitSlice::CAcqBitSlice()
+{
+#if defined BITSLICE_X86
+	Kernel = CpuHasPopcnt() ? BitSlicePopcnt : BitSliceGeneric;
+#else
+	Kernel = BitSliceGeneric;
+#endif
+}
+
+CAcqBitSlice::~CAcqBitSlice()
+{
+}
+
+// calculate CorResult[i] = sum(Code[t] ? ~Samples[i+2t] : Samples[i+2t]) for t = 0 to CodeLength-1
+// same as CAcqEngine::MatchFilterCore(), samples must be within 6bit signed range
+void CAcqBitSlice::MatchFilter(const complex_int Samples[], const unsigned int Code[], int CodeLength, int PhaseCount, complex_int CorResult[])
+{
+	int i, k, bit, iq, Parity, Position, Value, CodeSum = 0, CodeWords;
+	int SampleNumber = PhaseCount + CodeLength * 2 - 2;
+	unsigned long long PackedCode[BITSLICE_CODE_WORDS];
+
+	// split samples at even and odd position into bit planes
+	memset(Planes, 0, sizeof(Planes));
+	for (iq = 0; iq < 4; iq ++)
+		WindowSum[iq >> 1][iq & 1][0] = 0;
+	for (i = 0; i < SampleNumber; i ++)
+	{
+		Parity = i & 1;
+		Position = i >> 1;
+		for (iq = 0; iq < 2; iq ++)
+		{
+			Value = iq ? Samples[i].imag : Samples[i].real;
+			WindowSum[Parity][iq][Position+1] = WindowSum[Parity][iq][Position] + Value;
+			for (bit = 0; bit < BITSLICE_SAMPLE_BITS; bit ++)
+				if (Value & (1 << bit))
+					Planes[Parity][iq][bit][Position >> 6] |= 1ULL << (Position & 0x3f);
+		}
+	}
+
+	// pack code and shift to all 64 bit offsets
+	memset(PackedCode, 0, sizeof(PackedCode));
+	for (i = 0; i < CodeLength; i ++)
+		if (Code[i])
+		{
+			PackedCode[i >> 6] |= 1ULL << (i & 0x3f);
+			CodeSum ++;
+		}
+	CodeWords = (CodeLength + 63) / 64 + 1;
+	for (i = 0; i < 64; i ++)
+		for (k = 0; k < CodeWords; k ++)
+			ShiftedCode[i][k] = (PackedCode[k] << i) | ((k > 0 && i > 0) ? (PackedCode[k-1] >> (64 - i)) : 0);
+
+	Kernel(&Planes[0][0][0][0], &ShiftedCode[0][0], CodeWords, &WindowSum[0][0][0], CodeLength, CodeSum, PhaseCount, CorResult);
+}
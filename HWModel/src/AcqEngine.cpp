@@ -9,22 +9,26 @@
 #include <stdio.h>
 #include <malloc.h>
 #include <string.h>
+#if defined _MSC_VER
 #include <intrin.h>
+#endif
 
 #include "AcqEngine.h"
+#include "ModelProfile.h"
 
 complex_exp10::complex_exp10(complex_int data)
 {
 	int real_exp, imag_exp;
 
+	// set LSB because __builtin_clz(0) is undefined in GCC/Clang, exp not positive either way
 	if (data.real >= 0)
-		real_exp = 23 - __builtin_clz(data.real);
+		real_exp = 23 - __builtin_clz(data.real | 1);
 	else
-		real_exp = 23 - __builtin_clz(~data.real);
+		real_exp = 23 - __builtin_clz(~data.real | 1);
 	if (data.imag >= 0)
-		imag_exp = 23 - __builtin_clz(data.imag);
+		imag_exp = 23 - __builtin_clz(data.imag | 1);
 	else
-		imag_exp = 23 - __builtin_clz(~data.imag);
+		imag_exp = 23 - __builtin_clz(~data.imag | 1);
 	this->exp = (real_exp > imag_exp) ? real_exp : imag_exp;
 	if (this->exp > 0)
 	{
@@ -220,134 +224,134 @@ const unsigned int CAcqEngine::GpsInit[32+19] = {
 };
 
 const unsigned int CAcqEngine::B1CInit[63] = {
-	(8 << 28) +  796 + (( 7575 - 1) << 14),	// for PRN01
-	(8 << 28) +  156 + (( 2369 - 1) << 14),	// for PRN02
-	(8 << 28) + 4198 + (( 5688 - 1) << 14),	// for PRN03
-	(8 << 28) + 3941 + ((  539 - 1) << 14),	// for PRN04
-	(8 << 28) + 1374 + (( 2270 - 1) << 14),	// for PRN05
-	(8 << 28) + 1338 + (( 7306 - 1) << 14),	// for PRN06
-	(8 << 28) + 1833 + (( 6457 - 1) << 14),	// for PRN07
-	(8 << 28) + 2521 + (( 6254 - 1) << 14),	// for PRN08
-	(8 << 28) + 3175 + (( 5644 - 1) << 14),	// for PRN09
-	(8 << 28) +  168 + (( 7119 - 1) << 14),	// for PRN10
-	(8 << 28) + 2715 + (( 1402 - 1) << 14),	// for PRN11
-	(8 << 28) + 4408 + (( 5557 - 1) << 14),	// for PRN12
-	(8 << 28) + 3160 + (( 5764 - 1) << 14),	// for PRN13
-	(8 << 28) + 2796 + (( 1073 - 1) << 14),	// for PRN14
-	(8 << 28) +  459 + (( 7001 - 1) << 14),	// for PRN15
-	(8 << 28) + 3594 + (( 5910 - 1) << 14),	// for PRN16
-	(8 << 28) + 4813 + ((10060 - 1) << 14),	// for PRN17
-	(8 << 28) +  586 + (( 2710 - 1) << 14),	// for PRN18
-	(8 << 28) + 1428 + (( 1546 - 1) << 14),	// for PRN19
-	(8 << 28) + 2371 + (( 6887 - 1) << 14),	// for PRN20
-	(8 << 28) + 2285 + (( 1883 - 1) << 14),	// for PRN21
-	(8 << 28) + 3377 + (( 5613 - 1) << 14),	// for PRN22
-	(8 << 28) + 4965 + (( 5062 - 1) << 14),	// for PRN23
-	(8 << 28) + 3779 + (( 1038 - 1) << 14),	// for PRN24
-	(8 << 28) + 4547 + ((10170 - 1) << 14),	// for PRN25
-	(8 << 28) + 1646 + (( 6484 - 1) << 14),	// for PRN26
-	(8 << 28) + 1430 + (( 1718 - 1) << 14),	// for PRN27
-	(8 << 28) +  607 + (( 2535 - 1) << 14),	// for PRN28
-	(8 << 28) + 2118 + (( 1158 - 1) << 14),	// for PRN29
-	(8 << 28) + 4709 + (( 526  - 1) << 14),	// for PRN30
-	(8 << 28) + 1149 + (( 7331 - 1) << 14),	// for PRN31
-	(8 << 28) + 3283 + (( 5844 - 1) << 14),	// for PRN32
-	(8 << 28) + 2473 + (( 6423 - 1) << 14),	// for PRN33
-	(8 << 28) + 1006 + (( 6968 - 1) << 14),	// for PRN34
-	(8 << 28) + 3670 + (( 1280 - 1) << 14),	// for PRN35
-	(8 << 28) + 1817 + (( 1838 - 1) << 14),	// for PRN36
-	(8 << 28) +  771 + (( 1989 - 1) << 14),	// for PRN37
-	(8 << 28) + 2173 + (( 6468 - 1) << 14),	// for PRN38
-	(8 << 28) +  740 + (( 2091 - 1) << 14),	// for PRN39
-	(8 << 28) + 1433 + (( 1581 - 1) << 14),	// for PRN40
-	(8 << 28) + 2458 + (( 1453 - 1) << 14),	// for PRN41
-	(8 << 28) + 3459 + (( 6252 - 1) << 14),	// for PRN42
-	(8 << 28) + 2155 + (( 7122 - 1) << 14),	// for PRN43
-	(8 << 28) + 1205 + (( 7711 - 1) << 14),	// for PRN44
-	(8 << 28) +  413 + (( 7216 - 1) << 14),	// for PRN45
-	(8 << 28) +  874 + (( 2113 - 1) << 14),	// for PRN46
-	(8 << 28) + 2463 + (( 1095 - 1) << 14),	// for PRN47
-	(8 << 28) + 1106 + (( 1628 - 1) << 14),	// for PRN48
-	(8 << 28) + 1590 + (( 1713 - 1) << 14),	// for PRN49
-	(8 << 28) + 3873 + (( 6102 - 1) << 14),	// for PRN50
-	(8 << 28) + 4026 + (( 6123 - 1) << 14),	// for PRN51
-	(8 << 28) + 4272 + (( 6070 - 1) << 14),	// for PRN52
-	(8 << 28) + 3556 + (( 1115 - 1) << 14),	// for PRN53
-	(8 << 28) +  128 + (( 8047 - 1) << 14),	// for PRN54
-	(8 << 28) + 1200 + (( 6795 - 1) << 14),	// for PRN55
-	(8 << 28) +  130 + (( 2575 - 1) << 14),	// for PRN56
-	(8 << 28) + 4494 + ((   53 - 1) << 14),	// for PRN57
-	(8 << 28) + 1871 + (( 1729 - 1) << 14),	// for PRN58
-	(8 << 28) + 3073 + (( 6388 - 1) << 14),	// for PRN59
-	(8 << 28) + 4386 + ((  682 - 1) << 14),	// for PRN60
-	(8 << 28) + 4098 + (( 5565 - 1) << 14),	// for PRN61
-	(8 << 28) + 1923 + (( 7160 - 1) << 14),	// for PRN62
-	(8 << 28) + 1176 + (( 2277 - 1) << 14),	// for PRN63
+	(8U << 28) +  796 + (( 7575 - 1) << 14),	// for PRN01
+	(8U << 28) +  156 + (( 2369 - 1) << 14),	// for PRN02
+	(8U << 28) + 4198 + (( 5688 - 1) << 14),	// for PRN03
+	(8U << 28) + 3941 + ((  539 - 1) << 14),	// for PRN04
+	(8U << 28) + 1374 + (( 2270 - 1) << 14),	// for PRN05
+	(8U << 28) + 1338 + (( 7306 - 1) << 14),	// for PRN06
+	(8U << 28) + 1833 + (( 6457 - 1) << 14),	// for PRN07
+	(8U << 28) + 2521 + (( 6254 - 1) << 14),	// for PRN08
+	(8U << 28) + 3175 + (( 5644 - 1) << 14),	// for PRN09
+	(8U << 28) +  168 + (( 7119 - 1) << 14),	// for PRN10
+	(8U << 28) + 2715 + (( 1402 - 1) << 14),	// for PRN11
+	(8U << 28) + 4408 + (( 5557 - 1) << 14),	// for PRN12
+	(8U << 28) + 3160 + (( 5764 - 1) << 14),	// for PRN13
+	(8U << 28) + 2796 + (( 1073 - 1) << 14),	// for PRN14
+	(8U << 28) +  459 + (( 7001 - 1) << 14),	// for PRN15
+	(8U << 28) + 3594 + (( 5910 - 1) << 14),	// for PRN16
+	(8U << 28) + 4813 + ((10060 - 1) << 14),	// for PRN17
+	(8U << 28) +  586 + (( 2710 - 1) << 14),	// for PRN18
+	(8U << 28) + 1428 + (( 1546 - 1) << 14),	// for PRN19
+	(8U << 28) + 2371 + (( 6887 - 1) << 14),	// for PRN20
+	(8U << 28) + 2285 + (( 1883 - 1) << 14),	// for PRN21
+	(8U << 28) + 3377 + (( 5613 - 1) << 14),	// for PRN22
+	(8U << 28) + 4965 + (( 5062 - 1) << 14),	// for PRN23
+	(8U << 28) + 3779 + (( 1038 - 1) << 14),	// for PRN24
+	(8U << 28) + 4547 + ((10170 - 1) << 14),	// for PRN25
+	(8U << 28) + 1646 + (( 6484 - 1) << 14),	// for PRN26
+	(8U << 28) + 1430 + (( 1718 - 1) << 14),	// for PRN27
+	(8U << 28) +  607 + (( 2535 - 1) << 14),	// for PRN28
+	(8U << 28) + 2118 + (( 1158 - 1) << 14),	// for PRN29
+	(8U << 28) + 4709 + (( 526  - 1) << 14),	// for PRN30
+	(8U << 28) + 1149 + (( 7331 - 1) << 14),	// for PRN31
+	(8U << 28) + 3283 + (( 5844 - 1) << 14),	// for PRN32
+	(8U << 28) + 2473 + (( 6423 - 1) << 14),	// for PRN33
+	(8U << 28) + 1006 + (( 6968 - 1) << 14),	// for PRN34
+	(8U << 28) + 3670 + (( 1280 - 1) << 14),	// for PRN35
+	(8U << 28) + 1817 + (( 1838 - 1) << 14),	// for PRN36
+	(8U << 28) +  771 + (( 1989 - 1) << 14),	// for PRN37
+	(8U << 28) + 2173 + (( 6468 - 1) << 14),	// for PRN38
+	(8U << 28) +  740 + (( 2091 - 1) << 14),	// for PRN39
+	(8U << 28) + 1433 + (( 1581 - 1) << 14),	// for PRN40
+	(8U << 28) + 2458 + (( 1453 - 1) << 14),	// for PRN41
+	(8U << 28) + 3459 + (( 6252 - 1) << 14),	// for PRN42
+	(8U << 28) + 2155 + (( 7122 - 1) << 14),	// for PRN43
+	(8U << 28) + 1205 + (( 7711 - 1) << 14),	// for PRN44
+	(8U << 28) +  413 + (( 7216 - 1) << 14),	// for PRN45
+	(8U << 28) +  874 + (( 2113 - 1) << 14),	// for PRN46
+	(8U << 28) + 2463 + (( 1095 - 1) << 14),	// for PRN47
+	(8U << 28) + 1106 + (( 1628 - 1) << 14),	// for PRN48
+	(8U << 28) + 1590 + (( 1713 - 1) << 14),	// for PRN49
+	(8U << 28) + 3873 + (( 6102 - 1) << 14),	// for PRN50
+	(8U << 28) + 4026 + (( 6123 - 1) << 14),	// for PRN51
+	(8U << 28) + 4272 + (( 6070 - 1) << 14),	// for PRN52
+	(8U << 28) + 3556 + (( 1115 - 1) << 14),	// for PRN53
+	(8U << 28) +  128 + (( 8047 - 1) << 14),	// for PRN54
+	(8U << 28) + 1200 + (( 6795 - 1) << 14),	// for PRN55
+	(8U << 28) +  130 + (( 2575 - 1) << 14),	// for PRN56
+	(8U << 28) + 4494 + ((   53 - 1) << 14),	// for PRN57
+	(8U << 28) + 1871 + (( 1729 - 1) << 14),	// for PRN58
+	(8U << 28) + 3073 + (( 6388 - 1) << 14),	// for PRN59
+	(8U << 28) + 4386 + ((  682 - 1) << 14),	// for PRN60
+	(8U << 28) + 4098 + (( 5565 - 1) << 14),	// for PRN61
+	(8U << 28) + 1923 + (( 7160 - 1) << 14),	// for PRN62
+	(8U << 28) + 1176 + (( 2277 - 1) << 14),	// for PRN63
 };
 const unsigned int CAcqEngine::L1CInit[63] = {
-	(10 << 28) + 5097 + ((  181 - 1) << 14),	// for PRN01
-	(10 << 28) + 5110 + ((  359 - 1) << 14),	// for PRN02
-	(10 << 28) + 5079 + ((   72 - 1) << 14),	// for PRN03
-	(10 << 28) + 4403 + (( 1110 - 1) << 14),	// for PRN04
-	(10 << 28) + 4121 + (( 1480 - 1) << 14),	// for PRN05
-	(10 << 28) + 5043 + (( 5034 - 1) << 14),	// for PRN06
-	(10 << 28) + 5042 + (( 4622 - 1) << 14),	// for PRN07
-	(10 << 28) + 5104 + ((    1 - 1) << 14),	// for PRN08
-	(10 << 28) + 4940 + (( 4547 - 1) << 14),	// for PRN09
-	(10 << 28) + 5035 + ((  826 - 1) << 14),	// for PRN10
-	(10 << 28) + 4372 + (( 6284 - 1) << 14),	// for PRN11
-	(10 << 28) + 5064 + (( 4195 - 1) << 14),	// for PRN12
-	(10 << 28) + 5084 + ((  368 - 1) << 14),	// for PRN13
-	(10 << 28) + 5048 + ((    1 - 1) << 14),	// for PRN14
-	(10 << 28) + 4950 + (( 4796 - 1) << 14),	// for PRN15
-	(10 << 28) + 5019 + ((  523 - 1) << 14),	// for PRN16
-	(10 << 28) + 5076 + ((  151 - 1) << 14),	// for PRN17
-	(10 << 28) + 3736 + ((  713 - 1) << 14),	// for PRN18
-	(10 << 28) + 4993 + (( 9850 - 1) << 14),	// for PRN19
-	(10 << 28) + 5060 + (( 5734 - 1) << 14),	// for PRN20
-	(10 << 28) + 5061 + ((   34 - 1) << 14),	// for PRN21
-	(10 << 28) + 5096 + (( 6142 - 1) << 14),	// for PRN22
-	(10 << 28) + 4983 + ((  190 - 1) << 14),	// for PRN23
-	(10 << 28) + 4783 + ((  644 - 1) << 14),	// for PRN24
-	(10 << 28) + 4991 + ((  467 - 1) << 14),	// for PRN25
-	(10 << 28) + 4815 + (( 5384 - 1) << 14),	// for PRN26
-	(10 << 28) + 4443 + ((  801 - 1) << 14),	// for PRN27
-	(10 << 28) + 4769 + ((  594 - 1) << 14),	// for PRN28
-	(10 << 28) + 4879 + (( 4450 - 1) << 14),	// for PRN29
-	(10 << 28) + 4894 + (( 9437 - 1) << 14),	// for PRN30
-	(10 << 28) + 4985 + (( 4307 - 1) << 14),	// for PRN31
-	(10 << 28) + 5056 + (( 5906 - 1) << 14),	// for PRN32
-	(10 << 28) + 4921 + ((  378 - 1) << 14),	// for PRN33
-	(10 << 28) + 5036 + (( 9448 - 1) << 14),	// for PRN34
-	(10 << 28) + 4812 + (( 9432 - 1) << 14),	// for PRN35
-	(10 << 28) + 4838 + (( 5849 - 1) << 14),	// for PRN36
-	(10 << 28) + 4855 + (( 5547 - 1) << 14),	// for PRN37
-	(10 << 28) + 4904 + (( 9546 - 1) << 14),	// for PRN38
-	(10 << 28) + 4753 + (( 9132 - 1) << 14),	// for PRN39
-	(10 << 28) + 4483 + ((  403 - 1) << 14),	// for PRN40
-	(10 << 28) + 4942 + (( 3766 - 1) << 14),	// for PRN41
-	(10 << 28) + 4813 + ((    3 - 1) << 14),	// for PRN42
-	(10 << 28) + 4957 + ((  684 - 1) << 14),	// for PRN43
-	(10 << 28) + 4618 + (( 9711 - 1) << 14),	// for PRN44
-	(10 << 28) + 4669 + ((  333 - 1) << 14),	// for PRN45
-	(10 << 28) + 4969 + (( 6124 - 1) << 14),	// for PRN46
-	(10 << 28) + 5031 + ((10216 - 1) << 14),	// for PRN47
-	(10 << 28) + 5038 + (( 4251 - 1) << 14),	// for PRN48
-	(10 << 28) + 4740 + (( 9893 - 1) << 14),	// for PRN49
-	(10 << 28) + 4073 + (( 9884 - 1) << 14),	// for PRN50
-	(10 << 28) + 4843 + (( 4627 - 1) << 14),	// for PRN51
-	(10 << 28) + 4979 + (( 4449 - 1) << 14),	// for PRN52
-	(10 << 28) + 4867 + (( 9798 - 1) << 14),	// for PRN53
-	(10 << 28) + 4964 + ((  985 - 1) << 14),	// for PRN54
-	(10 << 28) + 5025 + (( 4272 - 1) << 14),	// for PRN55
-	(10 << 28) + 4579 + ((  126 - 1) << 14),	// for PRN56
-	(10 << 28) + 4390 + ((10024 - 1) << 14),	// for PRN57
-	(10 << 28) + 4763 + ((  434 - 1) << 14),	// for PRN58
-	(10 << 28) + 4612 + (( 1029 - 1) << 14),	// for PRN59
-	(10 << 28) + 4784 + ((  561 - 1) << 14),	// for PRN60
-	(10 << 28) + 3716 + ((  289 - 1) << 14),	// for PRN61
-	(10 << 28) + 4703 + ((  638 - 1) << 14),	// for PRN62
-	(10 << 28) + 4851 + (( 4353 - 1) << 14),	// for PRN63
+	(10U << 28) + 5097 + ((  181 - 1) << 14),	// for PRN01
+	(10U << 28) + 5110 + ((  359 - 1) << 14),	// for PRN02
+	(10U << 28) + 5079 + ((   72 - 1) << 14),	// for PRN03
+	(10U << 28) + 4403 + (( 1110 - 1) << 14),	// for PRN04
+	(10U << 28) + 4121 + (( 1480 - 1) << 14),	// for PRN05
+	(10U << 28) + 5043 + (( 5034 - 1) << 14),	// for PRN06
+	(10U << 28) + 5042 + (( 4622 - 1) << 14),	// for PRN07
+	(10U << 28) + 5104 + ((    1 - 1) << 14),	// for PRN08
+	(10U << 28) + 4940 + (( 4547 - 1) << 14),	// for PRN09
+	(10U << 28) + 5035 + ((  826 - 1) << 14),	// for PRN10
+	(10U << 28) + 4372 + (( 6284 - 1) << 14),	// for PRN11
+	(10U << 28) + 5064 + (( 4195 - 1) << 14),	// for PRN12
+	(10U << 28) + 5084 + ((  368 - 1) << 14),	// for PRN13
+	(10U << 28) + 5048 + ((    1 - 1) << 14),	// for PRN14
+	(10U << 28) + 4950 + (( 4796 - 1) << 14),	// for PRN15
+	(10U << 28) + 5019 + ((  523 - 1) << 14),	// for PRN16
+	(10U << 28) + 5076 + ((  151 - 1) << 14),	// for PRN17
+	(10U << 28) + 3736 + ((  713 - 1) << 14),	// for PRN18
+	(10U << 28) + 4993 + (( 9850 - 1) << 14),	// for PRN19
+	(10U << 28) + 5060 + (( 5734 - 1) << 14),	// for PRN20
+	(10U << 28) + 5061 + ((   34 - 1) << 14),	// for PRN21
+	(10U << 28) + 5096 + (( 6142 - 1) << 14),	// for PRN22
+	(10U << 28) + 4983 + ((  190 - 1) << 14),	// for PRN23
+	(10U << 28) + 4783 + ((  644 - 1) << 14),	// for PRN24
+	(10U << 28) + 4991 + ((  467 - 1) << 14),	// for PRN25
+	(10U << 28) + 4815 + (( 5384 - 1) << 14),	// for PRN26
+	(10U << 28) + 4443 + ((  801 - 1) << 14),	// for PRN27
+	(10U << 28) + 4769 + ((  594 - 1) << 14),	// for PRN28
+	(10U << 28) + 4879 + (( 4450 - 1) << 14),	// for PRN29
+	(10U << 28) + 4894 + (( 9437 - 1) << 14),	// for PRN30
+	(10U << 28) + 4985 + (( 4307 - 1) << 14),	// for PRN31
+	(10U << 28) + 5056 + (( 5906 - 1) << 14),	// for PRN32
+	(10U << 28) + 4921 + ((  378 - 1) << 14),	// for PRN33
+	(10U << 28) + 5036 + (( 9448 - 1) << 14),	// for PRN34
+	(10U << 28) + 4812 + (( 9432 - 1) << 14),	// for PRN35
+	(10U << 28) + 4838 + (( 5849 - 1) << 14),	// for PRN36
+	(10U << 28) + 4855 + (( 5547 - 1) << 14),	// for PRN37
+	(10U << 28) + 4904 + (( 9546 - 1) << 14),	// for PRN38
+	(10U << 28) + 4753 + (( 9132 - 1) << 14),	// for PRN39
+	(10U << 28) + 4483 + ((  403 - 1) << 14),	// for PRN40
+	(10U << 28) + 4942 + (( 3766 - 1) << 14),	// for PRN41
+	(10U << 28) + 4813 + ((    3 - 1) << 14),	// for PRN42
+	(10U << 28) + 4957 + ((  684 - 1) << 14),	// for PRN43
+	(10U << 28) + 4618 + (( 9711 - 1) << 14),	// for PRN44
+	(10U << 28) + 4669 + ((  333 - 1) << 14),	// for PRN45
+	(10U << 28) + 4969 + (( 6124 - 1) << 14),	// for PRN46
+	(10U << 28) + 5031 + ((10216 - 1) << 14),	// for PRN47
+	(10U << 28) + 5038 + (( 4251 - 1) << 14),	// for PRN48
+	(10U << 28) + 4740 + (( 9893 - 1) << 14),	// for PRN49
+	(10U << 28) + 4073 + (( 9884 - 1) << 14),	// for PRN50
+	(10U << 28) + 4843 + (( 4627 - 1) << 14),	// for PRN51
+	(10U << 28) + 4979 + (( 4449 - 1) << 14),	// for PRN52
+	(10U << 28) + 4867 + (( 9798 - 1) << 14),	// for PRN53
+	(10U << 28) + 4964 + ((  985 - 1) << 14),	// for PRN54
+	(10U << 28) + 5025 + (( 4272 - 1) << 14),	// for PRN55
+	(10U << 28) + 4579 + ((  126 - 1) << 14),	// for PRN56
+	(10U << 28) + 4390 + ((10024 - 1) << 14),	// for PRN57
+	(10U << 28) + 4763 + ((  434 - 1) << 14),	// for PRN58
+	(10U << 28) + 4612 + (( 1029 - 1) << 14),	// for PRN59
+	(10U << 28) + 4784 + ((  561 - 1) << 14),	// for PRN60
+	(10U << 28) + 3716 + ((  289 - 1) << 14),	// for PRN61
+	(10U << 28) + 4703 + ((  638 - 1) << 14),	// for PRN62
+	(10U << 28) + 4851 + (( 4353 - 1) << 14),	// for PRN63
 };
 
 CAcqEngine::CAcqEngine(unsigned int *MemCodeAddress)
@@ -356,6 +360,20 @@ CAcqEngine::CAcqEngine(unsigned int *MemCodeAddress)
 
 	for (i = 0; i < TOTAL_INTERMEDIATE_RESULT; i ++)
 		fp_out[i] = NULL;
+	MatchFilterMode = MF_MODE_DIRECT;
+	MatchFilterCheck = 0;
+	MatchFilterMismatch = 0;
+	MfFft = NULL;
+	MfBitSlice = NULL;
+	SampleBuffer = AEBuffer;
+	MemCode = MemCodeAddress;
+	ParallelMode = AE_PARALLEL_NONE;
+	WorkerPool = NULL;
+	for (i = 0; i < MAX_WORKER_NUMBER; i ++)
+		WorkerEngine[i] = NULL;
+	UnitNumber = 0;
+	memset(UnitRecord, 0, sizeof(UnitRecord));
+	PeakRecord = NULL;
 
 	PrnGen[0] = new CGeneralPrn(PrnPolySettings);
 	PrnGen[1] = new CMemoryPrn(MemCodeAddress);
@@ -366,9 +384,16 @@ CAcqEngine::CAcqEngine(unsigned int *MemCodeAddress)
 
 CAcqEngine::~CAcqEngine()
 {
+	int i;
+
+	SetParallelMode(AE_PARALLEL_NONE, 1);
+	for (i = 0; i < MAX_WORKER_NUMBER*AE_BATCH_PER_WORKER; i ++)
+		free(UnitRecord[i].Data);
 	delete PrnGen[0];
 	delete PrnGen[1];
 	delete PrnGen[2];
+	delete MfFft;
+	delete MfBitSlice;
 }
 
 void CAcqEngine::Reset()
@@ -396,9 +421,9 @@ void CAcqEngine::SetRegValue(int Address, U32 Value)
 		break;
 	case ADDR_OFFSET_AE_BUFFER_CONTROL:
 		BufferThreshold = EXTRACT_UINT(Value, 0, 7);
-		if (Value & 200)
+		if (Value & 0x200)
 			RateAdaptor.Reset();
-		if (Value & 100)
+		if (Value & 0x100)
 			StartFill();
 		break;
 	case ADDR_OFFSET_AE_CARRIER_FREQ:
@@ -497,6 +522,35 @@ void CAcqEngine::LoadCode()
 }
 
 void CAcqEngine::MatchFilterCore(int PhaseCount, complex_int CorResult[])
+{
+	int i;
+	complex_int DirectResult[MF_CORE_DEPTH];
+
+	switch (MatchFilterMode)
+	{
+	case MF_MODE_FFT:
+		MfFft->MatchFilter(AcqSamples, AcqCode, ADDER_TREE_WIDTH, PhaseCount, CorResult);
+		break;
+	case MF_MODE_BITSLICE:
+		MfBitSlice->MatchFilter(AcqSamples, AcqCode, ADDER_TREE_WIDTH, PhaseCount, CorResult);
+		break;
+	default:
+		MatchFilterDirect(PhaseCount, CorResult);
+		return;
+	}
+
+	if (MatchFilterCheck)
+	{
+		MatchFilterDirect(PhaseCount, DirectResult);
+		for (i = 0; i < PhaseCount; i ++)
+			if (CorResult[i].real != DirectResult[i].real || CorResult[i].imag != DirectResult[i].imag)
+				break;
+		if (i < PhaseCount)
+			MatchFilterMismatch ++;
+	}
+}
+
+void CAcqEngine::MatchFilterDirect(int PhaseCount, complex_int CorResult[])
 {
 	int i, j;
 /*	unsigned int TreeInput[344];
@@ -537,6 +591,31 @@ void CAcqEngine::MatchFilterCore(int PhaseCount, complex_int CorResult[])
 	}
 }
 
+// select match filter implementation, return actual mode selected
+// if Check is not zero, each match filter segment is also calculated by MF_MODE_DIRECT and compared
+int CAcqEngine::SetMatchFilterMode(int Mode, int Check)
+{
+	int i;
+
+	// whole segment and code should fit in FFT without circular wrap
+	if (Mode == MF_MODE_FFT && (ADDER_TREE_WIDTH > ACQ_MAX_CODE_LENGTH || MF_CORE_DEPTH + ADDER_TREE_WIDTH * 2 - 2 > ACQ_FFT_SIZE))
+		Mode = MF_MODE_DIRECT;
+	if (Mode == MF_MODE_BITSLICE && (ADDER_TREE_WIDTH > BITSLICE_MAX_CODE_LENGTH || MF_CORE_DEPTH * 2 > BITSLICE_MAX_SAMPLES))
+		Mode = MF_MODE_DIRECT;
+	if (Mode == MF_MODE_FFT && MfFft == NULL)
+		MfFft = new CAcqFft;
+	if (Mode == MF_MODE_BITSLICE && MfBitSlice == NULL)
+		MfBitSlice = new CAcqBitSlice;
+	MatchFilterMode = Mode;
+	MatchFilterCheck = Check;
+	MatchFilterMismatch = 0;
+	for (i = 0; i < MAX_WORKER_NUMBER; i ++)
+		if (WorkerEngine[i])
+			WorkerEngine[i]->SetMatchFilterMode(Mode, Check);
+
+	return Mode;
+}
+
 void CAcqEngine::GetDftFactor(complex_int DftFactor[DFT_NUMBER/2], int sign_cos[DFT_NUMBER/2], int sign_sin[DFT_NUMBER/2])
 {
 	int i;
@@ -643,7 +722,7 @@ void CAcqEngine::NonCoherentAcc(unsigned int MaxCohExp, int NoncohCount)
 		}
 
 		AmpSumCor >>= 3;	// to simplify, use truncate instead of round shift, this will introduce less than 3% loss for strong peak and less than 0.5% for weak peak
-		if (NoncohCount == (NonCoherentNumber - 1) && CodeRoundCount == (CodeSpan / (FULL_LENGTH ? 3 : 1) - 1) && (StrideCount == StrideNumber))		// last round
+		if (NoncohCount == ((int)NonCoherentNumber - 1) && CodeRoundCount == ((int)(CodeSpan / (FULL_LENGTH ? 3 : 1)) - 1) && (StrideCount == StrideNumber))		// last round
 			NoiseFloor += AmpSumCor;
 
 		// insert the maximum amplitude value within frequency bins to peak sorter
@@ -772,7 +851,13 @@ void CAcqEngine::DoNonCoherentSum()
 			}
 
 		NonCoherentAcc(MaxExp, NoncohCount);
-		if (PeakFound() && EarlyTerminate)
+		if (PeakRecord)	// peak sorting and early terminate are done when record is replayed
+		{
+			PeakRecord->Data[PeakRecord->RoundNumber * AE_RECORD_ROUND_SIZE + MF_CORE_DEPTH] = NoiseFloor;
+			PeakRecord->Data[PeakRecord->RoundNumber * AE_RECORD_ROUND_SIZE + MF_CORE_DEPTH + 1] = NoncohExp;
+			PeakRecord->RoundNumber ++;
+		}
+		else if (PeakFound() && EarlyTerminate)
 			break;
 	}
 }
@@ -781,6 +866,11 @@ void CAcqEngine::InsertPeak(int Amp, int Exp, int PartialCorPos, int PartialFreq
 {
 	PeakData Peak;
 
+	if (PeakRecord)
+	{
+		PeakRecord->Data[PeakRecord->RoundNumber * AE_RECORD_ROUND_SIZE + PartialCorPos] = Amp | (Exp << 16) | (PartialFreq << 24);
+		return;
+	}
 	Peak.Amp = Amp;
 	Peak.Exp = Exp;
 	Peak.PhasePos = CodeRoundCount * MF_CORE_DEPTH + PartialCorPos;
@@ -822,11 +912,7 @@ void CAcqEngine::SearchOneChannel()
 
 	for (StrideCount = 1; StrideCount <= StrideNumber; StrideCount ++)
 	{
-		StrideOffset = (StrideCount >> 1);
-		if (StrideCount & 1)
-			StrideOffset = ~StrideOffset;
-		StrideOffset += (StrideCount & 1);
-		CarrierFreq = CenterFreq + StrideInterval * StrideOffset;
+		SetStrideOffset();
 
 		for (CodeRoundCount = 0; CodeRoundCount < CodeRoundNumber; CodeRoundCount ++)
 		{
@@ -851,34 +937,255 @@ void CAcqEngine::DoAcquisition()
 {
 	unsigned int i;
 
+	PROFILE_SCOPE(PROFILE_STAGE_ACQUISITION);
+	PROFILE_COUNT(PROFILE_COUNT_AE_CHANNEL, ChannelNumber);
+#if MODEL_PROFILE
+	for (i = 0; i < ChannelNumber; i ++)
+		PROFILE_COUNT(PROFILE_COUNT_AE_STRIDE, EXTRACT_UINT(ChannelConfig[i][0], 0, 6));
+#endif
+	// intermediate result output follows search order, so only available in sequential mode
+	for (i = 0; i < TOTAL_INTERMEDIATE_RESULT; i ++)
+		if (fp_out[i])
+			break;
+	if (i == TOTAL_INTERMEDIATE_RESULT && ParallelMode == AE_PARALLEL_CHANNEL)
+	{
+		SearchChannelParallel();
+		return;
+	}
+	if (i == TOTAL_INTERMEDIATE_RESULT && ParallelMode == AE_PARALLEL_STRIDE)
+	{
+		SearchStrideParallel();
+		return;
+	}
+
 	for (i = 0; i < ChannelNumber; i ++)
 	{
 		// fill in config registers
-		StrideNumber = EXTRACT_UINT(ChannelConfig[i][0], 0, 6);
-		CoherentNumber = EXTRACT_UINT(ChannelConfig[i][0], 8, 6);
-		NonCoherentNumber = EXTRACT_UINT(ChannelConfig[i][0], 16, 7);
-		PeakRatioTh = EXTRACT_UINT(ChannelConfig[i][0], 24, 3);
-		EarlyTerminate = EXTRACT_UINT(ChannelConfig[i][0], 27, 1);
-		CenterFreq = EXTRACT_INT(ChannelConfig[i][1], 0, 20) << 12;
-		Svid = EXTRACT_UINT(ChannelConfig[i][1], 24, 6);
-		PrnSelect = EXTRACT_UINT(ChannelConfig[i][1], 30, 2);
-		CodeSpan = EXTRACT_UINT(ChannelConfig[i][2], 0, 5);
-		ReadAddress = EXTRACT_UINT(ChannelConfig[i][2], 8, 5);
-		DftFreq = EXTRACT_UINT(ChannelConfig[i][2], 20, 11);
-		StrideInterval = EXTRACT_UINT(ChannelConfig[i][3], 0, 22);
+		LoadChannelConfig(ChannelConfig[i]);
 
 		// Do searching
 		SearchOneChannel();
 
 		// write back result
-		NoiseFloor >>= (PeakSorter.Peaks[0].Exp - NoncohExp);	// adjust noise floor exp to be same as peaks
-		ChannelConfig[i][4] = (Success << 31) | (PeakSorter.Peaks[0].Exp << 24) | (NoiseFloor & 0x7ffff);
-		ChannelConfig[i][5] = (PeakSorter.Peaks[0].Amp << 24) | ((PeakSorter.Peaks[0].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[0].PhasePos;
-		ChannelConfig[i][6] = (PeakSorter.Peaks[1].Amp << 24) | ((PeakSorter.Peaks[1].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[1].PhasePos;
-		ChannelConfig[i][7] = (PeakSorter.Peaks[2].Amp << 24) | ((PeakSorter.Peaks[2].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[2].PhasePos;
+		SaveChannelResult(ChannelConfig[i]);
 	}
 }
 
+void CAcqEngine::LoadChannelConfig(unsigned int Config[CHANNEL_CONFIG_LEN])
+{
+	StrideNumber = EXTRACT_UINT(Config[0], 0, 6);
+	CoherentNumber = EXTRACT_UINT(Config[0], 8, 6);
+	NonCoherentNumber = EXTRACT_UINT(Config[0], 16, 7);
+	PeakRatioTh = EXTRACT_UINT(Config[0], 24, 3);
+	EarlyTerminate = EXTRACT_UINT(Config[0], 27, 1);
+	CenterFreq = EXTRACT_INT(Config[1], 0, 20) << 12;
+	Svid = EXTRACT_UINT(Config[1], 24, 6);
+	PrnSelect = EXTRACT_UINT(Config[1], 30, 2);
+	CodeSpan = EXTRACT_UINT(Config[2], 0, 5);
+	ReadAddress = EXTRACT_UINT(Config[2], 8, 5);
+	DftFreq = EXTRACT_UINT(Config[2], 20, 11);
+	StrideInterval = EXTRACT_UINT(Config[3], 0, 22);
+	// clear result of previous channel, so channel with nothing to search reports zero noise floor in all parallel modes
+	NoiseFloor = 0;
+	NoncohExp = 0;
+}
+
+void CAcqEngine::SaveChannelResult(unsigned int Config[CHANNEL_CONFIG_LEN])
+{
+	NoiseFloor >>= (PeakSorter.Peaks[0].Exp - NoncohExp);	// adjust noise floor exp to be same as peaks
+	Config[4] = (Success << 31) | (PeakSorter.Peaks[0].Exp << 24) | (NoiseFloor & 0x7ffff);
+	Config[5] = (PeakSorter.Peaks[0].Amp << 24) | ((PeakSorter.Peaks[0].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[0].PhasePos;
+	Config[6] = (PeakSorter.Peaks[1].Amp << 24) | ((PeakSorter.Peaks[1].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[1].PhasePos;
+	Config[7] = (PeakSorter.Peaks[2].Amp << 24) | ((PeakSorter.Peaks[2].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[2].PhasePos;
+}
+
+// stride order is 0, +1, -1, +2, -2 ... for StrideCount 1, 2, 3, 4, 5 ...
+void CAcqEngine::SetStrideOffset()
+{
+	StrideOffset = (StrideCount >> 1);
+	if (StrideCount & 1)
+		StrideOffset = ~StrideOffset;
+	StrideOffset += (StrideCount & 1);
+	CarrierFreq = CenterFreq + StrideInterval * StrideOffset;
+}
+
+void CAcqEngine::SetParallelMode(int Mode, int ThreadNumber)
+{
+	int i;
+
+	if (WorkerPool)
+	{
+		delete WorkerPool;
+		WorkerPool = NULL;
+	}
+	for (i = 0; i < MAX_WORKER_NUMBER; i ++)
+	{
+		delete WorkerEngine[i];
+		WorkerEngine[i] = NULL;
+	}
+	ParallelMode = Mode;
+	if (Mode == AE_PARALLEL_NONE)
+		return;
+
+	WorkerPool = new CWorkerPool(ThreadNumber);
+	for (i = 0; i < WorkerPool->GetWorkerNumber(); i ++)
+	{
+		WorkerEngine[i] = new CAcqEngine(MemCode);
+		WorkerEngine[i]->SampleBuffer = AEBuffer;
+		WorkerEngine[i]->SetMatchFilterMode(MatchFilterMode, MatchFilterCheck);
+	}
+}
+
+// search each channel on worker threads, channels only share AE buffer for read
+void CAcqEngine::SearchChannelParallel()
+{
+	int i;
+
+	WorkerPool->RunTasks(ChannelNumber, ChannelTask, this);
+	for (i = 0; i < WorkerPool->GetWorkerNumber(); i ++)
+	{
+		MatchFilterMismatch += WorkerEngine[i]->MatchFilterMismatch;
+		WorkerEngine[i]->MatchFilterMismatch = 0;
+	}
+}
+
+void CAcqEngine::ChannelTask(void *Param, int TaskIndex, int WorkerIndex)
+{
+	CAcqEngine *Engine = (CAcqEngine *)Param;
+	CAcqEngine *Worker = Engine->WorkerEngine[WorkerIndex];
+
+	Worker->LoadChannelConfig(Engine->ChannelConfig[TaskIndex]);
+	Worker->SearchOneChannel();
+	Worker->SaveChannelResult(Engine->ChannelConfig[TaskIndex]);
+}
+
+// search code rounds of all strides on worker threads, a batch of code rounds at a time in search order
+// workers record peaks, which are inserted into peak sorter and checked for early terminate in search order
+// so the result is identical to sequential processing, code rounds after early terminate are dropped
+void CAcqEngine::SearchStrideParallel()
+{
+	int i, Channel = 0, Stride = 1, CodeRound = 0, StrideTotal, CodeRoundTotal;
+	int BatchSize = WorkerPool->GetWorkerNumber() * AE_BATCH_PER_WORKER;
+	int TerminateChannel = -1;
+	AcqPeakRecord *Record;
+
+	while (Channel < (int)ChannelNumber)
+	{
+		// collect next batch of code rounds
+		for (UnitNumber = 0; UnitNumber < BatchSize && Channel < (int)ChannelNumber; UnitNumber ++)
+		{
+			Record = &UnitRecord[UnitNumber];
+			StrideTotal = EXTRACT_UINT(ChannelConfig[Channel][0], 0, 6);
+			CodeRoundTotal = EXTRACT_UINT(ChannelConfig[Channel][2], 0, 5) / (FULL_LENGTH ? 3 : 1);
+			Record->Channel = Channel;
+			Record->RoundNumber = 0;
+			if (StrideTotal == 0 || CodeRoundTotal == 0)
+			{
+				Record->StrideCount = 0;
+				Record->CodeRoundCount = 0;
+				Channel ++;
+				continue;
+			}
+			Record->StrideCount = Stride;
+			Record->CodeRoundCount = CodeRound;
+			if (++ CodeRound == CodeRoundTotal)
+			{
+				CodeRound = 0;
+				if (++ Stride > StrideTotal)
+				{
+					Stride = 1;
+					Channel ++;
+				}
+			}
+		}
+
+		WorkerPool->RunTasks(UnitNumber, StrideTask, this);
+
+		// replay records in search order
+		for (i = 0; i < UnitNumber; i ++)
+		{
+			Record = &UnitRecord[i];
+			if (Record->Channel == TerminateChannel)
+				continue;
+			if (Record->StrideCount <= 1 && Record->CodeRoundCount == 0)	// first code round of channel
+			{
+				LoadChannelConfig(ChannelConfig[Record->Channel]);
+				Success = 0;
+				PeakSorter.Clear();
+			}
+			if (ReplayPeakRecord(*Record))
+			{
+				TerminateChannel = Record->Channel;
+				SaveChannelResult(ChannelConfig[Record->Channel]);
+				// skip remaining code rounds of this channel in following batches
+				if (Channel == Record->Channel)
+				{
+					Stride = 1;
+					CodeRound = 0;
+					Channel ++;
+				}
+			}
+			else if (Record->StrideCount == 0 || (Record->StrideCount == (int)StrideNumber && Record->CodeRoundCount == (int)(CodeSpan / (FULL_LENGTH ? 3 : 1)) - 1))
+				SaveChannelResult(ChannelConfig[Record->Channel]);
+		}
+	}
+
+	for (i = 0; i < WorkerPool->GetWorkerNumber(); i ++)
+	{
+		MatchFilterMismatch += WorkerEngine[i]->MatchFilterMismatch;
+		WorkerEngine[i]->MatchFilterMismatch = 0;
+	}
+}
+
+void CAcqEngine::StrideTask(void *Param, int TaskIndex, int WorkerIndex)
+{
+	CAcqEngine *Engine = (CAcqEngine *)Param;
+	CAcqEngine *Worker = Engine->WorkerEngine[WorkerIndex];
+	AcqPeakRecord *Record = &Engine->UnitRecord[TaskIndex];
+
+	if (Record->StrideCount == 0)
+		return;
+	Worker->LoadChannelConfig(Engine->ChannelConfig[Record->Channel]);
+	if (Record->Capacity < (int)Worker->NonCoherentNumber)
+	{
+		Record->Capacity = Worker->NonCoherentNumber;
+		Record->Data = (unsigned int *)realloc(Record->Data, Record->Capacity * AE_RECORD_ROUND_SIZE * sizeof(unsigned int));
+	}
+	Worker->StrideCount = Record->StrideCount;
+	Worker->SetStrideOffset();
+	Worker->CodeRoundCount = Record->CodeRoundCount;
+	Worker->PeakRecord = Record;
+	Worker->InitPrnGen();
+	Worker->LoadCode();
+	Worker->DoNonCoherentSum();
+	Worker->PeakRecord = NULL;
+}
+
+// insert recorded peaks into peak sorter as DoNonCoherentSum() does, return 1 if search terminates early
+int CAcqEngine::ReplayPeakRecord(AcqPeakRecord &Record)
+{
+	int i, Round;
+	unsigned int *Data;
+
+	if (Record.StrideCount == 0)
+		return 0;
+	StrideCount = Record.StrideCount;
+	SetStrideOffset();
+	CodeRoundCount = Record.CodeRoundCount;
+	for (Round = 0; Round < Record.RoundNumber; Round ++)
+	{
+		Data = Record.Data + Round * AE_RECORD_ROUND_SIZE;
+		for (i = 0; i < MF_CORE_DEPTH; i ++)
+			InsertPeak(Data[i] & 0xffff, (Data[i] >> 16) & 0xff, i, Data[i] >> 24);
+		NoiseFloor = Data[MF_CORE_DEPTH];
+		NoncohExp = Data[MF_CORE_DEPTH + 1];
+		if (PeakFound() && EarlyTerminate)
+			return 1;
+	}
+
+	return 0;
+}
+
 unsigned int CAcqEngine::Amplitude(complex_exp10 data)
 {
 	unsigned int max, min, amp;
@@ -925,7 +1232,7 @@ unsigned int CAcqEngine::ReadSample()
 {
 	if (ReadPointer >= AE_BUFFER_SIZE)
 		ReadPointer = 0;
-	return (unsigned int)AEBuffer[ReadPointer++];
+	return (unsigned int)SampleBuffer[ReadPointer++];
 }
 
 int CAcqEngine::WriteSample(int Length, unsigned char Sample[])
@@ -0,0 +1,184 @@
+//----------------------------------------------------------------------
+// AcqFft.cpp:
+//   FFT based matched filter for acquisition engine implementation
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <math.h>
+#include <malloc.h>
+#include <string.h>
+
+#include "AcqFft.h"
+
+#define PI 3.14159265358979323846
+
+CAcqFft::CAcqFft()
+{
+	int i, j, Index;
+
+	for (i = 0; i < ACQ_FFT_SIZE / 2; i ++)
+	{
+		CosTable[i] = cos(2 * PI * i / ACQ_FFT_SIZE);
+		SinTable[i] = sin(2 * PI * i / ACQ_FFT_SIZE);
+	}
+	for (i = 0; i < ACQ_FFT_SIZE; i ++)
+	{
+		for (j = 0, Index = 0; j < ACQ_FFT_ORDER; j ++)
+			Index |= ((i >> j) & 1) << (ACQ_FFT_ORDER - 1 - j);
+		BitReverse[i] = Index;
+	}
+	SampleReal = (double *)malloc(ACQ_FFT_SIZE * sizeof(double));
+	SampleImag = (double *)malloc(ACQ_FFT_SIZE * sizeof(double));
+	for (i = 0; i < ACQ_SPECTRUM_CACHE_SIZE; i ++)
+	{
+		Spectrum[i].Real = (double *)malloc(ACQ_FFT_SIZE * sizeof(double));
+		Spectrum[i].Imag = (double *)malloc(ACQ_FFT_SIZE * sizeof(double));
+	}
+	ClearCache();
+	MaxResidual = 0.0;
+	ExceedCount = 0;
+}
+
+CAcqFft::~CAcqFft()
+{
+	int i;
+
+	free(SampleReal);
+	free(SampleImag);
+	for (i = 0; i < ACQ_SPECTRUM_CACHE_SIZE; i ++)
+	{
+		free(Spectrum[i].Real);
+		free(Spectrum[i].Imag);
+	}
+}
+
+void CAcqFft::ClearCache()
+{
+	SpectrumNumber = 0;
+	ReplaceIndex = 0;
+}
+
+// calculate CorResult[i] = sum(Code[t] ? ~Samples[i+2t] : Samples[i+2t]) for t = 0 to CodeLength-1
+// this is the same result as CAcqEngine::MatchFilterCore(), ~x equals to -x-1, so
+// CorResult[i] = sum(a[t] * Samples[i+2t]) - sum(Code[t]) with a[t] = 1 - 2 * Code[t]
+// the first part is the cross correlation calculated by FFT and rounded to integer
+void CAcqFft::MatchFilter(const complex_int Samples[], const unsigned int Code[], int CodeLength, int PhaseCount, complex_int CorResult[])
+{
+	int i, SampleNumber = PhaseCount + CodeLength * 2 - 2;
+	AcqCodeSpectrum *CodeSpectrum = GetCodeSpectrum(Code, CodeLength);
+	double Real, Imag, Value, Residual;
+
+	// no circular wrap within the range of output
+	for (i = 0; i < SampleNumber; i ++)
+	{
+		SampleReal[i] = (double)Samples[i].real;
+		SampleImag[i] = (double)Samples[i].imag;
+	}
+	for (; i < ACQ_FFT_SIZE; i ++)
+		SampleReal[i] = SampleImag[i] = 0.0;
+	Transform(SampleReal, SampleImag, 0);
+
+	// multiply with conjugate of code spectrum
+	for (i = 0; i < ACQ_FFT_SIZE; i ++)
+	{
+		Real = SampleReal[i] * CodeSpectrum->Real[i] + SampleImag[i] * CodeSpectrum->Imag[i];
+		Imag = SampleImag[i] * CodeSpectrum->Real[i] - SampleReal[i] * CodeSpectrum->Imag[i];
+		SampleReal[i] = Real;
+		SampleImag[i] = Imag;
+	}
+	Transform(SampleReal, SampleImag, 1);
+
+	for (i = 0; i < PhaseCount; i ++)
+	{
+		Value = floor(SampleReal[i] / ACQ_FFT_SIZE + 0.5);
+		Residual = fabs(SampleReal[i] / ACQ_FFT_SIZE - Value);
+		if (Residual > MaxResidual)
+			MaxResidual = Residual;
+		if (Residual > ACQ_FFT_TOLERANCE)
+			ExceedCount ++;
+		CorResult[i].real = (int)Value - CodeSpectrum->CodeSum;
+		Value = floor(SampleImag[i] / ACQ_FFT_SIZE + 0.5);
+		Residual = fabs(SampleImag[i] / ACQ_FFT_SIZE - Value);
+		if (Residual > MaxResidual)
+			MaxResidual = Residual;
+		if (Residual > ACQ_FFT_TOLERANCE)
+			ExceedCount ++;
+		CorResult[i].imag = (int)Value - CodeSpectrum->CodeSum;
+	}
+}
+
+// in place radix-2 FFT, inverse transform is not scaled
+void CAcqFft::Transform(double Real[], double Imag[], int Inverse)
+{
+	int i, j, k, Half, Step;
+	double Temp, wr, wi, tr, ti;
+
+	for (i = 0; i < ACQ_FFT_SIZE; i ++)
+	{
+		j = BitReverse[i];
+		if (i < j)
+		{
+			Temp = Real[i]; Real[i] = Real[j]; Real[j] = Temp;
+			Temp = Imag[i]; Imag[i] = Imag[j]; Imag[j] = Temp;
+		}
+	}
+
+	for (Half = 1, Step = ACQ_FFT_SIZE / 2; Half < ACQ_FFT_SIZE; Half <<= 1, Step >>= 1)
+	{
+		for (j = 0; j < Half; j ++)
+		{
+			wr = CosTable[j * Step];
+			wi = Inverse ? SinTable[j * Step] : -SinTable[j * Step];
+			for (i = j; i < ACQ_FFT_SIZE; i += Half * 2)
+			{
+				k = i + Half;
+				tr = Real[k] * wr - Imag[k] * wi;
+				ti = Real[k] * wi + Imag[k] * wr;
+				Real[k] = Real[i] - tr;
+				Imag[k] = Imag[i] - ti;
+				Real[i] += tr;
+				Imag[i] += ti;
+			}
+		}
+	}
+}
+
+// find spectrum of code segment in cache, calculate and put in cache if not found
+AcqCodeSpectrum *CAcqFft::GetCodeSpectrum(const unsigned int Code[], int CodeLength)
+{
+	unsigned long long PackedCode[ACQ_CODE_WORDS];
+	AcqCodeSpectrum *CodeSpectrum;
+	int i;
+
+	memset(PackedCode, 0, sizeof(PackedCode));
+	for (i = 0; i < CodeLength; i ++)
+		if (Code[i])
+			PackedCode[i >> 6] |= 1ULL << (i & 0x3f);
+
+	for (i = 0; i < SpectrumNumber; i ++)
+		if (Spectrum[i].CodeLength == CodeLength && memcmp(Spectrum[i].Code, PackedCode, sizeof(PackedCode)) == 0)
+			return &Spectrum[i];
+
+	if (SpectrumNumber < ACQ_SPECTRUM_CACHE_SIZE)
+		CodeSpectrum = &Spectrum[SpectrumNumber ++];
+	else
+	{
+		CodeSpectrum = &Spectrum[ReplaceIndex];
+		ReplaceIndex = (ReplaceIndex + 1) % ACQ_SPECTRUM_CACHE_SIZE;
+	}
+	memcpy(CodeSpectrum->Code, PackedCode, sizeof(PackedCode));
+	CodeSpectrum->CodeLength = CodeLength;
+	CodeSpectrum->CodeSum = 0;
+	for (i = 0; i < ACQ_FFT_SIZE; i ++)
+		CodeSpectrum->Real[i] = CodeSpectrum->Imag[i] = 0.0;
+	for (i = 0; i < CodeLength; i ++)
+	{
+		CodeSpectrum->Real[i * 2] = Code[i] ? -1.0 : 1.0;
+		CodeSpectrum->CodeSum += Code[i] ? 1 : 0;
+	}
+	Transform(CodeSpectrum->Real, CodeSpectrum->Imag, 0);
+
+	return CodeSpectrum;
+}
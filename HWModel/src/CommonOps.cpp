@@ -8,6 +8,8 @@
 
 #include "CommonOps.h"
 
+#if defined _MSC_VER	// implementation of __builtin_xxx in Visual Studio
+
 int __builtin_popcount(unsigned int data)
 {
 	data = (data & 0x55555555) + ((data >> 1) & 0x55555555);
@@ -30,6 +32,8 @@ int __builtin_clz(unsigned int data)
 	return 32 - __builtin_popcount(data);
 }
 
+#endif
+
 complex_int complex_int::operator + (complex_int data) { return complex_int(this->real+data.real, this->imag+data.imag); }
 void complex_int::operator += (complex_int data) { this->real += data.real; this->imag += data.imag; }
 complex_int complex_int::operator - (complex_int data) { return complex_int(this->real-data.real, this->imag-data.imag); }
@@ -33,6 +33,25 @@ complex_int(  9,   8), complex_int( 10,   7), complex_int( 10,   6), complex_int
 complex_int( 11,   4), complex_int( 12,   3), complex_int( 12,   2), complex_int( 12,   1),
 };
 
+int CCorrelator::EnablePrnCache = 1;
+
+// find cached chip table for the PRN generator selected by PrnConfig
+static const PrnChipTable *GetChipTable(CPrnGen *PrnGen, int PrnIndex, unsigned int PrnConfig)
+{
+	if (!CCorrelator::EnablePrnCache)
+		return NULL;
+	switch (PrnIndex)
+	{
+	case 0:
+	case 1:
+		return CPrnCache::GetTable(PrnIndex, PrnConfig, ((CGeneralPrn *)PrnGen)->PrnPolySettings, NULL);
+	case 2:
+		return CPrnCache::GetTable(PrnIndex, PrnConfig, NULL, NULL);
+	default:
+		return CPrnCache::GetTable(PrnIndex, PrnConfig, NULL, ((CMemoryPrn *)PrnGen)->CodeMemory);
+	}
+}
+
 CCorrelator::CCorrelator(unsigned int PolySettings[], unsigned int *MemCodeAddress)
 {
 	DumpDataOutput = NULL;
@@ -45,6 +64,10 @@ CCorrelator::CCorrelator(unsigned int PolySettings[], unsigned int *MemCodeAddre
 	PrnGen2[2] = new CWeilPrn;
 	PrnGen2[3] = new CMemoryPrn(MemCodeAddress);
 	NoiseCalc = NULL;
+	PrnCursor.Table = PrnCursor2.Table = NULL;
+	SampleIQ = (unsigned int *)malloc(CORRELATOR_BLOCK_SIZE * sizeof(unsigned int));
+	PrnValueBuffer = (unsigned char *)malloc(CORRELATOR_BLOCK_SIZE * sizeof(unsigned char));
+	PendingStart = PendingEnd = 0;
 	Reset();
 }
 
@@ -58,6 +81,8 @@ CCorrelator::~CCorrelator()
 	delete PrnGen2[1];
 	delete PrnGen2[2];
 	delete PrnGen2[3];
+	free(SampleIQ);
+	free(PrnValueBuffer);
 }
 
 void CCorrelator::Reset()
@@ -115,9 +140,10 @@ void CCorrelator::FillState(unsigned int *StateBuffer)
 	}
 	PrnIndex = StateBuffer[5] >> 30;
 	PrnGen[PrnIndex]->FillState(StateBuffer + 5);
+	PrnCursor.Attach(GetChipTable(PrnGen[PrnIndex], PrnIndex, StateBuffer[5]), StateBuffer + 5);
 	// bit0 of PrnCode is not a register but a wire from PrnGen output
 	PrnCode &= ~1;
-	PrnCode |= PrnGen[PrnIndex]->GetCode() ^ (EnableBOC & CodeSubPhase) ^ ((NHLength && (NHCode & (1 << NHCount))) ? 1 : 0);
+	PrnCode |= GetPrnCode() ^ (EnableBOC & CodeSubPhase) ^ ((NHLength && (NHCode & (1 << NHCount))) ? 1 : 0);
 	PrnCode2 <<= 1;
 	if (EnableSecondPrn)
 	{
@@ -126,7 +152,8 @@ void CCorrelator::FillState(unsigned int *StateBuffer)
 		SecondPrnState[2] = StateBuffer[7];
 		PrnIndex2 = SecondPrnState[0] >> 30;
 		PrnGen2[PrnIndex2]->FillState(SecondPrnState);
-		PrnCode2 |= PrnGen2[PrnIndex2]->GetCode() ^ (EnableBOC & CodeSubPhase);
+		PrnCursor2.Attach(GetChipTable(PrnGen2[PrnIndex2], PrnIndex2, SecondPrnState[0]), SecondPrnState);
+		PrnCode2 |= GetPrnCode2() ^ (EnableBOC & CodeSubPhase);
 	}
 }
 
@@ -145,10 +172,16 @@ void CCorrelator::DumpState(unsigned int *StateBuffer)
 	for (i = 0; i < 8; i ++)
 		StateBuffer[i+16] = ((unsigned int)AccDataI[i] << 16) | ((unsigned int)AccDataQ[i] & 0xffff);
 
-	PrnGen[PrnIndex]->DumpState(StateBuffer + 5);
+	if (PrnCursor.Table)
+		PrnCursor.DumpState(StateBuffer + 5);
+	else
+		PrnGen[PrnIndex]->DumpState(StateBuffer + 5);
 	if (EnableSecondPrn)
 	{
-		PrnGen2[PrnIndex2]->DumpState(SecondPrnState);
+		if (PrnCursor2.Table)
+			PrnCursor2.DumpState(SecondPrnState);
+		else
+			PrnGen2[PrnIndex2]->DumpState(SecondPrnState);
 		StateBuffer[15] = SecondPrnState[1];
 	}
 }
@@ -218,10 +251,15 @@ complex_int CCorrelator::DownConvert(complex_int InputData)
 // return 1 means any correlator reaches last coherent sum
 int CCorrelator::Correlation(int SampleNumber, complex_int SampleData[], S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int &DumpDataLength)
 {
-	int i = 0;
-	unsigned int CodePhaseNew;
-	complex_int SampleDown;
-	
+	StartCorrelation(DumpDataI, DumpDataQ, CorIndex, DumpDataLength);
+	CorrelateSamples(SampleNumber, SampleData, DumpDataI, DumpDataQ, CorIndex, DumpDataLength);
+	return FinishCorrelation(DumpDataI, DumpDataQ, CorIndex, DumpDataLength);
+}
+
+// Correlation of one round split into three steps, so samples of one round can be given in several segments
+// StartCorrelation() clears per round registers and processes positive jump
+void CCorrelator::StartCorrelation(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int &DumpDataLength)
+{
 	// clear overwrite protect registers at the beginning of every round
 	FirstCorIndexValid = 0;
 	FirstCorIndex = 0;
@@ -242,29 +280,58 @@ int CCorrelator::Correlation(int SampleNumber, complex_int SampleData[], S16 Dum
 		CoherentDone |= ProcessOverflow(DumpDataI, DumpDataQ, CorIndex, DumpDataLength);
 		JumpCount --;
 	}
+}
+
+// CorrelateSamples() processes next SampleNumber samples of the round, dump data appended after DumpDataLength
+void CCorrelator::CorrelateSamples(int SampleNumber, complex_int SampleData[], S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int &DumpDataLength)
+{
+	int i, j, BlockLength;
+	unsigned int CodePhaseNew;
+
 	// second check whether there is negative jump, skip sample
-	for (i = 0; i < SampleNumber; i ++)
+	// samples are down converted and accumulated a block at a time by vectorized kernels,
+	// accumulation is flushed before any correlator is dumped so the result is identical to sample by sample processing
+	for (i = 0; i < SampleNumber; i += BlockLength)
 	{
-		SampleDown = DownConvert(SampleData[i]);
-		if (JumpCount >= 0)
-			AccumulateSample(SampleDown, 8);
-		CodePhaseNew = CodePhase + CodeFreq;
-		if (CodePhaseNew < CodePhase)	// code overflow
+		BlockLength = (SampleNumber - i > CORRELATOR_BLOCK_SIZE) ? CORRELATOR_BLOCK_SIZE : (SampleNumber - i);
+		DownConvertBlock(SampleData + i, BlockLength);
+		UpdatePrnValue();
+		PendingStart = PendingEnd = 0;
+		for (j = 0; j < BlockLength; j ++)
 		{
-			if (JumpCount < 0)
-				JumpCount ++;
-			else
-				CoherentDone |= ProcessOverflow(DumpDataI, DumpDataQ, CorIndex, DumpDataLength);
-			DEBUG_PRINT(" 1");
+			if (JumpCount >= 0)
+			{
+				PrnValueBuffer[j] = (unsigned char)PrnValueTable[CodePhase >> 30];
+				PendingEnd = j + 1;
+				if (NoiseCalc)
+					NoiseCalc->AccumulateSample(complex_int((S16)SampleIQ[j], (S16)(SampleIQ[j] >> 16)));
+			}
+			else	// skipped sample breaks pending samples
+			{
+				FlushAccumulation();
+				PendingStart = PendingEnd = j + 1;
+			}
+			CodePhaseNew = CodePhase + CodeFreq;
+			if (CodePhaseNew < CodePhase)	// code overflow
+			{
+				if (JumpCount < 0)
+					JumpCount ++;
+				else
+				{
+					CoherentDone |= ProcessOverflow(DumpDataI, DumpDataQ, CorIndex, DumpDataLength);
+					UpdatePrnValue();
+				}
+			}
+			CodePhase = CodePhaseNew;
 		}
-		else
-			DEBUG_PRINT(" 0");
-		DEBUG_PRINT(" %1d", Dumping);
-		DEBUG_PRINT(" %6d", AccDataI[4]);
-		DEBUG_PRINT(" %08x\n", CodePhaseNew);
-		CodePhase = CodePhaseNew;
+		FlushAccumulation();
 	}
+	PendingStart = PendingEnd = 0;
+}
 
+// FinishCorrelation() ends the round, return 1 means any correlator reaches last coherent sum
+int CCorrelator::FinishCorrelation(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int &DumpDataLength)
+{
 	if (DumpDataOutput)
 		DumpDataOutput(DumpDataI, DumpDataQ, CorIndex, DumpDataLength);
 
@@ -275,6 +342,49 @@ int CCorrelator::Correlation(int SampleNumber, complex_int SampleData[], S16 Dum
 void CCorrelator::AccumulateSample(complex_int Sample, int CorCount)
 {
 	int j, BitMask;
+	unsigned int PrnValue = GetPrnValue(CodePhase);
+
+	DEBUG_PRINT("%3d %3d", Sample.real, Sample.imag);
+	for (j = 0, BitMask = 1; j < CorCount; j ++, BitMask <<= 1)
+	{
+		DEBUG_PRINT(" %1d", (PrnValue & BitMask) ? 1 : 0);
+		if (PrnValue & BitMask)
+		{
+			AccDataI[j] -= (S16)Sample.real;
+			AccDataQ[j] -= (S16)Sample.imag;
+		}
+		else
+		{
+			AccDataI[j] += (S16)Sample.real;
+			AccDataQ[j] += (S16)Sample.imag;
+		}
+	}
+	if (NoiseCalc)
+		NoiseCalc->AccumulateSample(Sample);
+//	printf("%1d %1x %04x %04x\n", PrnGen2[PrnIndex]->GetCode(), (PrnCode2 & 0x10) >> 4, AccDataI[0] & 0xffff, AccDataQ[0] & 0xffff);
+}
+
+// Down convert a block of samples into SampleIQ and advance carrier NCO by SampleNumber
+void CCorrelator::DownConvertBlock(complex_int SampleData[], int SampleNumber)
+{
+	unsigned long long PhaseSum;
+	unsigned int CarryCount;
+
+	DownConvertSamples(SampleData, SampleNumber, CarrierPhase, CarrierFreq, PreShiftBits, SampleIQ);
+
+	// same CarrierCount result as calling DownConvert() SampleNumber times
+	PhaseSum = (unsigned long long)CarrierPhase + (unsigned long long)CarrierFreq * SampleNumber;
+	CarryCount = (unsigned int)(PhaseSum >> 32);
+	if (CarrierFreq & 0x80000000)	// negative freq decrease carrier count on each step without carry
+		CarrierCount -= SampleNumber - CarryCount;
+	else
+		CarrierCount += CarryCount;
+	CarrierPhase = (unsigned int)PhaseSum;
+}
+
+// Get PRN bits of 8 correlators, Phase is CodePhase to determine narrow correlator position
+unsigned int CCorrelator::GetPrnValue(unsigned int Phase)
+{
 	unsigned int PrnValue;
 	int Advance4, Lag4;
 	int Advance8, Lag8;
@@ -282,13 +392,12 @@ void CCorrelator::AccumulateSample(complex_int Sample, int CorCount)
 	int PromptBit = (PrnCode & (1 << 4)) ? 1 : 0;
 	int LagBit = (PrnCode & (1 << 5)) ? 1 : 0;
 
-	DEBUG_PRINT("%3d %3d", Sample.real, Sample.imag);
 	if (NarrowFactor)
 	{
-		Advance4 = (CodePhase & 0x80000000) ? 1 : 0;
-		Lag4 = (CodePhase & 0x80000000) ? 0 : 1;
-		Advance8 = ((~CodePhase) & 0xc0000000) ? 0 : 1;
-		Lag8 = (CodePhase & 0xc0000000) ? 0 : 1;
+		Advance4 = (Phase & 0x80000000) ? 1 : 0;
+		Lag4 = (Phase & 0x80000000) ? 0 : 1;
+		Advance8 = ((~Phase) & 0xc0000000) ? 0 : 1;
+		Lag8 = (Phase & 0xc0000000) ? 0 : 1;
 		if (NarrowFactor == 1)
 		{
 			PrnValue = PrnCode & 0x93;	// 8'b10010011, clear bit 2,3,5,6
@@ -312,23 +421,25 @@ void CCorrelator::AccumulateSample(complex_int Sample, int CorCount)
 		PrnValue = PrnCode;
 	if (EnableSecondPrn)	// use second PRN code at cor0
 		PrnValue = (PrnValue & ~0x1) | ((PrnCode2 >> 4) & 0x1);
-	for (j = 0, BitMask = 1; j < CorCount; j ++, BitMask <<= 1)
-	{
-		DEBUG_PRINT(" %1d", (PrnValue & BitMask) ? 1 : 0);
-		if (PrnValue & BitMask)
-		{
-			AccDataI[j] -= (S16)Sample.real;
-			AccDataQ[j] -= (S16)Sample.imag;
-		}
-		else
-		{
-			AccDataI[j] += (S16)Sample.real;
-			AccDataQ[j] += (S16)Sample.imag;
-		}
-	}
-	if (NoiseCalc)
-		NoiseCalc->AccumulateSample(Sample);
-//	printf("%1d %1x %04x %04x\n", PrnGen2[PrnIndex]->GetCode(), (PrnCode2 & 0x10) >> 4, AccDataI[0] & 0xffff, AccDataQ[0] & 0xffff);
+
+	return PrnValue & 0xff;
+}
+
+// PrnCode and PrnCode2 only change on code overflow, so PrnValue within one code sub-phase only depends on 2MSB of CodePhase
+void CCorrelator::UpdatePrnValue()
+{
+	int i;
+
+	for (i = 0; i < 4; i ++)
+		PrnValueTable[i] = GetPrnValue(i << 30);
+}
+
+// Accumulate pending samples to AccDataI and AccDataQ
+void CCorrelator::FlushAccumulation()
+{
+	if (PendingEnd > PendingStart)
+		AccumulateSamples(SampleIQ + PendingStart, PrnValueBuffer + PendingStart, PendingEnd - PendingStart, AccDataI, AccDataQ);
+	PendingStart = PendingEnd;
 }
 
 // Processing when overflow is high
@@ -343,7 +454,7 @@ int CCorrelator::ProcessOverflow(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[
 	CodeSubPhase = 1 - CodeSubPhase;
 	if (CodeSubPhase == 0)
 	{
-		if (PrnGen[PrnIndex]->ShiftCode())
+		if (ShiftPrnCode())
 		{
 			if (NHLength)
 			{
@@ -353,7 +464,7 @@ int CCorrelator::ProcessOverflow(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[
 			}
 		}
 		if (EnableSecondPrn)
-			PrnGen2[PrnIndex2]->ShiftCode();
+			ShiftPrnCode2();
 		// increase DumpCount
 		if (++DumpCount == DumpLength)
 		{
@@ -366,16 +477,17 @@ int CCorrelator::ProcessOverflow(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[
 
 	// shift PrnCode
 	PrnCode <<= 1;
-	PrnCode |= PrnGen[PrnIndex]->GetCode() ^ (EnableBOC & CodeSubPhase) ^ ((NHLength && (NHCode & (1 << NHCount))) ? 1 : 0);
+	PrnCode |= GetPrnCode() ^ (EnableBOC & CodeSubPhase) ^ ((NHLength && (NHCode & (1 << NHCount))) ? 1 : 0);
 	if (EnableSecondPrn)
 	{
 		PrnCode2 <<= 1;
-		PrnCode2 |= PrnGen2[PrnIndex2]->GetCode() ^ (EnableBOC & CodeSubPhase);
+		PrnCode2 |= GetPrnCode2() ^ (EnableBOC & CodeSubPhase);
 	}
 
 	// Check whether there is data to dump when overflow is high
 	if (Dumping)
 	{
+		FlushAccumulation();	// dumped value should include all samples before overflow
 		DataReady = DumpData(DumpDataI, DumpDataQ, CorIndex, CurrentLength);
 	}
 
@@ -404,7 +516,7 @@ int CCorrelator::DumpData(S16 DumpDataI[], S16 DumpDataQ[], int CorIndex[], int
 			FirstCorIndexValid = 1;
 			FirstCorIndex = CurrentCor;
 		}
-		else if (FirstCorIndex == CurrentCor && CoherentCount == 0)
+		else if (FirstCorIndex == (int)CurrentCor && CoherentCount == 0)
 		{
 			OverwriteProtect = 1;
 		}
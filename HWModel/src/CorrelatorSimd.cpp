@@ -0,0 +1,378 @@
+//----------------------------------------------------------------------
+// CorrelatorSimd.cpp:
+//   Implementation of vectorized correlator kernels with runtime dispatch
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include "CommonOps.h"
+#include "Correlator.h"
+#include "CorrelatorSimd.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CORRELATOR_SIMD_X86
+#include <immintrin.h>
+#if defined _MSC_VER
+#include <intrin.h>
+#define SIMD_TARGET(isa)
+#else
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+static void DownConvertScalar(const complex_int SampleData[], int SampleNumber, unsigned int CarrierPhase, unsigned int CarrierFreq, int PreShiftBits, unsigned int SampleIQ[]);
+static void AccumulateScalar(const unsigned int SampleIQ[], const unsigned char PrnValue[], int SampleNumber, S16 AccDataI[8], S16 AccDataQ[8]);
+static void DownConvertAuto(const complex_int SampleData[], int SampleNumber, unsigned int CarrierPhase, unsigned int CarrierFreq, int PreShiftBits, unsigned int SampleIQ[]);
+static void AccumulateAuto(const unsigned int SampleIQ[], const unsigned char PrnValue[], int SampleNumber, S16 AccDataI[8], S16 AccDataQ[8]);
+
+// kernels select implementation on first call
+DownConvertKernel DownConvertSamples = DownConvertAuto;
+AccumulateKernel AccumulateSamples = AccumulateAuto;
+static int SimdLevel = -1;
+
+// sign mask for each PrnValue, one S16 for I and one S16 for Q of each correlator, 0 to add and -1 to subtract
+static S16 AccMaskTable[256][16];
+
+static void InitMaskTable()
+{
+	int i, j;
+
+	for (i = 0; i < 256; i ++)
+		for (j = 0; j < 8; j ++)
+			AccMaskTable[i][j*2] = AccMaskTable[i][j*2+1] = (i & (1 << j)) ? -1 : 0;
+}
+
+//----------------------------------------------------------------------
+// scalar reference, same arithmetic as CCorrelator::DownConvert() and CCorrelator::AccumulateSample()
+//----------------------------------------------------------------------
+static void DownConvertScalar(const complex_int SampleData[], int SampleNumber, unsigned int CarrierPhase, unsigned int CarrierFreq, int PreShiftBits, unsigned int SampleIQ[])
+{
+	int i;
+	complex_int MulResult;
+
+	for (i = 0; i < SampleNumber; i ++, CarrierPhase += CarrierFreq)
+	{
+		MulResult = complex_int(SampleData[i].real, SampleData[i].imag) * CCorrelator::DownConvertTable[CarrierPhase >> 26];
+		switch (PreShiftBits)
+		{
+		case 0:
+			MulResult.real = CONVERGENT_ROUND_SHIFT(MulResult.real, 3);
+			MulResult.imag = CONVERGENT_ROUND_SHIFT(MulResult.imag, 3);
+			break;
+		case 1:
+			MulResult.real = CONVERGENT_ROUND_SHIFT(MulResult.real, 4);
+			MulResult.imag = CONVERGENT_ROUND_SHIFT(MulResult.imag, 4);
+			break;
+		case 2:
+			MulResult.real = CONVERGENT_ROUND_SHIFT(MulResult.real, 5);
+			MulResult.imag = CONVERGENT_ROUND_SHIFT(MulResult.imag, 5);
+			break;
+		default:
+			MulResult.real >>= 3;
+			MulResult.imag >>= 3;
+			break;
+		}
+		if (MulResult.real > 31)
+			MulResult.real = 31;
+		else if (MulResult.real < -31)
+			MulResult.real = -31;
+		if (MulResult.imag > 31)
+			MulResult.imag = 31;
+		else if (MulResult.imag < -31)
+			MulResult.imag = -31;
+		SampleIQ[i] = ((unsigned int)MulResult.real & 0xffff) | ((unsigned int)MulResult.imag << 16);
+	}
+}
+
+static void AccumulateScalar(const unsigned int SampleIQ[], const unsigned char PrnValue[], int SampleNumber, S16 AccDataI[8], S16 AccDataQ[8])
+{
+	int i, j;
+	S16 SampleI, SampleQ;
+
+	for (i = 0; i < SampleNumber; i ++)
+	{
+		SampleI = (S16)SampleIQ[i];
+		SampleQ = (S16)(SampleIQ[i] >> 16);
+		for (j = 0; j < 8; j ++)
+		{
+			if (PrnValue[i] & (1 << j))
+			{
+				AccDataI[j] -= SampleI;
+				AccDataQ[j] -= SampleQ;
+			}
+			else
+			{
+				AccDataI[j] += SampleI;
+				AccDataQ[j] += SampleQ;
+			}
+		}
+	}
+}
+
+#if defined CORRELATOR_SIMD_X86
+//----------------------------------------------------------------------
+// SSE4.1 kernels, 4 samples per round for down conversion, 8 correlators in two registers
+//----------------------------------------------------------------------
+// convergent round shift of 32bit lanes, RoundBit is 1 << (Shift-1)
+SIMD_TARGET("sse4.1") static inline __m128i ConvergentRoundShift128(__m128i Data, __m128i Shift, __m128i ShiftMinus1, __m128i RoundMask, __m128i RoundBit)
+{
+	__m128i RoundFlag = _mm_and_si128(_mm_sra_epi32(Data, ShiftMinus1), _mm_set1_epi32(1));
+	__m128i EvenFlag = _mm_cmpeq_epi32(_mm_and_si128(Data, RoundMask), RoundBit);
+
+	return _mm_add_epi32(_mm_sra_epi32(Data, Shift), _mm_andnot_si128(EvenFlag, RoundFlag));
+}
+
+SIMD_TARGET("sse4.1") static void DownConvertSse41(const complex_int SampleData[], int SampleNumber, unsigned int CarrierPhase, unsigned int CarrierFreq, int PreShiftBits, unsigned int SampleIQ[])
+{
+	int i, Shift = (PreShiftBits == 3) ? 3 : PreShiftBits + 3;
+	__m128i Shift128 = _mm_cvtsi32_si128(Shift), ShiftMinus1 = _mm_cvtsi32_si128(Shift - 1);
+	__m128i RoundMask = _mm_set1_epi32((1 << (Shift + 1)) - 1), RoundBit = _mm_set1_epi32(1 << (Shift - 1));
+	__m128i Max = _mm_set1_epi32(31), Min = _mm_set1_epi32(-31);
+	__m128i Phase = _mm_setr_epi32(CarrierPhase, CarrierPhase + CarrierFreq, CarrierPhase + CarrierFreq * 2, CarrierPhase + CarrierFreq * 3);
+	__m128i PhaseStep = _mm_set1_epi32(CarrierFreq * 4);
+	__m128i Data0, Data1, InputI, InputQ, Index, TableI, TableQ, ResultI, ResultQ;
+	const complex_int *Table = CCorrelator::DownConvertTable;
+	int Index0, Index1, Index2, Index3;
+
+	for (i = 0; i + 4 <= SampleNumber; i += 4)
+	{
+		// split I/Q of 4 input samples
+		Data0 = _mm_loadu_si128((const __m128i *)(SampleData + i));
+		Data1 = _mm_loadu_si128((const __m128i *)(SampleData + i + 2));
+		InputI = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(Data0), _mm_castsi128_ps(Data1), _MM_SHUFFLE(2, 0, 2, 0)));
+		InputQ = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(Data0), _mm_castsi128_ps(Data1), _MM_SHUFFLE(3, 1, 3, 1)));
+		// look up local carrier
+		Index = _mm_srli_epi32(Phase, 26);
+		Index0 = _mm_cvtsi128_si32(Index);
+		Index1 = _mm_extract_epi32(Index, 1);
+		Index2 = _mm_extract_epi32(Index, 2);
+		Index3 = _mm_extract_epi32(Index, 3);
+		TableI = _mm_setr_epi32(Table[Index0].real, Table[Index1].real, Table[Index2].real, Table[Index3].real);
+		TableQ = _mm_setr_epi32(Table[Index0].imag, Table[Index1].imag, Table[Index2].imag, Table[Index3].imag);
+		Phase = _mm_add_epi32(Phase, PhaseStep);
+		// complex multiply
+		ResultI = _mm_sub_epi32(_mm_mullo_epi32(InputI, TableI), _mm_mullo_epi32(InputQ, TableQ));
+		ResultQ = _mm_add_epi32(_mm_mullo_epi32(InputI, TableQ), _mm_mullo_epi32(InputQ, TableI));
+		// shift and saturate to 6bit
+		if (PreShiftBits == 3)
+		{
+			ResultI = _mm_srai_epi32(ResultI, 3);
+			ResultQ = _mm_srai_epi32(ResultQ, 3);
+		}
+		else
+		{
+			ResultI = ConvergentRoundShift128(ResultI, Shift128, ShiftMinus1, RoundMask, RoundBit);
+			ResultQ = ConvergentRoundShift128(ResultQ, Shift128, ShiftMinus1, RoundMask, RoundBit);
+		}
+		ResultI = _mm_max_epi32(_mm_min_epi32(ResultI, Max), Min);
+		ResultQ = _mm_max_epi32(_mm_min_epi32(ResultQ, Max), Min);
+		// interleave I/Q into 16bit pairs
+		_mm_storeu_si128((__m128i *)(SampleIQ + i), _mm_unpacklo_epi16(_mm_packs_epi32(ResultI, ResultI), _mm_packs_epi32(ResultQ, ResultQ)));
+	}
+	if (i < SampleNumber)
+		DownConvertScalar(SampleData + i, SampleNumber - i, CarrierPhase + CarrierFreq * i, CarrierFreq, PreShiftBits, SampleIQ + i);
+}
+
+SIMD_TARGET("sse4.1") static void AccumulateSse41(const unsigned int SampleIQ[], const unsigned char PrnValue[], int SampleNumber, S16 AccDataI[8], S16 AccDataQ[8])
+{
+	int i;
+	__m128i AccI = _mm_loadu_si128((const __m128i *)AccDataI), AccQ = _mm_loadu_si128((const __m128i *)AccDataQ);
+	__m128i Acc0 = _mm_unpacklo_epi16(AccI, AccQ), Acc1 = _mm_unpackhi_epi16(AccI, AccQ);	// I/Q interleaved for Cor0~3 and Cor4~7
+	__m128i Sample, Mask0, Mask1;
+
+	for (i = 0; i < SampleNumber; i ++)
+	{
+		Sample = _mm_set1_epi32((int)SampleIQ[i]);
+		Mask0 = _mm_loadu_si128((const __m128i *)AccMaskTable[PrnValue[i]]);
+		Mask1 = _mm_loadu_si128((const __m128i *)(AccMaskTable[PrnValue[i]] + 8));
+		// (Sample ^ Mask) - Mask negates Sample where Mask is -1
+		Acc0 = _mm_add_epi16(Acc0, _mm_sub_epi16(_mm_xor_si128(Sample, Mask0), Mask0));
+		Acc1 = _mm_add_epi16(Acc1, _mm_sub_epi16(_mm_xor_si128(Sample, Mask1), Mask1));
+	}
+	// de-interleave back to I and Q
+	Acc0 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(Acc0, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+	Acc1 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(Acc1, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+	Acc0 = _mm_shuffle_epi32(Acc0, _MM_SHUFFLE(3, 1, 2, 0));
+	Acc1 = _mm_shuffle_epi32(Acc1, _MM_SHUFFLE(3, 1, 2, 0));
+	_mm_storeu_si128((__m128i *)AccDataI, _mm_unpacklo_epi64(Acc0, Acc1));
+	_mm_storeu_si128((__m128i *)AccDataQ, _mm_unpackhi_epi64(Acc0, Acc1));
+}
+
+//----------------------------------------------------------------------
+// AVX2 kernels, 8 samples per round for down conversion, 8 correlators of I/Q in one register
+//----------------------------------------------------------------------
+SIMD_TARGET("avx2") static inline __m256i ConvergentRoundShift256(__m256i Data, __m128i Shift, __m128i ShiftMinus1, __m256i RoundMask, __m256i RoundBit)
+{
+	__m256i RoundFlag = _mm256_and_si256(_mm256_sra_epi32(Data, ShiftMinus1), _mm256_set1_epi32(1));
+	__m256i EvenFlag = _mm256_cmpeq_epi32(_mm256_and_si256(Data, RoundMask), RoundBit);
+
+	return _mm256_add_epi32(_mm256_sra_epi32(Data, Shift), _mm256_andnot_si256(EvenFlag, RoundFlag));
+}
+
+SIMD_TARGET("avx2") static void DownConvertAvx2(const complex_int SampleData[], int SampleNumber, unsigned int CarrierPhase, unsigned int CarrierFreq, int PreShiftBits, unsigned int SampleIQ[])
+{
+	int i, Shift = (PreShiftBits == 3) ? 3 : PreShiftBits + 3;
+	__m128i Shift128 = _mm_cvtsi32_si128(Shift), ShiftMinus1 = _mm_cvtsi32_si128(Shift - 1);
+	__m256i RoundMask = _mm256_set1_epi32((1 << (Shift + 1)) - 1), RoundBit = _mm256_set1_epi32(1 << (Shift - 1));
+	__m256i Max = _mm256_set1_epi32(31), Min = _mm256_set1_epi32(-31);
+	__m256i Phase = _mm256_add_epi32(_mm256_set1_epi32(CarrierPhase), _mm256_mullo_epi32(_mm256_set1_epi32(CarrierFreq), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+	__m256i PhaseStep = _mm256_set1_epi32(CarrierFreq * 8);
+	__m256i SplitIQ = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+	__m256i Data0, Data1, InputI, InputQ, Index, TableI, TableQ, ResultI, ResultQ;
+	__m128i Packed;
+	const int *Table = (const int *)CCorrelator::DownConvertTable;
+
+	for (i = 0; i + 8 <= SampleNumber; i += 8)
+	{
+		// split I/Q of 8 input samples
+		Data0 = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(SampleData + i)), SplitIQ);
+		Data1 = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(SampleData + i + 4)), SplitIQ);
+		InputI = _mm256_permute2x128_si256(Data0, Data1, 0x20);
+		InputQ = _mm256_permute2x128_si256(Data0, Data1, 0x31);
+		// look up local carrier, each table entry has two int
+		Index = _mm256_slli_epi32(_mm256_srli_epi32(Phase, 26), 1);
+		TableI = _mm256_i32gather_epi32(Table, Index, 4);
+		TableQ = _mm256_i32gather_epi32(Table + 1, Index, 4);
+		Phase = _mm256_add_epi32(Phase, PhaseStep);
+		// complex multiply
+		ResultI = _mm256_sub_epi32(_mm256_mullo_epi32(InputI, TableI), _mm256_mullo_epi32(InputQ, TableQ));
+		ResultQ = _mm256_add_epi32(_mm256_mullo_epi32(InputI, TableQ), _mm256_mullo_epi32(InputQ, TableI));
+		// shift and saturate to 6bit
+		if (PreShiftBits == 3)
+		{
+			ResultI = _mm256_srai_epi32(ResultI, 3);
+			ResultQ = _mm256_srai_epi32(ResultQ, 3);
+		}
+		else
+		{
+			ResultI = ConvergentRoundShift256(ResultI, Shift128, ShiftMinus1, RoundMask, RoundBit);
+			ResultQ = ConvergentRoundShift256(ResultQ, Shift128, ShiftMinus1, RoundMask, RoundBit);
+		}
+		ResultI = _mm256_max_epi32(_mm256_min_epi32(ResultI, Max), Min);
+		ResultQ = _mm256_max_epi32(_mm256_min_epi32(ResultQ, Max), Min);
+		// pack to 16bit (in-lane) and interleave I/Q
+		ResultI = _mm256_packs_epi32(ResultI, ResultQ);	// I0~3 Q0~3 | I4~7 Q4~7
+		Packed = _mm256_castsi256_si128(ResultI);
+		_mm_storeu_si128((__m128i *)(SampleIQ + i), _mm_unpacklo_epi16(Packed, _mm_unpackhi_epi64(Packed, Packed)));
+		Packed = _mm256_extracti128_si256(ResultI, 1);
+		_mm_storeu_si128((__m128i *)(SampleIQ + i + 4), _mm_unpacklo_epi16(Packed, _mm_unpackhi_epi64(Packed, Packed)));
+	}
+	if (i < SampleNumber)
+		DownConvertScalar(SampleData + i, SampleNumber - i, CarrierPhase + CarrierFreq * i, CarrierFreq, PreShiftBits, SampleIQ + i);
+}
+
+SIMD_TARGET("avx2") static void AccumulateAvx2(const unsigned int SampleIQ[], const unsigned char PrnValue[], int SampleNumber, S16 AccDataI[8], S16 AccDataQ[8])
+{
+	int i;
+	__m128i AccI = _mm_loadu_si128((const __m128i *)AccDataI), AccQ = _mm_loadu_si128((const __m128i *)AccDataQ);
+	__m256i Acc = _mm256_setr_m128i(_mm_unpacklo_epi16(AccI, AccQ), _mm_unpackhi_epi16(AccI, AccQ));	// I/Q interleaved for Cor0~7
+	__m256i Sample, Mask;
+	__m128i Acc0, Acc1;
+
+	for (i = 0; i < SampleNumber; i ++)
+	{
+		Sample = _mm256_set1_epi32((int)SampleIQ[i]);
+		Mask = _mm256_loadu_si256((const __m256i *)AccMaskTable[PrnValue[i]]);
+		// (Sample ^ Mask) - Mask negates Sample where Mask is -1
+		Acc = _mm256_add_epi16(Acc, _mm256_sub_epi16(_mm256_xor_si256(Sample, Mask), Mask));
+	}
+	// de-interleave back to I and Q
+	Acc = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(Acc, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+	Acc = _mm256_shuffle_epi32(Acc, _MM_SHUFFLE(3, 1, 2, 0));
+	Acc0 = _mm256_castsi256_si128(Acc);
+	Acc1 = _mm256_extracti128_si256(Acc, 1);
+	_mm_storeu_si128((__m128i *)AccDataI, _mm_unpacklo_epi64(Acc0, Acc1));
+	_mm_storeu_si128((__m128i *)AccDataQ, _mm_unpackhi_epi64(Acc0, Acc1));
+}
+#endif
+
+//----------------------------------------------------------------------
+// runtime dispatch
+//----------------------------------------------------------------------
+static void DownConvertAuto(const complex_int SampleData[], int SampleNumber, unsigned int CarrierPhase, unsigned int CarrierFreq, int PreShiftBits, unsigned int SampleIQ[])
+{
+	SetSimdLevel(GetCpuSimdLevel());
+	DownConvertSamples(SampleData, SampleNumber, CarrierPhase, CarrierFreq, PreShiftBits, SampleIQ);
+}
+
+static void AccumulateAuto(const unsigned int SampleIQ[], const unsigned char PrnValue[], int SampleNumber, S16 AccDataI[8], S16 AccDataQ[8])
+{
+	SetSimdLevel(GetCpuSimdLevel());
+	AccumulateSamples(SampleIQ, PrnValue, SampleNumber, AccDataI, AccDataQ);
+}
+
+// return highest kernel level supported by CPU and OS
+int GetCpuSimdLevel()
+{
+#if defined CORRELATOR_SIMD_X86
+#if defined _MSC_VER
+	int CpuInfo[4];
+	int Level = SIMD_LEVEL_SCALAR;
+
+	__cpuid(CpuInfo, 0);
+	if (CpuInfo[0] < 1)
+		return Level;
+	__cpuid(CpuInfo, 1);
+	if (CpuInfo[2] & (1 << 19))
+		Level = SIMD_LEVEL_SSE41;
+	// AVX2 needs OSXSAVE and OS saving YMM state
+	if (Level == SIMD_LEVEL_SSE41 && (CpuInfo[2] & (1 << 27)) && ((_xgetbv(0) & 6) == 6))
+	{
+		__cpuidex(CpuInfo, 7, 0);
+		if (CpuInfo[1] & (1 << 5))
+			Level = SIMD_LEVEL_AVX2;
+	}
+	return Level;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return SIMD_LEVEL_AVX2;
+	if (__builtin_cpu_supports("sse4.1"))
+		return SIMD_LEVEL_SSE41;
+	return SIMD_LEVEL_SCALAR;
+#endif
+#else
+	return SIMD_LEVEL_SCALAR;
+#endif
+}
+
+// select kernel level, return the level actually used
+int SetSimdLevel(int Level)
+{
+	int CpuLevel = GetCpuSimdLevel();
+
+	if (SimdLevel < 0)
+		InitMaskTable();
+	if (Level > CpuLevel)
+		Level = CpuLevel;
+	if (Level < SIMD_LEVEL_SCALAR)
+		Level = SIMD_LEVEL_SCALAR;
+	switch (Level)
+	{
+#if defined CORRELATOR_SIMD_X86
+	case SIMD_LEVEL_AVX2:
+		DownConvertSamples = DownConvertAvx2;
+		AccumulateSamples = AccumulateAvx2;
+		break;
+	case SIMD_LEVEL_SSE41:
+		DownConvertSamples = DownConvertSse41;
+		AccumulateSamples = AccumulateSse41;
+		break;
+#endif
+	default:
+		DownConvertSamples = DownConvertScalar;
+		AccumulateSamples = AccumulateScalar;
+		break;
+	}
+	SimdLevel = Level;
+
+	return Level;
+}
+
+int GetSimdLevel()
+{
+	if (SimdLevel < 0)
+		SetSimdLevel(GetCpuSimdLevel());
+	return SimdLevel;
+}
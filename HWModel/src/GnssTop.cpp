@@ -13,6 +13,7 @@
 #include "RegAddress.h"
 #include "GnssTop.h"
 #include "E1_code.h"
+#include "ModelProfile.h"
 
 CGnssTop::CGnssTop() : TeFifo(0, 10240), TrackingEngine(&TeFifo, MemCodeBuffer), AcqEngine(MemCodeBuffer)
 {
@@ -179,25 +180,97 @@ U32 CGnssTop::GetRegValue(int Address)
 	}
 }
 
+// burst write of consecutive DWORDs, TE buffer and AE buffer are copied directly
+// register space or range crossing end of buffer is written one by one
+void CGnssTop::SetRegBurst(int Address, const U32 *Buffer, int WordNumber)
+{
+	int i, Index = (Address & 0xfff) >> 2;
+
+	switch (Address & 0xf000)
+	{
+	case ADDR_BASE_TE_BUFFER:
+		if (Index + WordNumber <= TE_BUFFER_SIZE / 4)
+		{
+			memcpy(TrackingEngine.TEBuffer + Index, Buffer, WordNumber * sizeof(U32));
+			return;
+		}
+		break;
+	case ADDR_BASE_AE_BUFFER:
+		if (Index + WordNumber <= MAX_CHANNEL * CHANNEL_CONFIG_LEN)
+		{
+			memcpy(&AcqEngine.ChannelConfig[0][0] + Index, Buffer, WordNumber * sizeof(U32));
+			return;
+		}
+		break;
+	default:
+		break;
+	}
+	for (i = 0; i < WordNumber; i ++)
+		SetRegValue(Address + i * 4, Buffer[i]);
+}
+
+// burst read of consecutive DWORDs, same address handling as SetRegBurst()
+void CGnssTop::GetRegBurst(int Address, U32 *Buffer, int WordNumber)
+{
+	int i, Index = (Address & 0xfff) >> 2;
+
+	switch (Address & 0xf000)
+	{
+	case ADDR_BASE_TE_BUFFER:
+		if (Index + WordNumber <= TE_BUFFER_SIZE / 4)
+		{
+			memcpy(Buffer, TrackingEngine.TEBuffer + Index, WordNumber * sizeof(U32));
+			return;
+		}
+		break;
+	case ADDR_BASE_AE_BUFFER:
+		if (Index + WordNumber <= MAX_CHANNEL * CHANNEL_CONFIG_LEN)
+		{
+			memcpy(Buffer, &AcqEngine.ChannelConfig[0][0] + Index, WordNumber * sizeof(U32));
+			return;
+		}
+		break;
+	default:
+		break;
+	}
+	for (i = 0; i < WordNumber; i ++)
+		Buffer[i] = GetRegValue(Address + i * 4);
+}
+
 int CGnssTop::Process(int ReadBlockSize)
 {
-	int i;
 	int ReachThreshold = 0;
 	int SampleNumber;
+	U32 LastFlag;
 
+	// return -1 at end of file and -2 on read error
+	PROFILE_START(PROFILE_STAGE_IF_READ);
 	if (!IfFile.ReadFile(ReadBlockSize, FileData))
-		return -1;
+	{
+		PROFILE_STOP(PROFILE_STAGE_IF_READ);
+		return (IfFile.GetReadStatus() == IF_READ_END) ? -1 : -2;
+	}
+	PROFILE_STOP(PROFILE_STAGE_IF_READ);
+	PROFILE_COUNT(PROFILE_COUNT_SAMPLE, ReadBlockSize);
 	if (AcqEngine.IsFillingBuffer())
 	{
+		PROFILE_START(PROFILE_STAGE_RATE_ADAPTOR);
 		SampleNumber = AcqEngine.RateAdaptor.DoRateAdaptor(FileData, ReadBlockSize, SampleQuant);
 		AcqEngine.WriteSample(SampleNumber, SampleQuant);
+		PROFILE_STOP(PROFILE_STAGE_RATE_ADAPTOR);
 	}
-	for (i = 0; i < ReadBlockSize; i ++)
-		ReachThreshold |= TeFifo.WriteData(FileData[i]);
+	PROFILE_START(PROFILE_STAGE_TE_FIFO);
+	ReachThreshold = TeFifo.WriteBlock(ReadBlockSize, FileData);
+	PROFILE_STOP(PROFILE_STAGE_TE_FIFO);
 
+	LastFlag = InterruptFlag;
 	if (TrackingEngineEnable)
 	{
+		PROFILE_START(PROFILE_STAGE_TRACKING);
 		InterruptFlag |= TrackingEngine.ProcessData() ? 0x100 : 0;
+		PROFILE_STOP(PROFILE_STAGE_TRACKING);
+		PROFILE_COUNT(PROFILE_COUNT_CHANNEL, __builtin_popcount(TrackingEngine.ChannelEnable));
+		PROFILE_COUNT(PROFILE_COUNT_COR_SAMPLE, (long long)ReadBlockSize * __builtin_popcount(TrackingEngine.ChannelEnable));
 		MeasurementCount ++;
 		if (MeasurementCount == MeasurementNumber)
 		{
@@ -216,9 +289,18 @@ int CGnssTop::Process(int ReadBlockSize)
 		if (--AeProcessCount == 0)
 			InterruptFlag |= (1 << 11);
 	}
+	PROFILE_COUNT(PROFILE_COUNT_INT_COH, (InterruptFlag & ~LastFlag & 0x100) ? 1 : 0);
+	PROFILE_COUNT(PROFILE_COUNT_INT_MEAS, (InterruptFlag & ~LastFlag & 0x200) ? 1 : 0);
+	PROFILE_COUNT(PROFILE_COUNT_INT_REQ, (InterruptFlag & ~LastFlag & 0x400) ? 1 : 0);
+	PROFILE_COUNT(PROFILE_COUNT_INT_AE, (InterruptFlag & ~LastFlag & 0x800) ? 1 : 0);
 
 	if ((InterruptFlag & IntMask) && InterruptService != NULL )
+	{
+		PROFILE_START(PROFILE_STAGE_INTERRUPT);
 		InterruptService();
+		PROFILE_STOP(PROFILE_STAGE_INTERRUPT);
+	}
+	PROFILE_TICK();
 
 	return 0;
 }
@@ -0,0 +1,162 @@
+//----------------------------------------------------------------------
+// ModelProfile.cpp:
+//   Timing and counter instrumentation of C model implementation
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "ModelProfile.h"
+
+#define PROFILE_TICKS_PER_ROW 1000		// one CSV row for each second of signal
+
+static const char *StageName[PROFILE_STAGE_NUMBER] = {
+	"IF read", "rate adaptor", "TE FIFO write", "tracking engine", "acquisition engine",
+	"interrupt service", "baseband task", "post meas task", "in/out task",
+};
+static const char *CounterName[PROFILE_COUNTER_NUMBER] = {
+	"samples", "correlated samples", "active channels", "AE channels", "AE strides",
+	"coherent interrupts", "measurement interrupts", "request interrupts", "AE interrupts", "tasks",
+};
+
+struct ProfileData
+{
+	double StageTime[PROFILE_STAGE_NUMBER];			// second
+	long long Counter[PROFILE_COUNTER_NUMBER];
+	double RowStageTime[PROFILE_STAGE_NUMBER];		// value at last CSV row
+	long long RowCounter[PROFILE_COUNTER_NUMBER];
+	int Stack[PROFILE_MAX_DEPTH];
+	int Depth;
+	int Unmatched;		// stops with stage different from the one started
+	double StartTime;	// start time of stage on top of stack
+	long long TickCount;
+	FILE *fpCsv;
+
+	~ProfileData();
+};
+static ProfileData Profile;
+
+static double ProfileTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// time of the stage on top of stack is paused when a new stage starts
+void ProfileStart(int Stage)
+{
+	double Time = ProfileTime();
+
+	if (Profile.Depth > 0)
+		Profile.StageTime[Profile.Stack[Profile.Depth-1]] += Time - Profile.StartTime;
+	if (Profile.Depth < PROFILE_MAX_DEPTH)
+		Profile.Stack[Profile.Depth] = Stage;
+	Profile.Depth ++;
+	Profile.StartTime = Time;
+}
+
+// stage to stop should be the one on top of stack, time goes to the stage started anyway
+void ProfileStop(int Stage)
+{
+	double Time = ProfileTime();
+
+	if (Profile.Depth <= 0)
+	{
+		Profile.Unmatched ++;
+		return;
+	}
+	Profile.Depth --;
+	if (Profile.Depth < PROFILE_MAX_DEPTH)
+	{
+		if (Profile.Stack[Profile.Depth] != Stage)
+			Profile.Unmatched ++;
+		Profile.StageTime[Profile.Stack[Profile.Depth]] += Time - Profile.StartTime;
+	}
+	Profile.StartTime = Time;
+}
+
+void ProfileCount(int Counter, long long Value)
+{
+	Profile.Counter[Counter] += Value;
+}
+
+static void WriteCsvRow()
+{
+	int i;
+
+	fprintf(Profile.fpCsv, "%.3f", (double)Profile.TickCount / PROFILE_TICKS_PER_ROW);
+	for (i = 0; i < PROFILE_STAGE_NUMBER; i ++)
+	{
+		fprintf(Profile.fpCsv, ",%.3f", (Profile.StageTime[i] - Profile.RowStageTime[i]) * 1e3);
+		Profile.RowStageTime[i] = Profile.StageTime[i];
+	}
+	for (i = 0; i < PROFILE_COUNTER_NUMBER; i ++)
+	{
+		fprintf(Profile.fpCsv, ",%lld", Profile.Counter[i] - Profile.RowCounter[i]);
+		Profile.RowCounter[i] = Profile.Counter[i];
+	}
+	fprintf(Profile.fpCsv, "\n");
+}
+
+// called once for each millisecond processed, write CSV row of increments every second
+void ProfileTick()
+{
+	if (++ Profile.TickCount % PROFILE_TICKS_PER_ROW == 0 && Profile.fpCsv)
+		WriteCsvRow();
+}
+
+// open per second CSV output, stage time in ms and counter increments of each second
+// return 0 if file cannot be opened
+int ProfileSetCsv(const char *FileName)
+{
+	int i;
+
+	if (Profile.fpCsv)
+		fclose(Profile.fpCsv);
+	if ((Profile.fpCsv = fopen(FileName, "w")) == NULL)
+		return 0;
+	fprintf(Profile.fpCsv, "second");
+	for (i = 0; i < PROFILE_STAGE_NUMBER; i ++)
+		fprintf(Profile.fpCsv, ",%s (ms)", StageName[i]);
+	for (i = 0; i < PROFILE_COUNTER_NUMBER; i ++)
+		fprintf(Profile.fpCsv, ",%s", CounterName[i]);
+	fprintf(Profile.fpCsv, "\n");
+	return 1;
+}
+
+// print summary on exit if anything is recorded
+ProfileData::~ProfileData()
+{
+	if (TickCount || Counter[PROFILE_COUNT_SAMPLE])
+		ProfileSummary(stdout);
+	if (fpCsv)
+	{
+		if (TickCount % PROFILE_TICKS_PER_ROW)	// last partial second
+			WriteCsvRow();
+		fclose(fpCsv);
+	}
+}
+
+void ProfileSummary(FILE *fp)
+{
+	int i;
+	double TotalTime = 0;
+	double Ms = Profile.TickCount ? (double)Profile.TickCount : 1.;
+
+	for (i = 0; i < PROFILE_STAGE_NUMBER; i ++)
+		TotalTime += Profile.StageTime[i];
+	if (TotalTime <= 0)
+		TotalTime = 1e-9;
+
+	fprintf(fp, "profile of %lld ms processed\n", Profile.TickCount);
+	fprintf(fp, "  %-24s %12s %8s %12s\n", "stage", "time(ms)", "share", "us per ms");
+	for (i = 0; i < PROFILE_STAGE_NUMBER; i ++)
+		fprintf(fp, "  %-24s %12.3f %7.1f%% %12.3f\n", StageName[i], Profile.StageTime[i] * 1e3, Profile.StageTime[i] / TotalTime * 100, Profile.StageTime[i] * 1e6 / Ms);
+	fprintf(fp, "  %-24s %12s %8s %12s\n", "counter", "total", "", "per ms");
+	for (i = 0; i < PROFILE_COUNTER_NUMBER; i ++)
+		fprintf(fp, "  %-24s %12lld %8s %12.3f\n", CounterName[i], Profile.Counter[i], "", Profile.Counter[i] / Ms);
+	if (Profile.Unmatched)
+		fprintf(fp, "  %d stops do not match stage started, stage times are not reliable\n", Profile.Unmatched);
+}
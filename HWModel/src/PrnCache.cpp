@@ -0,0 +1,221 @@
+//----------------------------------------------------------------------
+// PrnCache.cpp:
+//   Shared packed PRN chip table cache implementation
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <malloc.h>
+#include <string.h>
+#include <mutex>
+#include "CommonOps.h"
+#include "GeneralPrn.h"
+#include "WeilPrn.h"
+#include "MemoryPrn.h"
+#include "PrnCache.h"
+
+PrnChipTable *CPrnCache::Tables[PRN_CACHE_SIZE];
+int CPrnCache::TableNumber = 0;
+// correlators on different worker threads may request tables at the same time
+static std::mutex PrnCacheMutex;
+
+// release all tables on exit
+static struct PrnCacheCleanup { ~PrnCacheCleanup() { CPrnCache::Clear(); } } PrnCacheCleanupAtExit;
+
+// Find cached table of a code sequence, build the table on first request
+// return NULL if the code sequence cannot be cached
+const PrnChipTable *CPrnCache::GetTable(int PrnType, unsigned int PrnConfig, const unsigned int PolySettings[2], unsigned int *CodeMemory)
+{
+	unsigned int NoPoly[2] = { 0, 0 };
+	unsigned int Index;
+	PrnChipTable *Table;
+	std::lock_guard<std::mutex> Lock(PrnCacheMutex);
+
+	// only keep fields that affect the code sequence
+	if (PrnType >= 2)
+		PolySettings = NoPoly;
+	if (PrnType != 3)
+		CodeMemory = NULL;
+
+	for (Index = HashKey(PrnType, PrnConfig, PolySettings, CodeMemory); Tables[Index] != NULL; Index = (Index + 1) % PRN_CACHE_SIZE)
+	{
+		Table = Tables[Index];
+		if (Table->PrnType == PrnType && Table->PrnConfig == PrnConfig && Table->PolySettings[0] == PolySettings[0] && Table->PolySettings[1] == PolySettings[1] && Table->CodeMemory == CodeMemory)
+			return Table;
+	}
+
+	// keep hash table at most 3/4 full
+	if (TableNumber >= PRN_CACHE_SIZE * 3 / 4)
+		return NULL;
+	if ((Table = BuildTable(PrnType, PrnConfig, PolySettings, CodeMemory)) == NULL)
+		return NULL;
+	Tables[Index] = Table;
+	TableNumber ++;
+
+	return Table;
+}
+
+// Get chip index of the state in StateBuffer (PrnConfig, PrnState and PrnCount words)
+// return -1 if the state is not on the cached code sequence (for example uninitialized PRN state)
+int CPrnCache::GetChipIndex(const PrnChipTable *Table, unsigned int *StateBuffer)
+{
+	int ChipIndex, CodeCount;
+
+	switch (Table->PrnType)
+	{
+	case 0:
+	case 1:	// general PRN, global count in PrnCount
+		ChipIndex = (Table->PolySettings[0] & 0x80000000) ? (int)StateBuffer[2] : (int)EXTRACT_UINT(StateBuffer[2], 14, 18);
+		break;
+	case 2:	// Weil PRN, current phase in PrnCount
+		ChipIndex = (int)EXTRACT_UINT(StateBuffer[2], 0, 14);
+		break;
+	default:	// memory PRN, skip one bit for every 1023 bits
+		CodeCount = (int)EXTRACT_UINT(StateBuffer[2], 0, 14);
+		if ((CodeCount & 0x3ff) == 0x3ff)
+			return -1;
+		ChipIndex = (CodeCount >> 10) * 1023 + (CodeCount & 0x3ff);
+		break;
+	}
+	if (ChipIndex < 0 || ChipIndex >= Table->Length)
+		return -1;
+	if (Table->StateWords[ChipIndex*2] != StateBuffer[1] || Table->StateWords[ChipIndex*2+1] != StateBuffer[2])
+		return -1;
+
+	return ChipIndex;
+}
+
+void CPrnCache::Clear()
+{
+	int i;
+	std::lock_guard<std::mutex> Lock(PrnCacheMutex);
+
+	for (i = 0; i < PRN_CACHE_SIZE; i ++)
+	{
+		if (Tables[i])
+		{
+			free(Tables[i]->Chips);
+			free(Tables[i]->StateWords);
+			free(Tables[i]);
+			Tables[i] = NULL;
+		}
+	}
+	TableNumber = 0;
+}
+
+// Generate one round of code with the same PRN generator class used by correlator
+// chips and state words are recorded before each shift so cached sequence matches CPrnGen chip by chip
+PrnChipTable *CPrnCache::BuildTable(int PrnType, unsigned int PrnConfig, const unsigned int PolySettings[2], unsigned int *CodeMemory)
+{
+	unsigned int PolyRegs[8] = { 0 };
+	unsigned int StateBuffer[3];
+	CGeneralPrn GeneralPrn(PolyRegs);
+	CWeilPrn WeilPrn;
+	CMemoryPrn MemoryPrn(CodeMemory);
+	CPrnGen *PrnGen;
+	PrnChipTable *Table;
+	int i, Length, WordNumber;
+
+	StateBuffer[0] = PrnConfig;
+	switch (PrnType)
+	{
+	case 0:
+	case 1:
+		// general PRN selects polynomial register set by PrnConfig
+		PolyRegs[PrnType * 4] = PolySettings[0];
+		PolyRegs[PrnType * 4 + 1] = PolySettings[1];
+		Length = (PolySettings[0] & 0x80000000) ? (int)PolySettings[1] : (int)EXTRACT_UINT(PolySettings[1], 14, 18);
+		if (Length <= 0 || Length > PRN_CACHE_MAX_LENGTH)
+			return NULL;
+		PrnGen = &GeneralPrn;
+		StateBuffer[1] = PrnConfig & 0x0fffffff;	// start from initial state of G1 and G2
+		StateBuffer[2] = 0;
+		PrnGen->FillState(StateBuffer);
+		break;
+	case 2:
+		Length = 10230;
+		PrnGen = &WeilPrn;
+		PrnGen->PhaseInit(PrnConfig);
+		PrnGen->DumpState(StateBuffer);
+		PrnGen->FillState(StateBuffer);
+		break;
+	default:
+		Length = (int)EXTRACT_UINT(PrnConfig, 0, 4) * 1023;
+		if (Length <= 0 || CodeMemory == NULL)
+			return NULL;
+		PrnGen = &MemoryPrn;
+		PrnGen->PhaseInit(PrnConfig);
+		PrnGen->DumpState(StateBuffer);
+		PrnGen->FillState(StateBuffer);
+		break;
+	}
+
+	Table = (PrnChipTable *)malloc(sizeof(PrnChipTable));
+	Table->PrnType = PrnType;
+	Table->PrnConfig = PrnConfig;
+	Table->PolySettings[0] = PolySettings[0];
+	Table->PolySettings[1] = PolySettings[1];
+	Table->CodeMemory = CodeMemory;
+	Table->Length = Length;
+	WordNumber = (Length + 64) / 64 + 2;
+	Table->Chips = (unsigned long long *)malloc(WordNumber * sizeof(unsigned long long));
+	Table->StateWords = (unsigned int *)malloc(Length * 2 * sizeof(unsigned int));
+	memset(Table->Chips, 0, WordNumber * sizeof(unsigned long long));
+
+	for (i = 0; i < Length; i ++)
+	{
+		PrnGen->DumpState(StateBuffer);
+		Table->StateWords[i*2] = StateBuffer[1];
+		Table->StateWords[i*2+1] = StateBuffer[2];
+		if (PrnGen->GetCode())
+			Table->Chips[i >> 6] |= 0x8000000000000000ULL >> (i & 0x3f);
+		PrnGen->ShiftCode();
+	}
+	// sequence should return to the first state after one round, otherwise do not cache
+	PrnGen->DumpState(StateBuffer);
+	if (StateBuffer[1] != Table->StateWords[0] || StateBuffer[2] != Table->StateWords[1])
+	{
+		free(Table->Chips);
+		free(Table->StateWords);
+		free(Table);
+		return NULL;
+	}
+	// append 64 chips from code start so a 64 chip word can be fetched across round boundary
+	for (i = Length; i < Length + 64; i ++)
+		if (Table->Chips[(i % Length) >> 6] & (0x8000000000000000ULL >> ((i % Length) & 0x3f)))
+			Table->Chips[i >> 6] |= 0x8000000000000000ULL >> (i & 0x3f);
+
+	return Table;
+}
+
+unsigned int CPrnCache::HashKey(int PrnType, unsigned int PrnConfig, const unsigned int PolySettings[2], unsigned int *CodeMemory)
+{
+	unsigned int Key = (unsigned int)PrnType;
+
+	Key = Key * 31 + PrnConfig;
+	Key = Key * 31 + PolySettings[0];
+	Key = Key * 31 + PolySettings[1];
+	Key = Key * 31 + (unsigned int)(size_t)CodeMemory;
+	Key ^= Key >> 16;
+	Key *= 0x45d9f3b;
+	Key ^= Key >> 16;
+
+	return Key % PRN_CACHE_SIZE;
+}
+
+// Point cursor to the chip matching PRN state in StateBuffer
+// return 0 and leave Table as NULL if the state cannot be found in cached table
+int PrnChipCursor::Attach(const PrnChipTable *ChipTable, unsigned int *StateBuffer)
+{
+	int Index;
+
+	Table = NULL;
+	if (ChipTable == NULL || (Index = CPrnCache::GetChipIndex(ChipTable, StateBuffer)) < 0)
+		return 0;
+	Table = ChipTable;
+	Seek(Index);
+
+	return 1;
+}
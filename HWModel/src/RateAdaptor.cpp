@@ -14,6 +14,11 @@
 #define OUTPUT_FILTER_DATA 0
 #define OUTPUT_QUANT_DATA 0
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RATE_ADAPTOR_SSE2
+#include <emmintrin.h>
+#endif
+
 const complex_int CRateAdaptor::DownConvertTable[64] = {
 complex_int( 12,  -1), complex_int( 12,  -2), complex_int( 12,  -3), complex_int( 11,  -4),
 complex_int( 11,  -5), complex_int( 10,  -6), complex_int( 10,  -7), complex_int(  9,  -8),
@@ -37,6 +42,7 @@ const int CRateAdaptor::CodeRateFilterCoef[CODE_RATE_FILTER_STAGE/2] = {-5, 8, 2
 
 CRateAdaptor::CRateAdaptor()
 {
+	BlockMode = 1;
 	Reset();
 }
 
@@ -48,6 +54,27 @@ void CRateAdaptor::Reset()
 }
 
 int CRateAdaptor::DoRateAdaptor(complex_int InputSignal[], int Length, unsigned char OutputSignal[])
+{
+	int Count, OutputNumber = 0;
+
+#if OUTPUT_DOWN_CONVERT_DATA || OUTPUT_FILTER_DATA || OUTPUT_QUANT_DATA
+	return DoRateAdaptorSerial(InputSignal, Length, OutputSignal);
+#endif
+	if (!BlockMode)
+		return DoRateAdaptorSerial(InputSignal, Length, OutputSignal);
+
+	while (Length > 0)
+	{
+		Count = (Length > RATE_ADAPTOR_BLOCK_SIZE) ? RATE_ADAPTOR_BLOCK_SIZE : Length;
+		OutputNumber += DoRateAdaptorBlock(InputSignal, Count, OutputSignal + OutputNumber);
+		InputSignal += Count;
+		Length -= Count;
+	}
+
+	return OutputNumber;
+}
+
+int CRateAdaptor::DoRateAdaptorSerial(complex_int InputSignal[], int Length, unsigned char OutputSignal[])
 {
 	int i;
 	int FillToNext, FillCount;
@@ -131,3 +158,115 @@ unsigned char CRateAdaptor::Quant2Bit(complex_int Sample)
 
 	return QuantSample;
 }
+
+// filter and quantize samples at all positions, Data[CODE_RATE_FILTER_STAGE-1+i] is the latest sample for output i
+static void FilterQuantScalar(const S16 DataI[], const S16 DataQ[], int Length, const int Coef[], unsigned int Threshold, unsigned char Output[])
+{
+	int i, j, FilterI, FilterQ;
+	unsigned int AbsI, AbsQ;
+
+	for (i = 0; i < Length; i ++)
+	{
+		FilterI = FilterQ = 0;
+		for (j = 0; j < CODE_RATE_FILTER_STAGE/2; j ++)
+		{
+			FilterI += (DataI[i+CODE_RATE_FILTER_STAGE-1-j] + DataI[i+j]) * Coef[j];
+			FilterQ += (DataQ[i+CODE_RATE_FILTER_STAGE-1-j] + DataQ[i+j]) * Coef[j];
+		}
+		FilterI = ROUND_SHIFT_RAW(FilterI, 6);
+		FilterQ = ROUND_SHIFT_RAW(FilterQ, 6);
+		AbsI = (FilterI < 0) ? -FilterI : FilterI;
+		AbsQ = (FilterQ < 0) ? -FilterQ : FilterQ;
+		Output[i] = ((FilterI < 0) ? 8 : 0) | ((AbsI > Threshold) ? 4 : 0) | ((FilterQ < 0) ? 2 : 0) | ((AbsQ > Threshold) ? 1 : 0);
+	}
+}
+
+#if defined RATE_ADAPTOR_SSE2
+// 8 samples in 16bit lanes, (x+32)>>6 is the same as ROUND_SHIFT_RAW(x, 6)
+static void FilterQuantSse2(const S16 DataI[], const S16 DataQ[], int Length, const int Coef[], unsigned int Threshold, unsigned char Output[])
+{
+	int i, iq;
+	__m128i Coef0 = _mm_set1_epi16((short)Coef[0]), Coef1 = _mm_set1_epi16((short)Coef[1]), Coef2 = _mm_set1_epi16((short)Coef[2]);
+	__m128i Round = _mm_set1_epi16(32), Zero = _mm_setzero_si128();
+	__m128i Thres = _mm_set1_epi16((short)(Threshold > 0x7fff ? 0x7fff : Threshold));
+	__m128i Filter, Sign, Abs, Code[2];
+	const S16 *Data;
+
+	for (i = 0; i + 8 <= Length; i += 8)
+	{
+		for (iq = 0; iq < 2; iq ++)
+		{
+			Data = (iq ? DataQ : DataI) + i;
+			Filter = _mm_mullo_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(Data + 5)), _mm_loadu_si128((const __m128i *)(Data))), Coef0);
+			Filter = _mm_add_epi16(Filter, _mm_mullo_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(Data + 4)), _mm_loadu_si128((const __m128i *)(Data + 1))), Coef1));
+			Filter = _mm_add_epi16(Filter, _mm_mullo_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(Data + 3)), _mm_loadu_si128((const __m128i *)(Data + 2))), Coef2));
+			Filter = _mm_srai_epi16(_mm_add_epi16(Filter, Round), 6);
+			Sign = _mm_cmplt_epi16(Filter, Zero);
+			Abs = _mm_sub_epi16(_mm_xor_si128(Filter, Sign), Sign);
+			// sign at bit1 and magnitude at bit0, I shifted to bit3 and bit2 later
+			Code[iq] = _mm_or_si128(_mm_and_si128(Sign, _mm_set1_epi16(2)), _mm_and_si128(_mm_cmpgt_epi16(Abs, Thres), _mm_set1_epi16(1)));
+		}
+		_mm_storel_epi64((__m128i *)(Output + i), _mm_packus_epi16(_mm_or_si128(_mm_slli_epi16(Code[0], 2), Code[1]), Zero));
+	}
+	FilterQuantScalar(DataI + i, DataQ + i, Length - i, Coef, Threshold, Output + i);
+}
+#endif
+
+// same result as DoRateAdaptorSerial(), down convert and filter every input sample in 16bit
+// then pick the samples where code rate NCO overflows
+int CRateAdaptor::DoRateAdaptorBlock(complex_int InputSignal[], int Length, unsigned char OutputSignal[])
+{
+	int i, OutputNumber;
+	unsigned int Nco;
+	complex_int Factor;
+
+	if (Length > RATE_ADAPTOR_BLOCK_SIZE)
+		return DoRateAdaptorSerial(InputSignal, Length, OutputSignal);
+	for (i = 0; i < Length; i ++)
+		if (InputSignal[i].real > RATE_ADAPTOR_MAX_INPUT || InputSignal[i].real < -RATE_ADAPTOR_MAX_INPUT || InputSignal[i].imag > RATE_ADAPTOR_MAX_INPUT || InputSignal[i].imag < -RATE_ADAPTOR_MAX_INPUT)
+			return DoRateAdaptorSerial(InputSignal, Length, OutputSignal);
+	for (i = 0; i < CODE_RATE_FILTER_STAGE; i ++)
+		if (CodeRateFilterBuffer[i].real > RATE_ADAPTOR_MAX_FILTER_INPUT || CodeRateFilterBuffer[i].real < -RATE_ADAPTOR_MAX_FILTER_INPUT || CodeRateFilterBuffer[i].imag > RATE_ADAPTOR_MAX_FILTER_INPUT || CodeRateFilterBuffer[i].imag < -RATE_ADAPTOR_MAX_FILTER_INPUT)
+			return DoRateAdaptorSerial(InputSignal, Length, OutputSignal);
+
+	// history samples in time order, CodeRateFilterBuffer[0] is the latest
+	for (i = 0; i < CODE_RATE_FILTER_STAGE; i ++)
+	{
+		BlockDataI[i] = (S16)CodeRateFilterBuffer[CODE_RATE_FILTER_STAGE-1-i].real;
+		BlockDataQ[i] = (S16)CodeRateFilterBuffer[CODE_RATE_FILTER_STAGE-1-i].imag;
+	}
+	for (i = 0; i < Length; i ++)
+	{
+		Factor = DownConvertTable[CarrierNco>>26];
+		BlockDataI[CODE_RATE_FILTER_STAGE+i] = (S16)(InputSignal[i].real * Factor.real - InputSignal[i].imag * Factor.imag);
+		BlockDataQ[CODE_RATE_FILTER_STAGE+i] = (S16)(InputSignal[i].real * Factor.imag + InputSignal[i].imag * Factor.real);
+		CarrierNco += CarrierFreq;
+	}
+
+	// output position is where code rate NCO overflows
+	Nco = CodeRateAdjustNco;
+	for (i = 0, OutputNumber = 0; i < Length; i ++)
+	{
+		Nco += CodeRateAdjustRatio;
+		if (Nco & 0x1000000)
+		{
+			BlockOutputPos[OutputNumber ++] = i;
+			Nco &= 0xffffff;
+		}
+	}
+	CodeRateAdjustNco = Nco;
+
+	// filter of input i uses samples from i+1 to i+CODE_RATE_FILTER_STAGE in block buffer
+#if defined RATE_ADAPTOR_SSE2
+	FilterQuantSse2(BlockDataI + 1, BlockDataQ + 1, Length, CodeRateFilterCoef, Threshold, BlockQuant);
+#else
+	FilterQuantScalar(BlockDataI + 1, BlockDataQ + 1, Length, CodeRateFilterCoef, Threshold, BlockQuant);
+#endif
+	for (i = 0; i < OutputNumber; i ++)
+		OutputSignal[i] = BlockQuant[BlockOutputPos[i]];
+
+	for (i = 0; i < CODE_RATE_FILTER_STAGE; i ++)
+		CodeRateFilterBuffer[i] = complex_int(BlockDataI[Length+CODE_RATE_FILTER_STAGE-1-i], BlockDataQ[Length+CODE_RATE_FILTER_STAGE-1-i]);
+
+	return OutputNumber;
+}
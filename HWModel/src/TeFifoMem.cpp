@@ -8,6 +8,7 @@
 
 #include <stdio.h>
 #include <malloc.h>
+#include <string.h>
 #include "TeFifoMem.h"
 #include "RegAddress.h"
 
@@ -193,7 +194,7 @@ int CTeFifoMem::WriteData(complex_int Data)
 		OverflowFlag &= ~2;
 
 	// if data count reach ready threshold, trigger other channels
-	if (DataCount == BlockSize)
+	if (DataCount == (int)BlockSize)
 	{
 		if (TriggerCallback)
 			TriggerCallback(FifoIndex);
@@ -202,10 +203,71 @@ int CTeFifoMem::WriteData(complex_int Data)
 	return (DataCount >= (int)BlockSize) ? 1 : 0;	// return with whether there is at least one block of data
 }
 
-void CTeFifoMem::ReadData(int &ReadNumber, complex_int Data[])
+// write Number samples, FIFO status and trigger callback are the same as calling WriteData() for each sample
+// return with whether there is at least one block of data after any sample written
+int CTeFifoMem::WriteBlock(int Number, complex_int Data[])
+{
+	int Length, Ready = 0;
+
+	while (Number > 0 && FifoEnable)
+	{
+		// stop at the sample reaching ready threshold, trigger callback may change FIFO status
+		if (DataCount < (int)BlockSize && DataCount + Number >= (int)BlockSize)
+			Length = (int)BlockSize - DataCount;
+		else
+			Length = Number;
+		WriteSegment(Length, Data);
+		Data += Length;
+		Number -= Length;
+
+		// if data count reach ready threshold, trigger other channels
+		if (DataCount == (int)BlockSize)
+		{
+			if (TriggerCallback)
+				TriggerCallback(FifoIndex);
+		}
+		if (DataCount >= (int)BlockSize)
+			Ready = 1;
+	}
+
+	return Ready;
+}
+
+// copy samples into FIFO memory, one memcpy for each wrap around
+void CTeFifoMem::WriteSegment(int Number, complex_int Data[])
 {
-	int i;
+	int Length;
+
+	DataCount += Number;
+	while (Number > 0)
+	{
+		Length = (int)(FifoSize - WriteAddress);
+		if (Length > Number)
+			Length = Number;
+		if (!DummyWrite)
+			memcpy(pBuffer + WriteAddress, Data, Length * sizeof(complex_int));
+		Data += Length;
+		Number -= Length;
+		WriteAddress += Length;
+		if (WriteAddress == FifoSize)
+		{
+			WriteAddress = 0;
+			WriteAddressRound ++;
+			WriteAddressRound &= 0xffff;
+		}
+	}
+
+	// data count only increases within one segment, so flags only depend on final data count
+	if (DataCount > (int)FifoSize)
+		OverflowFlag |= 1;
+	if (DataCount >= GuardThreshold)
+		OverflowFlag |= 2;
+	else
+		OverflowFlag &= ~2;
+}
 
+void CTeFifoMem::ReadData(int &ReadNumber, complex_int Data[])
+{
 	if (!FifoEnable)
 	{
 		ReadNumber = 0;
@@ -213,15 +275,51 @@ void CTeFifoMem::ReadData(int &ReadNumber, complex_int Data[])
 	}
 
 	ReadNumber = RealBlockSize;
-	for (i = 0; i < ReadNumber; i ++)
+	ReadBlock(ReadNumber, Data);
+}
+
+// copy Number samples from current read address, one memcpy for each wrap around
+void CTeFifoMem::ReadBlock(int Number, complex_int Data[])
+{
+	int Length;
+
+	while (Number > 0)
 	{
-		Data[i] = pBuffer[CurReadAddress++];
-	
+		Length = (int)(FifoSize - CurReadAddress);
+		if (Length > Number)
+			Length = Number;
+		memcpy(Data, pBuffer + CurReadAddress, Length * sizeof(complex_int));
+		Data += Length;
+		Number -= Length;
+		CurReadAddress += Length;
 		if (CurReadAddress == FifoSize)
 			CurReadAddress = 0;
 	}
 }
 
+// get samples of the block ReadData() would return without copy, current read address not changed
+// return number of samples in the block
+int CTeFifoMem::PeekSpan(FifoSpan &Span)
+{
+	int Length = (int)(FifoSize - CurReadAddress);
+
+	Span.Data[0] = pBuffer + CurReadAddress;
+	Span.Data[1] = pBuffer;
+	Span.Length[0] = Span.Length[1] = 0;
+	if (!FifoEnable)
+		return 0;
+
+	if (RealBlockSize <= Length)
+		Span.Length[0] = RealBlockSize;
+	else
+	{
+		Span.Length[0] = Length;
+		Span.Length[1] = RealBlockSize - Length;
+	}
+
+	return RealBlockSize;
+}
+
 void CTeFifoMem::LatchWriteAddress(int Source)
 {
 	switch (Source)
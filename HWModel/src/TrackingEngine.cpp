@@ -12,13 +12,22 @@
 #include "CommonOps.h"
 #include "RegAddress.h"
 #include "TrackingEngine.h"
+#include "CorrelatorSimd.h"
 
 #define COH_OFFSET(ch_index, cor_index) ((ch_index << 5) + 24 + (cor_index >> 2))
 
-CTrackingEngine::CTrackingEngine(CTeFifoMem *pTeFifo, unsigned int *MemCodeBuffer) : pTeFifo(pTeFifo), NoiseCalc(10)
+CTrackingEngine::CTrackingEngine(CTeFifoMem *pTeFifo, unsigned int *MemCodeBuffer) : pTeFifo(pTeFifo), NoiseCalc(10), MemCodeBuffer(MemCodeBuffer)
 {
 	int i;
 
+	ParallelMode = TE_PARALLEL_NONE;
+	WorkerPool = NULL;
+	for (i = 0; i < MAX_WORKER_NUMBER; i ++)
+		WorkerCorrelator[i] = NULL;
+	WideChunkSize = 0;
+	for (i = 0; i < LOGICAL_CHANNEL_NUMBER; i ++)
+		WideCorrelator[i] = NULL;
+
 	for (i = 0; i < PHYSICAL_CHANNEL_NUMBER; i ++)
 		Correlator[i] = new CCorrelator(PrnPolyLength, MemCodeBuffer);
 	Reset();
@@ -35,6 +44,8 @@ CTrackingEngine::~CTrackingEngine()
 	free(FifoData);
 	for (i = 0; i < PHYSICAL_CHANNEL_NUMBER; i ++)
 		delete Correlator[i];
+	SetParallelMode(TE_PARALLEL_NONE, 1);
+	SetWideMode(0);
 }
 
 void CTrackingEngine::Reset()
@@ -130,16 +141,11 @@ U32 CTrackingEngine::GetRegValue(int Address)
 int CTrackingEngine::ProcessData()
 {
 	unsigned int EnableMask;
-	int i, j, TrackingChannelCount;
-	int TrackingChannelIndex[PHYSICAL_CHANNEL_NUMBER];
-	// Array length is 32 for DumpDataI, DumpDataQ and CohAddress
-	// for RTL implementation, FIFO depth 16 is ok
-	S16 DumpDataI[16], DumpDataQ[16];
-	int CorIndex[16];
-	int DumpCount;
+	int i, TrackingChannelCount;
+	int TrackingChannelIndex[LOGICAL_CHANNEL_NUMBER];
 	int ReadNumber;
-	unsigned int CohData, DataAcc;
-	S16 CohDataI, CohDataQ;
+	FifoSpan Span;
+	TeChannelResult Result;
 	int FirstRound = 1;
 
 	// clear coherent data ready flag and overwrite protect flag
@@ -153,6 +159,27 @@ int CTrackingEngine::ProcessData()
 		return 0;
 	}
 
+	// all enabled channels correlated on worker threads or chunk by chunk against the same block
+	if (ParallelMode != TE_PARALLEL_NONE || WideChunkSize > 0)
+	{
+		EnableMask = ChannelEnable;
+		TrackingChannelCount = 0;
+		while (EnableMask)
+		{
+			TrackingChannelIndex[TrackingChannelCount] = FindLeastIndex(EnableMask);
+			EnableMask &= ~(1 << TrackingChannelIndex[TrackingChannelCount]);
+			TrackingChannelCount ++;
+		}
+		// samples used in place within FIFO memory
+		pTeFifo->PeekSpan(BlockSpan);
+		if (ParallelMode != TE_PARALLEL_NONE)
+			ProcessParallel(TrackingChannelCount, TrackingChannelIndex);
+		else
+			ProcessWide(TrackingChannelCount, TrackingChannelIndex);
+		pTeFifo->SkipBlock();
+		return (CohDataReady != 0);
+	}
+
 	// loop for all enabled channel
 	EnableMask = ChannelEnable;
 	while (EnableMask)
@@ -170,45 +197,26 @@ int CTrackingEngine::ProcessData()
 		
 		// read data from TE FIFO
 		pTeFifo->ReadData(ReadNumber, FifoData);
+		Span.Data[0] = FifoData;
+		Span.Length[0] = ReadNumber;
+		Span.Data[1] = NULL;
+		Span.Length[1] = 0;
 //		for (i = 0; i < ReadNumber; i ++)
 //			if (SetIndex == 1)
 //				printf("%x\n", FifoData[i]);
 		// process all physical channels
 		for (i = 0; i < TrackingChannelCount; i ++)
 		{
-			Correlator[i]->FillState(&TEBuffer[TrackingChannelIndex[i] << 5]);
+			ProcessChannel(Correlator[i], TrackingChannelIndex[i], Span, Result);
 			// if any correlator reaches coherent value, set data ready flag
-			if (Correlator[i]->Correlation(ReadNumber, FifoData, DumpDataI, DumpDataQ, CorIndex, DumpCount))
+			if (Result.CohDataReady)
 				CohDataReady |= 1 << TrackingChannelIndex[i];
-			for (j = 0; j < DumpCount; j ++)
+			if (Result.OverwriteProtect)
 			{
-				// if overwrite protect bit is set, set corresponding flag bit and set address and value. do NOT accumulate
-				if (CorIndex[j] & 2)
-				{
-					OverwriteProtectChannel |= 1 << TrackingChannelIndex[i];
-					OverwriteProtectAddr = COH_OFFSET(TrackingChannelIndex[i], CorIndex[j]) << 2;
-					OverwriteProtectValue = ((unsigned int)DumpDataI[j] << 16) | ((unsigned int)DumpDataQ[j] & 0xffff);
-					continue;
-				}
-
-				// if this is first epoch of coherent data accumulation, clear stored value
-				if (CorIndex[j] & 1)
-					CohData = 0;
-				else
-					CohData = TEBuffer[COH_OFFSET(TrackingChannelIndex[i], CorIndex[j])];
-				CohDataI = (S16)(CohData >> 16);
-				CohDataQ = (S16)(CohData & 0xffff);
-				CohDataI += DumpDataI[j];
-				CohDataQ += DumpDataQ[j];
-				CohData = ((unsigned int)CohDataI << 16) | ((unsigned int)CohDataQ & 0xffff);
-				TEBuffer[COH_OFFSET(TrackingChannelIndex[i], CorIndex[j])] = CohData;
-				if ((CorIndex[j] >> 2) == 0)	// save acc data for Cor0
-					DataAcc = CohData;
+				OverwriteProtectChannel |= 1 << TrackingChannelIndex[i];
+				OverwriteProtectAddr = Result.OverwriteProtectAddr;
+				OverwriteProtectValue = Result.OverwriteProtectValue;
 			}
-
-			Correlator[i]->DecodeDataAcc(DataAcc);
-
-			Correlator[i]->DumpState(&TEBuffer[TrackingChannelIndex[i] << 5]);
 		}
 		// rewind FIFO read pointer
 		pTeFifo->RewindPointer();
@@ -220,6 +228,210 @@ int CTrackingEngine::ProcessData()
 	return (CohDataReady != 0);
 }
 
+// correlate one logical channel with state in TEBuffer and accumulate dump data to coherent buffer
+// only the 32 words of the channel in TEBuffer are modified, register outputs are placed in Result
+void CTrackingEngine::ProcessChannel(CCorrelator *pCorrelator, int ChannelIndex, FifoSpan &Span, TeChannelResult &Result)
+{
+	TeDumpFifo DumpFifo;
+
+	pCorrelator->FillState(&TEBuffer[ChannelIndex << 5]);
+	pCorrelator->StartCorrelation(DumpFifo.DumpDataI, DumpFifo.DumpDataQ, DumpFifo.CorIndex, DumpFifo.DumpCount);
+	pCorrelator->CorrelateSamples(Span.Length[0], Span.Data[0], DumpFifo.DumpDataI, DumpFifo.DumpDataQ, DumpFifo.CorIndex, DumpFifo.DumpCount);
+	pCorrelator->CorrelateSamples(Span.Length[1], Span.Data[1], DumpFifo.DumpDataI, DumpFifo.DumpDataQ, DumpFifo.CorIndex, DumpFifo.DumpCount);
+	Result.CohDataReady = pCorrelator->FinishCorrelation(DumpFifo.DumpDataI, DumpFifo.DumpDataQ, DumpFifo.CorIndex, DumpFifo.DumpCount);
+	SaveDumpData(pCorrelator, ChannelIndex, DumpFifo, Result);
+}
+
+// accumulate coherent data FIFO of one channel to coherent buffer, decode data and save correlator state
+void CTrackingEngine::SaveDumpData(CCorrelator *pCorrelator, int ChannelIndex, TeDumpFifo &DumpFifo, TeChannelResult &Result)
+{
+	int j;
+	S16 *DumpDataI = DumpFifo.DumpDataI, *DumpDataQ = DumpFifo.DumpDataQ;
+	int *CorIndex = DumpFifo.CorIndex;
+	unsigned int CohData, DataAcc = 0;
+	S16 CohDataI, CohDataQ;
+
+	Result.OverwriteProtect = 0;
+	for (j = 0; j < DumpFifo.DumpCount; j ++)
+	{
+		// if overwrite protect bit is set, set corresponding flag bit and set address and value. do NOT accumulate
+		if (CorIndex[j] & 2)
+		{
+			Result.OverwriteProtect = 1;
+			Result.OverwriteProtectAddr = COH_OFFSET(ChannelIndex, CorIndex[j]) << 2;
+			Result.OverwriteProtectValue = ((unsigned int)DumpDataI[j] << 16) | ((unsigned int)DumpDataQ[j] & 0xffff);
+			continue;
+		}
+
+		// if this is first epoch of coherent data accumulation, clear stored value
+		if (CorIndex[j] & 1)
+			CohData = 0;
+		else
+			CohData = TEBuffer[COH_OFFSET(ChannelIndex, CorIndex[j])];
+		CohDataI = (S16)(CohData >> 16);
+		CohDataQ = (S16)(CohData & 0xffff);
+		CohDataI += DumpDataI[j];
+		CohDataQ += DumpDataQ[j];
+		CohData = ((unsigned int)CohDataI << 16) | ((unsigned int)CohDataQ & 0xffff);
+		TEBuffer[COH_OFFSET(ChannelIndex, CorIndex[j])] = CohData;
+		if ((CorIndex[j] >> 2) == 0)	// save acc data for Cor0
+			DataAcc = CohData;
+	}
+
+	pCorrelator->DecodeDataAcc(DataAcc);
+
+	pCorrelator->DumpState(&TEBuffer[ChannelIndex << 5]);
+}
+
+// select parallel mode, ThreadNumber includes the calling thread
+// worker pool and correlators are released when Mode is TE_PARALLEL_NONE
+void CTrackingEngine::SetParallelMode(int Mode, int ThreadNumber)
+{
+	int i;
+
+	if (WorkerPool)
+	{
+		delete WorkerPool;
+		WorkerPool = NULL;
+	}
+	for (i = 0; i < MAX_WORKER_NUMBER; i ++)
+	{
+		delete WorkerCorrelator[i];
+		WorkerCorrelator[i] = NULL;
+	}
+	ParallelMode = Mode;
+	if (Mode == TE_PARALLEL_NONE)
+		return;
+
+	// kernel selection is done on first use, finish it before any worker starts
+	GetSimdLevel();
+	WorkerPool = new CWorkerPool(ThreadNumber);
+	for (i = 0; i < WorkerPool->GetWorkerNumber(); i ++)
+		WorkerCorrelator[i] = new CCorrelator(PrnPolyLength, MemCodeBuffer);
+}
+
+// correlate all channels on worker threads, each channel only reads BlockSpan and writes its own TEBuffer words
+// register outputs are merged in channel order so the result is identical to sequential processing
+void CTrackingEngine::ProcessParallel(int ChannelNumber, int ChannelIndex[])
+{
+	int i, TaskNumber;
+
+	ParallelChannelNumber = ChannelNumber;
+	for (i = 0; i < ChannelNumber; i ++)
+		ParallelChannelIndex[i] = ChannelIndex[i];
+	TaskNumber = (ParallelMode == TE_PARALLEL_ROUND) ? (ChannelNumber + PHYSICAL_CHANNEL_NUMBER - 1) / PHYSICAL_CHANNEL_NUMBER : ChannelNumber;
+	WorkerPool->RunTasks(TaskNumber, ParallelTask, this);
+
+	for (i = 0; i < ChannelNumber; i ++)
+	{
+		if (ChannelResult[i].CohDataReady)
+			CohDataReady |= 1 << ChannelIndex[i];
+		if (ChannelResult[i].OverwriteProtect)
+		{
+			OverwriteProtectChannel |= 1 << ChannelIndex[i];
+			OverwriteProtectAddr = ChannelResult[i].OverwriteProtectAddr;
+			OverwriteProtectValue = ChannelResult[i].OverwriteProtectValue;
+		}
+	}
+}
+
+void CTrackingEngine::ParallelTask(void *Param, int TaskIndex, int WorkerIndex)
+{
+	CTrackingEngine *Engine = (CTrackingEngine *)Param;
+	CCorrelator *pCorrelator = Engine->WorkerCorrelator[WorkerIndex];
+	int i, Start, End;
+
+	if (Engine->ParallelMode == TE_PARALLEL_ROUND)
+	{
+		Start = TaskIndex * PHYSICAL_CHANNEL_NUMBER;
+		End = Start + PHYSICAL_CHANNEL_NUMBER;
+		if (End > Engine->ParallelChannelNumber)
+			End = Engine->ParallelChannelNumber;
+	}
+	else
+	{
+		Start = TaskIndex;
+		End = TaskIndex + 1;
+	}
+
+	for (i = Start; i < End; i ++)
+	{
+		// noise floor is calculated on the first channel as sequential mode does
+		pCorrelator->NoiseCalc = (i == 0) ? &Engine->NoiseCalc : NULL;
+		Engine->ProcessChannel(pCorrelator, Engine->ParallelChannelIndex[i], Engine->BlockSpan, Engine->ChannelResult[i]);
+	}
+	pCorrelator->NoiseCalc = NULL;
+}
+
+// set chunk size of wide mode, 0 to go back to FIFO rewind mode
+// one correlator is created for each logical channel because all channels are in process at the same time
+void CTrackingEngine::SetWideMode(int ChunkSize)
+{
+	int i;
+
+	if (ChunkSize < 0)
+		ChunkSize = 0;
+	WideChunkSize = ChunkSize;
+	for (i = 0; i < LOGICAL_CHANNEL_NUMBER; i ++)
+	{
+		if (ChunkSize == 0)
+		{
+			delete WideCorrelator[i];
+			WideCorrelator[i] = NULL;
+		}
+		else if (WideCorrelator[i] == NULL)
+			WideCorrelator[i] = new CCorrelator(PrnPolyLength, MemCodeBuffer);
+	}
+}
+
+// traverse the block once in chunks of WideChunkSize samples, each chunk is fed to all channels before moving to next chunk
+// every channel sees the same sample sequence as in rewind mode, so the result is identical
+void CTrackingEngine::ProcessWide(int ChannelNumber, int ChannelIndex[])
+{
+	int i, k, Start, ChunkLength;
+	CCorrelator *pCorrelator;
+	TeDumpFifo *DumpFifo;
+
+	for (i = 0; i < ChannelNumber; i ++)
+	{
+		pCorrelator = WideCorrelator[ChannelIndex[i]];
+		DumpFifo = &WideDumpFifo[ChannelIndex[i]];
+		// noise floor is calculated on the first channel as rewind mode does
+		pCorrelator->NoiseCalc = (i == 0) ? &NoiseCalc : NULL;
+		pCorrelator->FillState(&TEBuffer[ChannelIndex[i] << 5]);
+		pCorrelator->StartCorrelation(DumpFifo->DumpDataI, DumpFifo->DumpDataQ, DumpFifo->CorIndex, DumpFifo->DumpCount);
+	}
+
+	for (k = 0; k < 2; k ++)
+	{
+		for (Start = 0; Start < BlockSpan.Length[k]; Start += ChunkLength)
+		{
+			ChunkLength = (BlockSpan.Length[k] - Start > WideChunkSize) ? WideChunkSize : (BlockSpan.Length[k] - Start);
+			for (i = 0; i < ChannelNumber; i ++)
+			{
+				DumpFifo = &WideDumpFifo[ChannelIndex[i]];
+				WideCorrelator[ChannelIndex[i]]->CorrelateSamples(ChunkLength, BlockSpan.Data[k] + Start, DumpFifo->DumpDataI, DumpFifo->DumpDataQ, DumpFifo->CorIndex, DumpFifo->DumpCount);
+			}
+		}
+	}
+
+	for (i = 0; i < ChannelNumber; i ++)
+	{
+		pCorrelator = WideCorrelator[ChannelIndex[i]];
+		DumpFifo = &WideDumpFifo[ChannelIndex[i]];
+		if (pCorrelator->FinishCorrelation(DumpFifo->DumpDataI, DumpFifo->DumpDataQ, DumpFifo->CorIndex, DumpFifo->DumpCount))
+			CohDataReady |= 1 << ChannelIndex[i];
+		SaveDumpData(pCorrelator, ChannelIndex[i], *DumpFifo, ChannelResult[i]);
+		if (ChannelResult[i].OverwriteProtect)
+		{
+			OverwriteProtectChannel |= 1 << ChannelIndex[i];
+			OverwriteProtectAddr = ChannelResult[i].OverwriteProtectAddr;
+			OverwriteProtectValue = ChannelResult[i].OverwriteProtectValue;
+		}
+		pCorrelator->NoiseCalc = NULL;
+	}
+}
+
 // find the index of bit 1 counting from LSB
 // caller will ensure input argument data will not be 0
 int CTrackingEngine::FindLeastIndex(unsigned int data)
@@ -0,0 +1,121 @@
+//----------------------------------------------------------------------
+// WorkerPool.cpp:
+//   Fixed size worker thread pool implementation
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include "WorkerPool.h"
+
+CWorkerPool::CWorkerPool(int Number)
+{
+	int i;
+
+	if (Number < 1)
+		Number = 1;
+	if (Number > MAX_WORKER_NUMBER)
+		Number = MAX_WORKER_NUMBER;
+	WorkerNumber = Number;
+	CurrentTask = NULL;
+	CurrentParam = NULL;
+	TaskNumber = NextTask = 0;
+	BusyWorkers = 0;
+	Generation = 0;
+	Exiting = 0;
+
+	Threads[0] = NULL;
+	for (i = 1; i < WorkerNumber; i ++)
+		Threads[i] = new std::thread(WorkerThread, this, i);
+}
+
+CWorkerPool::~CWorkerPool()
+{
+	int i;
+
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Exiting = 1;
+	}
+	StartCondition.notify_all();
+	for (i = 1; i < WorkerNumber; i ++)
+	{
+		Threads[i]->join();
+		delete Threads[i];
+	}
+}
+
+// run Task for each index in [0, TaskNumber) and return after all tasks finished
+// the calling thread also executes tasks, task order among workers is not determined
+void CWorkerPool::RunTasks(int Number, WorkerTask Task, void *Param)
+{
+	if (Number <= 0)
+		return;
+	// not worth waking up other threads
+	if (WorkerNumber == 1 || Number == 1)
+	{
+		for (int i = 0; i < Number; i ++)
+			Task(Param, i, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		CurrentTask = Task;
+		CurrentParam = Param;
+		TaskNumber = Number;
+		NextTask = 0;
+		BusyWorkers = WorkerNumber;
+		Generation ++;
+	}
+	StartCondition.notify_all();
+
+	ExecuteTasks(0);
+
+	std::unique_lock<std::mutex> Lock(Mutex);
+	while (BusyWorkers != 0)
+		DoneCondition.wait(Lock);
+}
+
+void CWorkerPool::WorkerThread(CWorkerPool *Pool, int WorkerIndex)
+{
+	unsigned int LastGeneration = 0;
+
+	while (1)
+	{
+		{
+			std::unique_lock<std::mutex> Lock(Pool->Mutex);
+			while (!Pool->Exiting && Pool->Generation == LastGeneration)
+				Pool->StartCondition.wait(Lock);
+			if (Pool->Exiting)
+				return;
+			LastGeneration = Pool->Generation;
+		}
+		Pool->ExecuteTasks(WorkerIndex);
+	}
+}
+
+// fetch tasks until all tasks of current batch are taken
+void CWorkerPool::ExecuteTasks(int WorkerIndex)
+{
+	int TaskIndex;
+	WorkerTask Task;
+	void *Param;
+
+	while (1)
+	{
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			if (NextTask >= TaskNumber)
+			{
+				if (--BusyWorkers == 0)
+					DoneCondition.notify_one();
+				return;
+			}
+			TaskIndex = NextTask ++;
+			Task = CurrentTask;
+			Param = CurrentParam;
+		}
+		Task(Param, TaskIndex, WorkerIndex);
+	}
+}